@@ -0,0 +1,105 @@
+#ifndef ADMISSION_CONTROLLER_H
+#define ADMISSION_CONTROLLER_H
+
+#include <stdint.h>
+#include <chrono>
+#include <deque>
+#include <memory>
+#include "frame_pool.h"
+#include "model_wrapper.h"
+#include "reorder_buffer.h"
+
+class StreamScheduler;
+
+// 在途窗口已满时新帧的处理方式
+enum class DropPolicy {
+    DROP_NEWEST,          // 排队已满时丢弃新帧
+    DROP_OLDEST_QUEUED,   // 排队已满时丢弃排队最久的一帧，新帧入队
+    LATEST_WINS,          // 只保留最新的一帧：新帧替换所有排队帧（实时源，宁可跳帧也不累积延迟）
+    BLOCK                 // 不丢帧：窗口满时排队，由调用方等待最早的帧完成（见 backlogged），用于视频文件等离线源
+};
+
+// 准入控制参数
+struct AdmissionConfig {
+    int max_in_flight = 6;                       // 已提交给模型、结果尚未取走的最大帧数
+    int queue_depth = 1;                         // 窗口满时等待提交的最大帧数（LATEST_WINS 固定为 1，BLOCK 不限）
+    DropPolicy policy = DropPolicy::LATEST_WINS;
+    int skip_ahead_ms = 0;                       // 最早的帧提交后超过该时间仍未完成、而其后已有完成的帧时越过它；0 为严格按序
+};
+
+// 准入统计
+struct AdmissionStats {
+    uint64_t offered = 0;     // 送入的帧数
+    uint64_t submitted = 0;   // 提交给模型的帧数
+    uint64_t dropped = 0;     // 丢弃的帧数（新帧被拒或排队帧被替换，含结束时丢弃的排队帧）
+    uint64_t completed = 0;   // 已取走结果的帧数
+    uint64_t skipped = 0;     // 已提交但因过截止时间被模型跳过的帧数（不经 next_completed 交给调用方）
+    uint64_t skipped_ahead = 0;  // 完成太慢被越过、结果作废的帧数
+};
+
+// Yolov8Model::submit_infer_task 之前的准入控制：在途帧数有上限，推理跟不上采集时按策略丢帧，
+// 线程池任务队列、帧缓冲与端到端延迟都不再随积压增长
+// 排队帧在 offer / next_completed 调用时（在途帧完成后）提交；推理结果经完成回调写入 ReorderBuffer，
+// 按提交顺序取出，不阻塞在某一帧的 future 上
+// 由采集显示线程调用，非线程安全
+class AdmissionController {
+public:
+    explicit AdmissionController(Yolov8Model& model, const AdmissionConfig& config = AdmissionConfig());
+
+    AdmissionController(const AdmissionController&) = delete;
+    AdmissionController& operator=(const AdmissionController&) = delete;
+
+    // 须在送入第一帧之前（或没有已提交的帧时）调用
+    void set_config(const AdmissionConfig& config);
+    const AdmissionConfig& config() const { return config_; }
+    // 多路流共享模型时经 scheduler 的公平队列提交（stream 为 add_stream 返回的编号），nullptr 为直接提交给模型；
+    // 须在送入第一帧之前调用
+    void set_stream_scheduler(StreamScheduler* scheduler, int stream);
+
+    // 送入一帧（capture_time 为采集时间，模型据此计算截止时间）：窗口未满时直接提交，否则按策略排队或丢弃；
+    // 返回 false 表示该帧被丢弃
+    bool offer(const FrameRef& frame,
+               std::chrono::steady_clock::time_point capture_time = std::chrono::steady_clock::now());
+    // 按提交顺序取出下一帧及其结果，被模型跳过或超时被越过的帧直接略过；下一帧尚未完成时最多等待 wait_ms
+    // （0 不等待，负数一直等待），没有已提交的帧或等待超时返回 false
+    bool next_completed(FrameRef& frame, object_detect_result_list& results, int wait_ms = 0);
+    // 同上，并取出该帧送入时的采集时间
+    bool next_completed(FrameRef& frame, object_detect_result_list& results, int wait_ms,
+                        std::chrono::steady_clock::time_point& capture_time);
+    // 同上，并取出级联姿态结果（未配置第二阶段模型或本帧没有姿态结果时为空指针）
+    bool next_completed(FrameRef& frame, object_detect_result_list& results, int wait_ms,
+                        std::chrono::steady_clock::time_point& capture_time, PoseResults& poses);
+    // 丢弃所有排队帧（计入丢弃数），已提交的帧不受影响
+    void discard_queued();
+
+    // 已提交、结果尚未取走的帧数
+    int submitted_count() const { return reorder_->outstanding(); }
+    // 等待提交的帧数
+    int queued_count() const { return (int)queued_.size(); }
+    // BLOCK 策略下有帧在排队：调用方应等待最早的帧完成（next_completed 传入负数）再送入新帧
+    bool backlogged() const { return config_.policy == DropPolicy::BLOCK && !queued_.empty(); }
+    AdmissionStats stats() const;
+
+private:
+    struct Queued {
+        FrameRef frame;
+        std::chrono::steady_clock::time_point capture_time;
+    };
+
+    // 窗口有空位时按先后提交排队帧
+    void pump();
+    // 分配序号并提交；ReorderBuffer 没有空闲槽位时返回 false，帧留在排队中
+    bool submit(const Queued& entry);
+    void record_drop(uint64_t count);
+
+    Yolov8Model& model_;
+    StreamScheduler* stream_scheduler_ = nullptr;
+    int stream_ = -1;
+    AdmissionConfig config_;
+    // 完成回调持有共享引用，控制器先于模型销毁时迟到的结果仍可安全写入
+    std::shared_ptr<ReorderBuffer> reorder_;
+    std::deque<Queued> queued_;
+    AdmissionStats stats_;
+};
+
+#endif // ADMISSION_CONTROLLER_H
@@ -0,0 +1,50 @@
+#ifndef CASCADE_STAGE_H
+#define CASCADE_STAGE_H
+
+#include <vector>
+#include <opencv2/opencv.hpp>
+#include "yolov8.h"
+#include "inference_backend.h"
+#include "infer_result.h"
+
+// 第二阶段模型参数
+struct CascadeConfig {
+    int cls_id = 0;                        // 只对该类别的检测框运行（COCO person）
+    float min_score = 0.4f;                // 检测置信度低于该值的框不送入
+    int min_box_px = 32;                   // 框短边小于该像素数不送入（目标太小时关键点不可靠）
+    int max_crops = POSE_NUMB_MAX_SIZE;    // 每帧最多送入的框数，按面积从大到小取
+    float crop_margin = 0.1f;              // 裁剪时框每边外扩的比例（姿态模型需要看到肢体末端）
+};
+
+// 送入第二阶段的一个检测框
+struct CascadeCrop {
+    int det_index;   // 在 results 中的下标
+    cv::Rect rect;   // 外扩后的裁剪区域，已限制在帧内
+};
+
+// 级联的第二阶段：只在选中的检测框裁剪图上运行较小的模型（目前为 YOLOv8-pose），结果合并进检测结果；
+// 相比整帧运行姿态模型，裁剪图输入小、只处理少数目标
+// 不持有上下文：由调用方从上下文池借出第二阶段模型的上下文后调用 run，一帧的所有裁剪图在同一次借用内完成
+class CascadeStage {
+public:
+    explicit CascadeStage(const CascadeConfig& config = CascadeConfig()) : config_(config) {}
+
+    void set_config(const CascadeConfig& config);
+    const CascadeConfig& config() const { return config_; }
+
+    // 选出本帧送入第二阶段的检测框，返回个数
+    int select(const object_detect_result_list& od_results, int frame_width, int frame_height,
+               std::vector<CascadeCrop>& crops) const;
+    // 在 backend 上推理本帧的全部裁剪图（模型以 batch>1 导出且后端支持时一次 rknn_run 推理一批），
+    // 姿态结果换算到帧坐标后写入 poses；成功返回 0
+    int run(InferenceBackend& backend, const cv::Mat& frame, const std::vector<CascadeCrop>& crops,
+            object_pose_result_list& poses) const;
+
+private:
+    // 把裁剪图上的姿态结果换算到帧坐标并追加
+    static void merge(object_pose_result& pose, const CascadeCrop& crop, object_pose_result_list& poses);
+
+    CascadeConfig config_;
+};
+
+#endif // CASCADE_STAGE_H
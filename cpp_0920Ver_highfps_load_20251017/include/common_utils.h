@@ -1,10 +1,13 @@
 #ifndef COMMON_UTILS_H
 #define COMMON_UTILS_H
 
+#include <stdlib.h>
 #include <sys/time.h>
 #include <atomic>
 #include <string>
+#include <memory>
 #include <mutex>
+#include <new>
 #include <chrono>
 #include <string>
 
@@ -26,8 +29,8 @@ private:
     mutable std::mutex fps_mutex;            // 保护FPS计算的互斥锁
 };
 
-// 线程安全打印（避免多线程打印乱码）
-void safe_printf(const char* format, ...); 
+// 线程安全打印（避免多线程打印乱码），经异步日志以 INFO 级别输出；逐帧日志请用 logger.h 的 LOG_DEBUG / LOG_THROTTLED
+void safe_printf(const char* format, ...) __attribute__((format(printf, 1, 2)));
 
 // 时间转换：timeval → 微秒
 double timeval_to_us(const struct timeval& t);
@@ -45,4 +48,37 @@ inline void print_time_cost(const std::string& step_name, double start_ms, doubl
     safe_printf("[计时] %s: %.2f ms", step_name.c_str(), end_ms - start_ms);
 }
 
+// 按 alignof(T) 对齐的定长数组：C++14 的 new T[] 不保证超过 alignof(max_align_t) 的对齐（如 alignas(64) 的缓存行元素），
+// 改用 posix_memalign 分配、逐个构造；删除器逐个析构后 free
+template <typename T>
+struct AlignedArrayDeleter {
+    size_t count = 0;
+    void operator()(T* p) const {
+        for (size_t i = count; i > 0; --i) {
+            p[i - 1].~T();
+        }
+        free(p);
+    }
+};
+
+template <typename T>
+using AlignedArray = std::unique_ptr<T[], AlignedArrayDeleter<T>>;
+
+// 分配并默认构造 count 个元素，分配失败抛出 std::bad_alloc（与 new 一致）
+template <typename T>
+AlignedArray<T> make_aligned_array(size_t count) {
+    size_t alignment = alignof(T) < sizeof(void*) ? sizeof(void*) : alignof(T);
+    void* mem = nullptr;
+    if (posix_memalign(&mem, alignment, (count > 0 ? count : 1) * sizeof(T)) != 0) {
+        throw std::bad_alloc();
+    }
+    T* p = static_cast<T*>(mem);
+    for (size_t i = 0; i < count; ++i) {
+        new (p + i) T();
+    }
+    AlignedArrayDeleter<T> deleter;
+    deleter.count = count;
+    return AlignedArray<T>(p, deleter);
+}
+
 #endif // COMMON_UTILS_H
\ No newline at end of file
@@ -0,0 +1,74 @@
+#ifndef CONTEXT_PIPELINE_H
+#define CONTEXT_PIPELINE_H
+
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+#include <functional>
+#include <vector>
+#include <opencv2/opencv.hpp>
+#include "yolov8.h"
+#include "infer_result.h"
+
+#if defined(YOLOV8_PIPELINE_SUPPORTED)
+
+// 单个模型上下文的流水线执行器（独占一个工作线程）
+// NPU 推理第 N 帧的同时，CPU 预处理第 N+1 帧并解码第 N-1 帧；两个输入槽交替使用
+// 模型以 batch>1 导出时改为批量执行：凑满一批（或第一帧等满 batch_max_wait_ms）后一次推理，再逐帧解码
+// 排队的帧按截止时间先后处理，取出时已过截止时间的帧不再预处理和推理，以 InferStatus::SKIPPED 交付
+class ContextPipeline {
+public:
+    // 每帧解码后在工作线程中回调（帧尺寸 + 检测结果），先于该帧的完成回调
+    typedef std::function<void(const cv::Size&, const object_detect_result_list&)> ResultCallback;
+
+    explicit ContextPipeline(rknn_app_context_t* ctx, ResultCallback on_result = ResultCallback(),
+                             int batch_max_wait_ms = 20);
+    // 处理完队列中剩余的帧后退出工作线程
+    ~ContextPipeline();
+
+    ContextPipeline(const ContextPipeline&) = delete;
+    ContextPipeline& operator=(const ContextPipeline&) = delete;
+
+    // 提交一帧（BGR, CV_8UC3），完成后在工作线程中以 on_done 交付结果
+    void submit(const cv::Mat& frame, std::chrono::steady_clock::time_point deadline, InferCallback on_done);
+    // 已提交但未完成的帧数（排队 + 正在处理），用于分派
+    size_t pending() const;
+    // 因过截止时间而跳过的帧数
+    uint64_t skipped() const { return skipped_.load(); }
+
+private:
+    struct Job {
+        cv::Mat frame;
+        InferCallback on_done;
+        std::chrono::steady_clock::time_point submit_time;
+        std::chrono::steady_clock::time_point deadline;
+    };
+
+    void worker();
+    void batch_worker();
+    // 交付一帧结果并减少 in_flight_；预处理或推理出错时 status 为 FAILED、结果为空
+    void finish(Job& job, InferStatus status, const object_detect_result_list& od_results);
+    // 取出队首已过截止时间的帧（队列按截止时间有序，过期的帧都在队首），须持有 mutex_；
+    // 调用方在释放锁后逐个以 SKIPPED 交付
+    void take_expired(std::vector<Job>& expired);
+    void deliver_skipped(std::vector<Job>& expired);
+
+    rknn_app_context_t* ctx_;
+    ResultCallback on_result_;
+    std::chrono::milliseconds batch_max_wait_;   // 批量模式下第一帧最多等待凑批的时间
+    std::deque<Job> jobs_;
+    size_t in_flight_ = 0;               // 已取出但结果未交付的帧数
+    std::atomic<uint64_t> skipped_{0};
+    bool stop_ = false;
+    mutable std::mutex mutex_;
+    std::condition_variable condition_;
+    std::thread thread_;
+};
+
+#endif // YOLOV8_PIPELINE_SUPPORTED
+
+#endif // CONTEXT_PIPELINE_H
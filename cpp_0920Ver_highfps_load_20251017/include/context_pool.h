@@ -0,0 +1,102 @@
+#ifndef CONTEXT_POOL_H
+#define CONTEXT_POOL_H
+
+#include <stdint.h>
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "common_utils.h"
+
+// 上下文借用统计
+struct ContextPoolStats {
+    uint64_t checkouts = 0;       // 借出次数
+    uint64_t waits = 0;           // 没有空闲上下文、需要等待的次数
+    uint64_t total_wait_us = 0;   // 等待总时长
+    uint64_t max_wait_us = 0;     // 单次最长等待
+};
+
+// 一组上下文（backends_ 中 [first_index, first_index + capacity) 的槽位）的借出与归还，每个 Yolov8Model 实例每个变体一个
+// 每个上下文一个忙标志：借出为对标志的 CAS，归还为一次原子写，无竞争时不加锁；
+// 全部忙时先短暂让出 CPU 重试，再按先来后到排队：有人排队时新来的借用方也排队，归还方把上下文直接交给队首，
+// 避免刚归还的线程立刻再借走、排队者长时间等不到
+// thread_affine 为 true 时第 i 个来借的线程固定优先使用第 i 个就绪的上下文，被占用时才借其他空闲上下文
+class ContextPool {
+public:
+    ContextPool(int first_index, int capacity, bool thread_affine = false);
+
+    ContextPool(const ContextPool&) = delete;
+    ContextPool& operator=(const ContextPool&) = delete;
+
+    // 加入一个已初始化的上下文（backends_ 下标），之后即可借出
+    void add(int index);
+    // 已加入的上下文数
+    int size() const;
+    // 第 k 个加入的上下文（backends_ 下标），k < size()
+    int at(int k) const;
+
+    // 借出一个空闲上下文，没有时阻塞等待；返回 backends_ 下标，池中还没有上下文时返回 -1
+    int checkout();
+    // 归还 checkout 借出的上下文
+    void checkin(int index);
+
+    ContextPoolStats stats() const;
+
+private:
+    // 每个上下文的忙标志独占一个缓存行，避免不同线程借还时互相失效
+    struct alignas(64) BusyFlag {
+        std::atomic<bool> busy{false};
+    };
+
+    // 从第 start 个就绪上下文开始找一个空闲的并占用，返回 backends_ 下标，全部忙时返回 -1
+    int try_acquire(int start, int count);
+    // 当前线程在本池中的编号（亲和模式的优先上下文）
+    int worker_slot();
+    void record_wait(uint64_t wait_us);
+
+    const int first_index_;
+    const int capacity_;
+    const bool thread_affine_;
+    const uint64_t id_;                        // 全局唯一，区分线程局部的编号属于哪个池
+    AlignedArray<BusyFlag> flags_;             // 按 index - first_index_，每个元素按缓存行对齐
+    std::unique_ptr<int[]> ready_;             // 按加入顺序的 backends_ 下标
+    std::atomic<int> size_{0};                 // ready_ 中的有效个数
+    std::mutex add_mutex_;
+    std::atomic<unsigned int> cursor_{0};      // 非亲和模式的扫描起点，轮流分散
+    std::atomic<int> next_worker_{0};
+    std::atomic<int> waiters_{0};              // 排队等待的借用方数（只在 wait_mutex_ 内修改）
+    std::mutex wait_mutex_;
+    std::condition_variable wait_cond_;
+    uint64_t next_ticket_ = 0;                 // 以下由 wait_mutex_ 保护：排队号
+    uint64_t serving_ = 0;                     // 当前队首的排队号
+    std::vector<int> handoff_;                 // 归还方直接交给排队者的上下文（忙标志保持占用）
+
+    std::atomic<uint64_t> checkouts_{0};
+    std::atomic<uint64_t> waits_{0};
+    std::atomic<uint64_t> total_wait_us_{0};
+    std::atomic<uint64_t> max_wait_us_{0};
+};
+
+// 在作用域内借用一个上下文，析构时归还
+class ContextLease {
+public:
+    explicit ContextLease(ContextPool& pool) : pool_(pool), index_(pool.checkout()) {}
+    ~ContextLease() {
+        if (index_ >= 0) {
+            pool_.checkin(index_);
+        }
+    }
+
+    ContextLease(const ContextLease&) = delete;
+    ContextLease& operator=(const ContextLease&) = delete;
+
+    // backends_ 下标，池为空时为 -1
+    int index() const { return index_; }
+
+private:
+    ContextPool& pool_;
+    int index_;
+};
+
+#endif // CONTEXT_POOL_H
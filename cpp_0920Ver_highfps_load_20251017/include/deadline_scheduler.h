@@ -0,0 +1,53 @@
+#ifndef DEADLINE_SCHEDULER_H
+#define DEADLINE_SCHEDULER_H
+
+#include <stdint.h>
+#include <chrono>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <vector>
+#include "thread_pool.h"
+
+// 截止时间优先（EDF）调度，建立在先进先出的 ThreadPool 之上：
+// 每个任务向线程池投放一个执行令牌，工作线程取到令牌时执行当前截止时间最早的任务（不一定是投放它的那个）；
+// 已过截止时间的任务不再执行，以 expired=true 回调，由任务交付“跳过”
+class DeadlineScheduler {
+public:
+    typedef std::chrono::steady_clock Clock;
+    typedef std::function<void(bool expired)> Task;
+
+    explicit DeadlineScheduler(ThreadPool* pool) : pool_(pool) {}
+    // 所有任务须已执行或经 cancel_all 交付
+    ~DeadlineScheduler() = default;
+
+    DeadlineScheduler(const DeadlineScheduler&) = delete;
+    DeadlineScheduler& operator=(const DeadlineScheduler&) = delete;
+
+    // 提交任务；截止时间相同的按提交顺序执行，不设截止时间时传 Clock::time_point::max()
+    void put(Clock::time_point deadline, Task task);
+    // 线程池停止后仍未执行的任务以 expired=true 回调（令牌随线程池一起丢弃）
+    void cancel_all();
+
+private:
+    struct Entry {
+        Clock::time_point deadline;
+        uint64_t seq;
+        Task task;
+    };
+    // priority_queue 为大顶堆：截止时间晚的排在后面
+    struct Later {
+        bool operator()(const Entry& a, const Entry& b) const {
+            return a.deadline != b.deadline ? a.deadline > b.deadline : a.seq > b.seq;
+        }
+    };
+
+    void run_next();
+
+    ThreadPool* pool_;
+    std::mutex mutex_;
+    std::priority_queue<Entry, std::vector<Entry>, Later> entries_;
+    uint64_t next_seq_ = 0;
+};
+
+#endif // DEADLINE_SCHEDULER_H
@@ -0,0 +1,54 @@
+#ifndef FRAME_POOL_H
+#define FRAME_POOL_H
+
+#include <stdint.h>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <opencv2/opencv.hpp>
+
+// 池中一帧的引用：最后一个引用释放时缓冲区回到池中
+typedef std::shared_ptr<cv::Mat> FrameRef;
+
+// 帧缓冲池统计
+struct FramePoolStats {
+    uint64_t acquired = 0;      // 成功取出次数
+    uint64_t exhausted = 0;     // 无空闲缓冲区（背压）次数
+    uint64_t reallocated = 0;   // 归还时发现缓冲区被重新分配（帧尺寸或类型变化）的次数
+};
+
+// 预分配的帧缓冲池：采集从池中取一个空闲缓冲区读帧，推理、跟踪、绘制都用完（最后一个 FrameRef 释放）后才归还，
+// 在途的帧不会被下一次读帧覆盖；尺寸不变时 VideoCapture::read 直接写入已分配的缓冲区，不再逐帧分配
+class FramePool {
+public:
+    FramePool() = default;
+
+    FramePool(const FramePool&) = delete;
+    FramePool& operator=(const FramePool&) = delete;
+
+    // 分配 capacity 个 width x height 的缓冲区
+    bool init(int capacity, int width, int height, int type = CV_8UC3);
+    // 取一个空闲缓冲区，全部在用时返回空引用并计一次背压，由调用方决定先消化在途的帧还是丢帧
+    FrameRef acquire();
+    int capacity() const;
+    // 当前空闲的缓冲区数
+    int available() const;
+
+    FramePoolStats stats() const;
+
+private:
+    // 与引用共享，池先于引用销毁时归还仍然安全
+    struct State {
+        std::mutex mutex;
+        std::vector<cv::Mat> frames;
+        std::vector<const unsigned char*> buffers;  // 每个缓冲区当前的数据地址，用于发现重新分配
+        std::vector<int> free;
+        FramePoolStats stats;
+
+        void release(int index);
+    };
+
+    std::shared_ptr<State> state_;
+};
+
+#endif // FRAME_POOL_H
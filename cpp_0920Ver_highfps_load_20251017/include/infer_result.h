@@ -0,0 +1,29 @@
+#ifndef INFER_RESULT_H
+#define INFER_RESULT_H
+
+#include <functional>
+#include <memory>
+#include <stdexcept>
+#include "yolov8.h"
+
+// 一帧推理的交付状态
+enum class InferStatus {
+    OK,        // 已推理，结果为检测结果（可能为空）
+    SKIPPED,   // 开始推理前已过截止时间，未推理
+    FAILED     // 预处理或推理出错（帧格式不支持、rknn_run / rknn_wait 失败等），或推理任务抛出异常
+};
+
+// 一帧的级联姿态结果：只在配置了第二阶段模型且本帧有送入的检测框时分配，否则为空指针；交付后只读，可跨线程共享
+typedef std::shared_ptr<const object_pose_result_list> PoseResults;
+
+// 推理完成回调：在推理线程中调用，应尽快返回且不得抛出异常；status 不为 OK 时结果为空、poses 为空指针
+typedef std::function<void(InferStatus status, const object_detect_result_list& results, const PoseResults& poses)>
+    InferCallback;
+
+// 推理任务开始前已过截止时间而被跳过：对应 future 的 get() 抛出该异常
+class InferenceSkipped : public std::runtime_error {
+public:
+    InferenceSkipped() : std::runtime_error("inference skipped: deadline passed before start") {}
+};
+
+#endif // INFER_RESULT_H
@@ -0,0 +1,51 @@
+#ifndef INFERENCE_BACKEND_H
+#define INFERENCE_BACKEND_H
+
+#include <string>
+#include <opencv2/opencv.hpp>
+#include "yolov8.h"  // rknn_app_context_t：输出张量描述 + 后处理状态
+
+// CPU 后端按 NCHW float 输出交给 post_process，只用于通用 RKNPU2 布局的构建（非零拷贝、非 RV1106/RKNPU1）
+#if defined(ENABLE_CPU_BACKEND) && !defined(RV1106_1103) && !defined(ZERO_COPY) && !defined(RKNPU1)
+#define CPU_BACKEND_SUPPORTED
+#endif
+
+// 推理后端接口（每个实例对应一个模型上下文，同一时刻只被一个线程使用）
+// 后端只负责“预处理 + 推理到输出张量”，解码统一由 post_process 完成：
+// model_context() 描述输出（io_num / output_attrs / 输入尺寸 / 量化参数），outputs() 为对应的输出数据
+class InferenceBackend {
+public:
+    virtual ~InferenceBackend() {}
+
+    // 后端名称（日志用）
+    virtual const char* name() const = 0;
+    // 加载模型文件，成功返回 0
+    virtual int init(const std::string& model_path) = 0;
+    // 由已初始化的同类实例派生（共享权重），不支持时返回 -1，调用方改用 init
+    virtual int init_from(InferenceBackend& src) { (void)src; return -1; }
+    // 预处理一帧 BGR 图像（CV_8UC3）并推理，输出保留到下一次 run；letter_box 返回坐标还原参数
+    virtual int run(const cv::Mat& frame, letterbox_t* letter_box) = 0;
+    // 输出张量描述及后处理状态（post_process 的 app_ctx 参数）
+    virtual rknn_app_context_t* model_context() = 0;
+    // 上一次 run 的输出（post_process 的 outputs 参数）
+    virtual void* outputs() = 0;
+    // 是否支持 ContextPipeline 的流水线执行（需要底层的异步推理接口）
+    virtual bool supports_pipeline() const { return false; }
+
+    // 推理并解码一帧，默认 run + post_process；后端可以覆盖以合并两步
+    virtual int infer(const cv::Mat& frame, object_detect_result_list* od_results);
+};
+
+#if defined(ENABLE_RKNN_BACKEND)
+// RKNN NPU 后端（封装 init/dup/run_yolov8_model_bgr）
+InferenceBackend* create_rknn_backend();
+#endif
+#if defined(CPU_BACKEND_SUPPORTED)
+// CPU 后端：OpenCV DNN 运行 ONNX 格式的同一 YOLOv8 图
+InferenceBackend* create_cpu_dnn_backend();
+#endif
+
+// 按模型文件选择后端：.onnx 使用 CPU（OpenCV DNN），其余使用 RKNN；对应后端未编译时返回 nullptr
+InferenceBackend* create_inference_backend(const std::string& model_path);
+
+#endif // INFERENCE_BACKEND_H
@@ -0,0 +1,54 @@
+#ifndef INPUT_RESOLUTION_POLICY_H
+#define INPUT_RESOLUTION_POLICY_H
+
+#include <mutex>
+#include <vector>
+#include "yolov8.h"
+
+// 输入分辨率策略参数
+struct InputPolicyConfig {
+    int max_objects = 4;        // 目标数超过该值时不降低分辨率（拥挤场景 NMS 前的候选也多，需要全分辨率）
+    int min_object_px = 32;     // 最小目标短边在所选输入上至少的像素数（YOLOv8 最大步长 32，低于它容易漏检）
+    int calm_frames = 15;       // 连续这么多帧都允许更低分辨率时才降低，避免来回切换
+    int probe_interval = 10;    // 低分辨率运行时每隔这么多帧用全分辨率检查一次，发现低分辨率看不到的小目标；0 为不检查
+};
+
+// 按场景负载在多个输入分辨率的模型变体之间选择：
+// 目标稀疏且足够大时使用较小的输入，出现小目标或目标变多时立即升回全分辨率
+// 变体 0 为全分辨率模型；其余变体加载完成后经 set_variant_input 登记输入尺寸才参与选择
+// choose 在提交线程调用，observe 在推理线程调用，内部加锁
+class InputResolutionPolicy {
+public:
+    explicit InputResolutionPolicy(const InputPolicyConfig& config = InputPolicyConfig()) : config_(config) {}
+
+    void set_config(const InputPolicyConfig& config);
+    // 登记变体的模型输入尺寸（变体第一个上下文就绪时调用）
+    void set_variant_input(int variant, int width, int height);
+    // 为下一帧选择变体
+    int choose();
+    // 反馈一帧的检测结果（坐标为源图像素），包括全分辨率检查帧
+    void observe(const object_detect_result_list& od_results, int src_width, int src_height);
+    // 当前稳定使用的变体（不含全分辨率检查帧）
+    int current() const;
+
+private:
+    struct VariantInput {
+        int width = 0;
+        int height = 0;
+        bool ready() const { return width > 0 && height > 0; }
+        int area() const { return width * height; }
+    };
+
+    // 本帧目标在各就绪变体中允许的最小输入面积对应的变体
+    int smallest_allowed(int count, int min_side, int src_width, int src_height) const;
+
+    InputPolicyConfig config_;
+    std::vector<VariantInput> variants_;
+    int current_ = 0;
+    int calm_count_ = 0;       // 连续允许更低分辨率的帧数
+    int calm_target_ = 0;      // 这些帧都允许的变体（取其中输入最大者）
+    unsigned int frame_count_ = 0;
+    mutable std::mutex mutex_;
+};
+
+#endif // INPUT_RESOLUTION_POLICY_H
@@ -0,0 +1,79 @@
+#ifndef LOGGER_H
+#define LOGGER_H
+
+#include <stdarg.h>
+#include <stdint.h>
+#include <atomic>
+
+// 日志级别
+#define LOG_LEVEL_DEBUG 0
+#define LOG_LEVEL_INFO 1
+#define LOG_LEVEL_WARN 2
+#define LOG_LEVEL_ERROR 3
+#define LOG_LEVEL_OFF 4
+
+// 编译期级别：低于该级别的 LOG_xxx 调用在编译时消除（参数仍做格式检查，但不求值）
+// 由 CMake 的 LOG_COMPILE_LEVEL 设置，默认 INFO，逐帧的 DEBUG 日志不进入发布版本
+#ifndef LOG_COMPILE_LEVEL
+#define LOG_COMPILE_LEVEL LOG_LEVEL_INFO
+#endif
+
+// 异步日志：每个线程写自己的无锁环形缓冲区（单生产者单消费者），后台线程汇总写到 stdout
+// 调用线程只做一次格式化和两次原子操作，不再在全局互斥锁上串行；缓冲区满时丢弃并计数，不阻塞调用线程
+// 同一线程的日志保持顺序，不同线程之间按后台线程的汇总顺序输出
+
+// 运行期级别（默认 INFO），低于它的日志在格式化前返回
+extern std::atomic<int> g_log_level;
+void log_set_level(int level);
+
+inline bool log_enabled(int level) {
+    return level >= g_log_level.load(std::memory_order_relaxed);
+}
+
+void log_write(int level, const char* format, ...) __attribute__((format(printf, 2, 3)));
+void log_vwrite(int level, const char* format, va_list args);
+
+// 等待已写入的日志全部输出（退出前、崩溃处理中调用）
+void log_flush();
+
+// 限流：interval_ms 内只放行一条，被丢弃的条数在下一条放行时给出
+class LogThrottle {
+public:
+    explicit LogThrottle(int interval_ms) : interval_ns_((int64_t)interval_ms * 1000000), next_ns_(0), suppressed_(0) {}
+    // 放行返回 true，suppressed 返回上次放行以来被丢弃的条数
+    bool allow(uint32_t* suppressed);
+
+private:
+    const int64_t interval_ns_;
+    std::atomic<int64_t> next_ns_;
+    std::atomic<uint32_t> suppressed_;
+};
+
+#define LOG_AT(level, ...)                                          \
+    do {                                                            \
+        if ((level) >= LOG_COMPILE_LEVEL && log_enabled(level)) {   \
+            log_write(level, __VA_ARGS__);                          \
+        }                                                           \
+    } while (0)
+
+#define LOG_DEBUG(...) LOG_AT(LOG_LEVEL_DEBUG, __VA_ARGS__)
+#define LOG_INFO(...) LOG_AT(LOG_LEVEL_INFO, __VA_ARGS__)
+#define LOG_WARN(...) LOG_AT(LOG_LEVEL_WARN, __VA_ARGS__)
+#define LOG_ERROR(...) LOG_AT(LOG_LEVEL_ERROR, __VA_ARGS__)
+
+// 每个调用点独立限流，用于逐帧可能反复出现的错误（如推理失败）
+#define LOG_THROTTLED(level, interval_ms, ...)                                              \
+    do {                                                                                    \
+        if ((level) >= LOG_COMPILE_LEVEL && log_enabled(level)) {                           \
+            static LogThrottle log_throttle_(interval_ms);                                  \
+            uint32_t log_suppressed_ = 0;                                                   \
+            if (log_throttle_.allow(&log_suppressed_)) {                                    \
+                log_write(level, __VA_ARGS__);                                              \
+                if (log_suppressed_ > 0) {                                                  \
+                    log_write(level, "(%u similar messages suppressed)", log_suppressed_);  \
+                }                                                                           \
+            }                                                                               \
+        }                                                                                   \
+    } while (0)
+
+#endif // LOGGER_H
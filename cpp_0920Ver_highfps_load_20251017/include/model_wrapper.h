@@ -4,9 +4,21 @@
 #include <string>
 #include <vector>
 #include <future>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include <chrono>
 #include <opencv2/opencv.hpp>
 #include "yolov8.h"  // 底层模型头文件
+#include "inference_backend.h"
 #include "thread_pool.h"  // 第三方线程池头文件
+#include "context_pipeline.h"
+#include "context_pool.h"
+#include "deadline_scheduler.h"
+#include "infer_result.h"
+#include "input_resolution_policy.h"
+#include "cascade_stage.h"
 
 // 模型推理器（封装多线程模型、推理逻辑）
 class Yolov8Model {
@@ -15,27 +27,101 @@ public:
     ~Yolov8Model();
 
     // 初始化：模型路径 + 线程数（推理线程池大小）
-    bool init(const std::string& model_path, int thread_num = 6);
-    // 提交推理任务（异步，返回future）
+    // 后端按模型文件选择：.rknn 使用 NPU，.onnx 使用 CPU（OpenCV DNN，需以 ENABLE_CPU_BACKEND 编译）
+    // pipelined 为 true 时每个上下文由独立线程流水线执行（预处理/解码与 NPU 推理重叠），所需上下文数更少；
+    // 当前后端不支持时退回逐帧顺序执行
+    // 模型以 batch>1 导出时，流水线模式按批推理（离线处理录像等吞吐优先的场景），见 set_batch_max_wait
+    bool init(const std::string& model_path, int thread_num = 6, bool pipelined = false);
+    // 批量推理时第一帧最多等待凑批的时间（毫秒），限制不足一批时的延迟；须在 init 之前调用
+    void set_batch_max_wait(int max_wait_ms);
+    // 线程亲和：每个推理线程固定优先使用同一个上下文（被占用时才借其他空闲上下文）；须在 init 之前调用
+    void set_thread_affine(bool thread_affine);
+    // 添加较小输入尺寸的模型变体（同一模型以较小输入导出），须在 init 之前调用；context_num 为该变体的上下文数
+    // 有变体时每帧由 InputResolutionPolicy 选择：场景稀疏且目标较大时用小输入，出现小目标或目标变多时立即回到全分辨率
+    void add_input_variant(const std::string& model_path, int context_num = 2);
+    // 分辨率切换策略参数
+    void set_input_policy(const InputPolicyConfig& config);
+    // 级联第二阶段模型（目前为 YOLOv8-pose），须在 init 之前调用；context_num 为其上下文数
+    // 每帧检测完成后对 config 选中的检测框裁剪图推理，关键点经完成回调的 poses 与检测结果一同交付（future 接口只返回检测结果）；
+    // 第二阶段模型加载完成前只交付检测结果
+    void set_cascade_model(const std::string& model_path, const CascadeConfig& config = CascadeConfig(),
+                           int context_num = 2);
+    // 每帧从采集时间算起的截止时间预算（毫秒），0 为不设截止时间（默认）
+    void set_frame_deadline(int deadline_ms);
+    // 提交推理任务（异步，返回future），采集时间取当前时间
     std::future<object_detect_result_list> submit_infer_task(const cv::Mat& frame);
+    // 按截止时间最早优先执行；开始推理前已过截止时间的帧不再占用上下文，其 future 抛出 InferenceSkipped
+    // 截止时间为 capture_time 加上 set_frame_deadline 的预算，或直接给出
+    std::future<object_detect_result_list> submit_infer_task(const cv::Mat& frame,
+                                                             std::chrono::steady_clock::time_point capture_time);
+    std::future<object_detect_result_list> submit_infer_task(const cv::Mat& frame,
+                                                             std::chrono::steady_clock::time_point capture_time,
+                                                             std::chrono::steady_clock::time_point deadline);
+    // 完成回调形式：结果（或跳过、失败）在推理线程中经 on_done 交付，调用方不必持有或等待 future
+    void submit_infer_task(const cv::Mat& frame, std::chrono::steady_clock::time_point capture_time,
+                           InferCallback on_done);
+    void submit_infer_task(const cv::Mat& frame, std::chrono::steady_clock::time_point capture_time,
+                           std::chrono::steady_clock::time_point deadline, InferCallback on_done);
     // 释放模型资源
     void release();
-    // 判断模型是否初始化成功
+    // 判断模型是否初始化成功（第一个上下文就绪即可接收任务，其余在后台陆续加入）
     bool is_inited() const;
+    // 当前已就绪、参与推理的上下文数（所有变体）
+    int ready_context_count() const;
+    // 推理任务等待空闲上下文的统计（所有变体；流水线模式下不借用上下文，为 0）
+    ContextPoolStats context_wait_stats() const;
+    // 因过截止时间而跳过的帧数
+    uint64_t skipped_task_count() const;
 
     ThreadPool* get_thread_pool() const {
         return thread_pool_;  // 返回私有线程池指针
     }
 
 private:
-    std::vector<rknn_app_context_t> model_contexts_;  // 多线程模型上下文
+    // 一种输入分辨率的模型及其上下文；variants_[0] 为 init 传入的全分辨率模型，级联第二阶段模型排在最后
+    struct InputVariant {
+        std::string model_path;
+        bool cascade = false;                   // 第二阶段模型：不参与分辨率选择，流水线模式下也按借用方式使用
+        int first_index = 0;                    // 在 backends_ 中的起始槽位（该变体的第一个上下文，派生源）
+        int context_num = 0;
+        std::unique_ptr<ContextPool> contexts;  // 已就绪的上下文，按就绪顺序；推理任务从中借用
+        std::atomic<bool> dup_supported{true};  // 后端是否支持由第一个上下文派生
+    };
+
+    std::vector<std::unique_ptr<InferenceBackend>> backends_;  // 每个上下文一个后端实例（init 时为所有变体分配槽位，逐个初始化）
+    std::vector<std::unique_ptr<InputVariant>> variants_;
+    std::vector<std::pair<std::string, int>> variant_requests_;  // add_input_variant 登记的变体，init 时创建
+    std::pair<std::string, int> cascade_request_;    // set_cascade_model 登记的第二阶段模型，init 时创建
+    CascadeStage cascade_;
+    int cascade_variant_ = -1;                        // 第二阶段模型在 variants_ 中的下标，未配置为 -1
+    InputResolutionPolicy input_policy_;
+    std::vector<std::thread> init_threads_;           // 后台初始化线程，release 时 join
+    bool pipelined_ = false;                          // 是否为流水线模式
+    int batch_max_wait_ms_ = 20;                      // 批量推理凑批的最长等待
+    bool thread_affine_ = false;                      // 上下文池的线程亲和模式
+    std::atomic<size_t> dispatch_count_{0};           // 流水线模式分派的轮询起点
+    std::atomic<int> frame_deadline_ms_{0};           // 截止时间预算，0 为不设
+    std::atomic<uint64_t> skipped_count_{0};          // 顺序模式下跳过的帧数（流水线模式由各流水线统计）
     ThreadPool* thread_pool_ = nullptr;               // 推理线程池
+    std::unique_ptr<DeadlineScheduler> scheduler_;    // 推理任务经它按截止时间投入线程池
     bool is_inited_ = false;                          // 初始化状态标记
+#if defined(YOLOV8_PIPELINE_SUPPORTED)
+    std::vector<std::unique_ptr<ContextPipeline>> pipelines_;  // 流水线模式下每个上下文一个
+#endif
 
-    // 内部推理函数（供线程池调用）
-    object_detect_result_list infer_internal(const cv::Mat& frame, rknn_app_context_t& ctx);
-    // 轮询获取可用模型上下文（线程安全）
-    rknn_app_context_t& get_next_context();
+    // 内部推理函数（供线程池调用）：成功返回 0；帧格式不支持或后端推理出错返回非 0，结果为空
+    int infer_internal(const cv::Mat& frame, InferenceBackend& backend, object_detect_result_list* od_results);
+    // 初始化变体 variant 的第 index 个上下文（backends_ 下标），成功后加入该变体的就绪列表
+    bool init_context(int variant, int index);
+    // 输入分辨率变体数（含全分辨率模型，不含第二阶段模型）
+    int input_variant_count() const { return (int)variants_.size() - (cascade_variant_ >= 0 ? 1 : 0); }
+    // 为下一帧选择变体（所选变体还没有就绪的上下文时使用全分辨率）
+    int choose_variant();
+    // 借用第二阶段模型的上下文，对一帧选中的检测框推理，返回姿态结果；没有选中的框、借到时已过截止时间或没有结果时返回空指针
+    PoseResults run_cascade(const cv::Mat& frame, std::chrono::steady_clock::time_point deadline,
+                            const object_detect_result_list& od_results);
+    // 按 set_frame_deadline 的预算计算截止时间
+    std::chrono::steady_clock::time_point deadline_for(std::chrono::steady_clock::time_point capture_time) const;
 };
 
 #endif // MODEL_WRAPPER_H
@@ -0,0 +1,88 @@
+#ifndef REORDER_BUFFER_H
+#define REORDER_BUFFER_H
+
+#include <stdint.h>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include "common_utils.h"
+#include "frame_pool.h"
+#include "infer_result.h"
+
+// 按序号取出的一帧
+struct ReorderedFrame {
+    uint64_t seq = 0;
+    FrameRef frame;
+    std::chrono::steady_clock::time_point capture_time;  // 采集时间，用于统计端到端延迟
+    InferStatus status = InferStatus::OK;
+    object_detect_result_list results;
+    PoseResults poses;
+};
+
+// 按序号重排推理结果：推理线程乱序交付（complete，无锁），消费线程按提交顺序取出（pop），
+// 序号连续的帧一完成就放行，不等某一个特定的 future
+// 最早的帧迟迟未完成而其后已有完成的帧时，等待超过 skip_ahead_ms 即越过它，之后到达的结果直接丢弃；0 为不越过
+// reserve 与 pop 由同一个线程（提交兼消费线程）调用
+class ReorderBuffer {
+public:
+    ReorderBuffer(int capacity, int skip_ahead_ms);
+
+    ReorderBuffer(const ReorderBuffer&) = delete;
+    ReorderBuffer& operator=(const ReorderBuffer&) = delete;
+
+    // 为一帧分配序号；对应槽位仍被占用（在途帧已达容量，或被越过的帧结果未到）时返回 false
+    bool reserve(const FrameRef& frame, std::chrono::steady_clock::time_point capture_time, uint64_t& seq);
+    // 交付 seq 的结果，可在任意线程调用
+    void complete(uint64_t seq, InferStatus status, const object_detect_result_list& results, const PoseResults& poses);
+    // 取出下一帧：下一帧尚未完成时最多等待 wait_ms（0 不等待，负数一直等待）；没有已分配的帧或等待超时返回 false
+    bool pop(ReorderedFrame& out, int wait_ms);
+
+    // 已分配、尚未取出或越过的帧数
+    int outstanding() const { return (int)(next_seq_ - head_seq_); }
+    int capacity() const { return capacity_; }
+    // 越过的帧数
+    uint64_t skipped_ahead() const { return skipped_ahead_; }
+
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    enum SlotState : int {
+        SLOT_EMPTY = 0,     // 空闲，可分配
+        SLOT_PENDING,       // 已分配，等待结果
+        SLOT_WRITING,       // 推理线程正在写入结果
+        SLOT_READY,         // 结果就绪
+        SLOT_ABANDONED      // 已被越过，结果到达后由推理线程释放
+    };
+
+    // 每个槽位独占缓存行，推理线程交付不同帧时互不干扰
+    struct alignas(64) Slot {
+        std::atomic<int> state{SLOT_EMPTY};
+        uint64_t seq = 0;
+        Clock::time_point reserve_time;
+        Clock::time_point capture_time;
+        FrameRef frame;
+        InferStatus status = InferStatus::OK;
+        object_detect_result_list results;
+        PoseResults poses;
+    };
+
+    // 不等待地取出下一帧（必要时越过超时的帧）；返回 false 时 wake 为下一次应重新检查越过条件的时间
+    bool try_pop(ReorderedFrame& out, Clock::time_point& wake);
+    // 最早的帧之后是否已有就绪的帧
+    bool later_ready() const;
+
+    const int capacity_;
+    const std::chrono::milliseconds skip_ahead_;
+    AlignedArray<Slot> slots_;       // 每个槽位按缓存行对齐
+    uint64_t next_seq_ = 0;          // 下一个分配的序号（提交兼消费线程）
+    uint64_t head_seq_ = 0;          // 下一个取出的序号（提交兼消费线程）
+    uint64_t skipped_ahead_ = 0;
+    // 只在消费方等待时使用：交付方写入就绪后若有等待者才加锁唤醒
+    std::atomic<bool> waiting_{false};
+    std::mutex wait_mutex_;
+    std::condition_variable wait_cond_;
+};
+
+#endif // REORDER_BUFFER_H
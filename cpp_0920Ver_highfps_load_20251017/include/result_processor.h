@@ -19,11 +19,14 @@ public:
 
     // 核心接口：处理推理结果并绘制到帧
     // 输入：推理结果、原始帧、追踪器、FPS统计器
-    // 输出：绘制后的帧（通过引用修改）
+    // 输出：绘制后的帧（在 frame 上原地绘制），缩放到显示尺寸后写入 display（尺寸不变时复用其缓冲区）
+    // poses 为级联姿态结果，没有时为 nullptr
     void process_and_draw(const object_detect_result_list& od_results,
                            cv::Mat& frame,
                            const TrackerWrapper& tracker,
-                           const FPSCounter& fps_counter);
+                           const FPSCounter& fps_counter,
+                           cv::Mat& display,
+                           const object_pose_result_list* poses = nullptr);
 
 private:
     ThreadPool* draw_thread_pool_ = nullptr;
@@ -55,6 +58,9 @@ private:
     void draw_single_detection(const object_detect_result& det,
                                 int track_id,
                                 cv::Mat& frame);
+
+    // 内部辅助：单个人体的关键点与骨架绘制（级联姿态模型的结果）
+    void draw_pose(const object_pose_result& pose, cv::Mat& frame);
 };
 
 #endif // RESULT_PROCESSOR_H
\ No newline at end of file
@@ -0,0 +1,112 @@
+#ifndef STREAM_RUNNER_H
+#define STREAM_RUNNER_H
+
+#include <stdint.h>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <opencv2/opencv.hpp>
+#include "admission_controller.h"
+#include "common_utils.h"
+#include "frame_pool.h"
+#include "model_wrapper.h"
+#include "result_processor.h"
+#include "stream_scheduler.h"
+#include "tracker_wrapper.h"
+#include "video_capture.h"
+
+// 多路服务中一路流的参数
+struct StreamConfig {
+    std::string source;   // 摄像头ID或视频文件路径
+    int weight = 1;       // 共享模型时的推理份额
+    int width = 800;
+    int height = 600;
+    int fps = 60;
+};
+
+// 一路流的统计：窗口值为上次 report(true) 以来，总计值为启动以来
+struct StreamReport {
+    uint64_t read = 0;              // 读取的帧数
+    uint64_t completed = 0;         // 完成（推理+跟踪+绘制）的帧数
+    double fps = 0;                 // 窗口内完成帧率
+    double avg_latency_ms = 0;      // 窗口内 采集→绘制完成 的平均延迟
+    double max_latency_ms = 0;      // 窗口内最大延迟
+    double total_fps = 0;
+    double total_avg_latency_ms = 0;
+    double total_max_latency_ms = 0;
+    AdmissionStats admission;
+    StreamQueueStats queue;
+};
+
+// 多路服务中的一路：独立的采集、帧缓冲池、准入控制（含重排状态）、跟踪器与绘制，推理经 StreamScheduler
+// 与其他路共享同一个模型；在自己的线程中循环 采集→送入→按序取结果→跟踪→绘制
+// 窗口显示（HighGUI）须在主线程：绘制好的最新一帧由主线程经 take_display 取走
+class StreamRunner {
+public:
+    StreamRunner(Yolov8Model& model, StreamScheduler& scheduler);
+    ~StreamRunner();
+
+    StreamRunner(const StreamRunner&) = delete;
+    StreamRunner& operator=(const StreamRunner&) = delete;
+
+    // 打开源并在 scheduler 上注册；max_in_flight 为本路的在途帧数上限（多路合计由 scheduler 限制）
+    bool init(const StreamConfig& config, int max_in_flight);
+    void start();
+    // 请求停止并等待线程结束：排队帧丢弃，已提交的帧取完
+    void stop();
+
+    // 源已读完或已停止
+    bool finished() const { return finished_.load(); }
+    bool is_live() const { return cap_.is_live(); }
+    const StreamConfig& config() const { return config_; }
+    // 取走上次调用以来绘制好的最新一帧（已缩放到显示尺寸），没有新帧返回 false
+    bool take_display(cv::Mat& display);
+    // reset_window 为 true 时开始新的统计窗口
+    StreamReport report(bool reset_window);
+
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    void run();
+    // 跟踪、绘制并发布一帧
+    void present(FrameRef& frame, const object_detect_result_list& results, const PoseResults& poses,
+                 Clock::time_point capture_time);
+    void record_completed(Clock::time_point capture_time);
+
+    Yolov8Model& model_;
+    StreamScheduler& scheduler_;
+    StreamConfig config_;
+    int stream_id_ = -1;
+
+    // 以下只在本路线程中使用
+    VideoCaptureWrapper cap_;
+    FramePool frame_pool_;
+    AdmissionController admission_;
+    TrackerWrapper tracker_;
+    ResultProcessor processor_;
+    FPSCounter fps_;
+    cv::Mat drawn_;
+
+    std::thread thread_;
+    std::atomic<bool> stop_{false};
+    std::atomic<bool> finished_{false};
+
+    // 与主线程共享，mutex_ 保护
+    std::mutex mutex_;
+    cv::Mat display_;
+    bool has_display_ = false;
+    uint64_t read_ = 0;
+    uint64_t completed_ = 0;
+    double total_latency_ms_ = 0;
+    double total_max_latency_ms_ = 0;
+    uint64_t window_completed_ = 0;
+    double window_latency_ms_ = 0;
+    double window_max_latency_ms_ = 0;
+    Clock::time_point start_time_;
+    Clock::time_point window_start_;
+    AdmissionStats admission_stats_;
+};
+
+#endif // STREAM_RUNNER_H
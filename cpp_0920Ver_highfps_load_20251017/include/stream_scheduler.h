@@ -0,0 +1,82 @@
+#ifndef STREAM_SCHEDULER_H
+#define STREAM_SCHEDULER_H
+
+#include <stdint.h>
+#include <chrono>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <opencv2/opencv.hpp>
+#include "model_wrapper.h"
+
+// 单路流的排队统计
+struct StreamQueueStats {
+    uint64_t submitted = 0;        // 送入公平队列的帧数
+    uint64_t dispatched = 0;       // 提交给模型的帧数
+    uint64_t total_wait_us = 0;    // 在公平队列中的累计等待时间
+    uint64_t max_wait_us = 0;      // 在公平队列中的最长等待时间
+    int queued = 0;                // 当前排队帧数
+};
+
+// 多路视频流共享一个 Yolov8Model（同一个上下文池）时的加权公平调度：
+// 各路的帧先进入自己的队列，模型在途帧数达到上限后按起始时间公平排队（SFQ）选出下一帧，
+// 每路按权重分得推理份额，繁忙的一路不会让其他路饿死；只有一路有帧时可用满全部在途名额
+// 各路的帧数由各自的 AdmissionController 限制，这里不丢帧
+// 线程安全：submit 可在各路线程调用，完成回调在推理线程中提交下一帧
+// 须在 Yolov8Model::release 之前 close，在其之后销毁（迟到的完成回调仍会访问调度器）
+class StreamScheduler {
+public:
+    // max_in_flight 为所有流合计的在途帧数上限，一般取模型的推理线程数
+    StreamScheduler(Yolov8Model& model, int max_in_flight);
+    ~StreamScheduler();
+
+    StreamScheduler(const StreamScheduler&) = delete;
+    StreamScheduler& operator=(const StreamScheduler&) = delete;
+
+    // 注册一路流，返回流编号；weight 为相对份额（>=1）
+    int add_stream(int weight = 1);
+    // 送入一帧：在途帧数未达上限时直接提交给模型，否则排队；结果经 on_done 交付
+    void submit(int stream, const cv::Mat& frame, std::chrono::steady_clock::time_point capture_time,
+                InferCallback on_done);
+    // 停止调度：排队帧以 SKIPPED 交付，之后送入的帧直接以 SKIPPED 交付；已提交的帧不受影响
+    void close();
+
+    int stream_count() const;
+    int in_flight() const;
+    StreamQueueStats stats(int stream) const;
+
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    struct Pending {
+        cv::Mat frame;
+        Clock::time_point capture_time;
+        Clock::time_point enqueue_time;
+        double start_tag;             // 虚拟起始时间
+        InferCallback on_done;
+    };
+
+    struct Stream {
+        int weight = 1;
+        double finish_tag = 0;        // 最后一帧的虚拟结束时间
+        std::deque<Pending> queue;
+        StreamQueueStats stats;
+    };
+
+    // 取出起始时间最小的一帧并占用在途名额（调用方持锁）；没有可提交的帧返回 -1
+    int take_next(Pending& next);
+    // 在锁外提交给模型，完成后释放名额并提交下一帧
+    void dispatch(Pending& pending);
+    void on_complete();
+
+    Yolov8Model& model_;
+    const int max_in_flight_;
+    mutable std::mutex mutex_;
+    std::vector<std::unique_ptr<Stream>> streams_;
+    double virtual_time_ = 0;         // 最近提交的一帧的虚拟起始时间
+    int in_flight_ = 0;
+    bool closed_ = false;
+};
+
+#endif // STREAM_SCHEDULER_H
@@ -14,14 +14,19 @@ public:
     bool init(const std::string& device, int width = 800, int height = 640, int fps = 60);
     // 读取一帧（成功返回true，frame存储结果）
     bool read_frame(cv::Mat& frame);
+    // 实际输出的帧尺寸（init 成功后有效），用于预分配帧缓冲区
+    cv::Size frame_size() const;
     // 释放资源
     void release();
     // 判断是否初始化成功
     bool is_opened() const;
+    // 是否为实时源（USB / 网络摄像头）；视频文件为 false
+    bool is_live() const { return is_live_; }
 
 private:
     cv::VideoCapture cap_;  // 隐藏的OpenCV捕获对象
     bool is_initialized_ = false;  // 初始化状态标记
+    bool is_live_ = false;         // 实时源标记
 };
 
 #endif // VIDEO_CAPTURE_H
\ No newline at end of file
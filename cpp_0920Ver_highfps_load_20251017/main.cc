@@ -1,22 +1,166 @@
 #include <iostream>
 #include <vector>
 #include <future>
+#include <algorithm>
 #include <opencv2/opencv.hpp>
 #include <chrono>  // 用于计时
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
 
 #include "model_wrapper.h"
 #include "video_capture.h"
 #include "tracker_wrapper.h"
 #include "result_processor.h"
 #include "common_utils.h"
+#include "logger.h"
+#include "frame_pool.h"
+#include "admission_controller.h"
+#include "tensor_capture.h"
+#include "stream_scheduler.h"
+#include "stream_runner.h"
 
+// 解析多路源参数："0,1@2,video.mp4"，逗号分隔，"@数字" 后缀为该路的推理份额（默认 1）
+static void parse_streams(const std::string& arg, std::vector<StreamConfig>& streams) {
+    size_t begin = 0;
+    while (begin <= arg.size()) {
+        size_t end = arg.find(',', begin);
+        if (end == std::string::npos) {
+            end = arg.size();
+        }
+        StreamConfig config;
+        config.source = arg.substr(begin, end - begin);
+        size_t at = config.source.rfind('@');
+        if (at != std::string::npos && at + 1 < config.source.size() &&
+            config.source.find_first_not_of("0123456789", at + 1) == std::string::npos) {
+            config.weight = std::max(1, atoi(config.source.c_str() + at + 1));
+            config.source.resize(at);
+        }
+        if (!config.source.empty()) {
+            streams.push_back(config);
+        }
+        begin = end + 1;
+    }
+}
+
+static void print_stream_reports(std::vector<std::unique_ptr<StreamRunner>>& runners, bool total) {
+    double fps_sum = 0;
+    for (size_t i = 0; i < runners.size(); ++i) {
+        StreamReport report = runners[i]->report(true);
+        double fps = total ? report.total_fps : report.fps;
+        fps_sum += fps;
+        double avg_wait = report.queue.dispatched > 0 ? report.queue.total_wait_us / 1000.0 / report.queue.dispatched : 0;
+        printf("[流%d %s 权重%d] 已读取:%llu | 已完成:%llu | FPS: %.1f | 延迟 平均: %.1fms 最大: %.1fms | "
+               "公平队列等待 平均: %.2fms 最大: %.2fms\n",
+               (int)i, runners[i]->config().source.c_str(), runners[i]->config().weight,
+               (unsigned long long)report.read, (unsigned long long)report.completed, fps,
+               total ? report.total_avg_latency_ms : report.avg_latency_ms,
+               total ? report.total_max_latency_ms : report.max_latency_ms, avg_wait, report.queue.max_wait_us / 1000.0);
+        if (total) {
+            printf("[流%d 准入控制] 送入: %llu | 提交: %llu | 丢弃: %llu | 过期跳过: %llu | 超时越过: %llu\n", (int)i,
+                   (unsigned long long)report.admission.offered, (unsigned long long)report.admission.submitted,
+                   (unsigned long long)report.admission.dropped, (unsigned long long)report.admission.skipped,
+                   (unsigned long long)report.admission.skipped_ahead);
+        }
+    }
+    printf("[多路合计] %d路 | FPS: %.1f\n", (int)runners.size(), fps_sum);
+    fflush(stdout);
+}
+
+// 多路模式：所有流共享一个模型（同一个上下文池），经 StreamScheduler 加权公平地提交；
+// 每路在自己的线程中采集、跟踪、绘制，主线程只负责显示与统计
+static int run_multi_stream(const char* model_path, const std::vector<StreamConfig>& configs) {
+    const int thread_num = 6;
+    Yolov8Model model;
+    if (!model.init(model_path, thread_num)) {
+        std::cerr << "初始化失败\n";
+        model.release();
+        return -1;
+    }
+    // 所有流合计的在途帧数以推理线程数为上限；每路也可单独用满（其他路空闲时不浪费 NPU）
+    StreamScheduler scheduler(model, thread_num);
+    std::vector<std::unique_ptr<StreamRunner>> runners;
+    bool live = false;
+    for (const StreamConfig& config : configs) {
+        std::unique_ptr<StreamRunner> runner(new StreamRunner(model, scheduler));
+        if (!runner->init(config, thread_num)) {
+            std::cerr << "初始化失败: " << config.source << "\n";
+            runners.clear();
+            scheduler.close();
+            model.release();
+            return -1;
+        }
+        live = live || runner->is_live();
+        runners.push_back(std::move(runner));
+    }
+    if (live) {
+        model.set_frame_deadline(200);
+    }
+    std::vector<std::string> windows;
+    for (size_t i = 0; i < runners.size(); ++i) {
+        windows.push_back(cv::format("YOLOv8 [%d]", (int)i));
+        cv::namedWindow(windows[i]);
+    }
+
+    for (auto& runner : runners) {
+        runner->start();
+    }
+    std::vector<cv::Mat> displays(runners.size());
+    auto last_report_time = std::chrono::steady_clock::now();
+    while (true) {
+        bool all_finished = true;
+        for (size_t i = 0; i < runners.size(); ++i) {
+            if (runners[i]->take_display(displays[i])) {
+                cv::imshow(windows[i], displays[i]);
+            }
+            all_finished = all_finished && runners[i]->finished();
+        }
+        if (all_finished) {
+            break;
+        }
+        auto now = std::chrono::steady_clock::now();
+        if (now - last_report_time >= std::chrono::seconds(5)) {
+            print_stream_reports(runners, false);
+            last_report_time = now;
+        }
+        // 按键退出（按ESC）
+        if (cv::waitKey(1) == 27) {
+            break;
+        }
+    }
+
+    // 各路取完已提交的帧后再关闭调度器、释放模型
+    printf("\n正在等待剩余推理任务完成...\n");
+    for (auto& runner : runners) {
+        runner->stop();
+    }
+    scheduler.close();
+    printf("\n[fps全局统计]\n");
+    print_stream_reports(runners, true);
+
+    model.release();
+    runners.clear();
+    cv::destroyAllWindows();
+    return 0;
+}
 
 int main(int argc, char** argv) {
     // 参数检查
-    if (argc != 3) {
-        std::cerr << "用法: " << argv[0] << " <模型路径> <摄像头ID>\n";
+    if (argc != 3 && argc != 4) {
+        std::cerr << "用法: " << argv[0] << " <模型路径(.rknn / .onnx)> <摄像头ID> [张量录制文件]\n";
+        std::cerr << "多路: " << argv[0] << " <模型路径> <源1[@权重],源2[@权重],...>\n";
         return -1;
     }
+    // 源参数含逗号时进入多路模式
+    if (strchr(argv[2], ',')) {
+        std::vector<StreamConfig> streams;
+        parse_streams(argv[2], streams);
+        if (argc == 4) {
+            std::cerr << "多路模式不支持张量录制，已忽略\n";
+        }
+        return run_multi_stream(argv[1], streams);
+    }
 
     // 模块初始化
     VideoCaptureWrapper cap;
@@ -24,20 +168,42 @@ int main(int argc, char** argv) {
     TrackerWrapper tracker;
     ResultProcessor processor;
     FPSCounter fps;
-    std::vector<std::future<object_detect_result_list>> futures;
+    FramePool frame_pool;
+    AdmissionController admission(model);
+    cv::Mat display;  // 绘制后缩放到显示尺寸的帧，逐帧复用
     const int thread_num = 6;
     bool running = true;
 
     // 初始化流程
-    if (!cap.init(argv[2], 800, 600, 60) || 
-        !model.init(argv[1], thread_num) || 
-        !processor.init(model.get_thread_pool())) {
+    bool ok = cap.init(argv[2], 800, 600, 60) && model.init(argv[1], thread_num) &&
+              processor.init(model.get_thread_pool());
+    if (ok) {
+        // 在途帧数以推理线程数为上限；实时源推理跟不上时只保留最新一帧排队，视频文件等待不丢帧
+        AdmissionConfig admission_config;
+        admission_config.max_in_flight = thread_num;
+        admission_config.policy = cap.is_live() ? DropPolicy::LATEST_WINS : DropPolicy::BLOCK;
+        // 实时源：最早的帧 100ms 未完成而其后已有完成的帧时越过它，显示不被一帧卡住
+        admission_config.skip_ahead_ms = cap.is_live() ? 100 : 0;
+        admission.set_config(admission_config);
+        // 实时源：采集后 200ms 仍未开始推理的帧直接跳过（突发积压时不再为过时的帧占用 NPU）
+        if (cap.is_live()) {
+            model.set_frame_deadline(200);
+        }
+        // 在途帧 + 排队帧（视频文件至多一帧） + 正在绘制显示的一帧 + 正在读取的一帧
+        int buffers = admission.config().max_in_flight + std::max(admission.config().queue_depth, 1) + 2;
+        ok = frame_pool.init(buffers, cap.frame_size().width, cap.frame_size().height);
+    }
+    if (!ok) {
         std::cerr << "初始化失败\n";
         model.release();
         cap.release();
         return -1;
     }
     tracker.Init();
+    // 录制每帧的原始输出张量，供 replay 离线回放后处理与跟踪
+    if (argc == 4 && tensor_capture_start(argv[3], 0) != 0) {
+        std::cerr << "张量录制启动失败\n";
+    }
     cv::namedWindow("YOLOv8");
 
     // 计时相关变量 - 修正版
@@ -56,58 +222,72 @@ int main(int argc, char** argv) {
     auto last_frame_end_time = std::chrono::steady_clock::now();  // 上一帧结束时间
 
     // 主循环
-    int frame_idx = 0;
-    cv::Mat frame;
-    while (running && cap.read_frame(frame)) {
-        total_read_frame++;  // 累计读取的帧
-        
-        // 1. 统计帧读取耗时
-        auto read_end_time = std::chrono::steady_clock::now();
-        double read_cost = std::chrono::duration<double, std::milli>(read_end_time - last_frame_end_time).count();
-        temp_read_time += read_cost;
-
-        // 2. 提交推理任务 - 统计耗时
-        auto submit_start_time = std::chrono::steady_clock::now();
-        futures.push_back(model.submit_infer_task(frame));
-        auto submit_end_time = std::chrono::steady_clock::now();
-        double submit_cost = std::chrono::duration<double, std::milli>(submit_end_time - submit_start_time).count();
-        temp_submit_time += submit_cost;
+    FrameRef done;
+    object_detect_result_list results;
+    PoseResults poses;
+    std::chrono::steady_clock::time_point done_capture_time;
+    while (running) {
+        // 取一个空闲的帧缓冲区；全部在用（背压）时先等待最早的一帧完成，不覆盖仍在使用的缓冲区
+        FrameRef frame = frame_pool.acquire();
+        bool backpressure = !frame;
+        if (backpressure) {
+            LOG_THROTTLED(LOG_LEVEL_WARN, 1000, "Frame pool exhausted (%d buffers), waiting for oldest frame",
+                          frame_pool.capacity());
+            if (admission.submitted_count() == 0 && admission.queued_count() == 0) {
+                break;
+            }
+        } else {
+            if (!cap.read_frame(*frame)) {
+                break;
+            }
+            total_read_frame++;  // 累计读取的帧
+
+            // 1. 统计帧读取耗时
+            auto read_end_time = std::chrono::steady_clock::now();
+            double read_cost = std::chrono::duration<double, std::milli>(read_end_time - last_frame_end_time).count();
+            temp_read_time += read_cost;
+
+            // 2. 提交推理任务（经准入控制，窗口满时按策略排队或丢帧）- 统计耗时
+            auto submit_start_time = std::chrono::steady_clock::now();
+            admission.offer(frame, read_end_time);
+            frame.reset();
+            auto submit_end_time = std::chrono::steady_clock::now();
+            double submit_cost = std::chrono::duration<double, std::milli>(submit_end_time - submit_start_time).count();
+            temp_submit_time += submit_cost;
+        }
 
         // 3. 处理推理结果 + 4. 显示（只有处理完推理的帧才计入“完成帧”）
-        if (frame_idx++ >= thread_num && !futures.empty()) {
-            auto process_start_time = std::chrono::steady_clock::now();
-            
-            auto& f = futures.front();
-            if (f.valid()) {
-                try {
-                    auto results = f.get();
-                    tracker.Update(results, frame.size());
-                    processor.process_and_draw(results, frame, tracker, fps);
-
-                    // 处理完成后才显示并统计为“完成帧”
-                    auto show_start_time = std::chrono::steady_clock::now();
-                    cv::imshow("YOLOv8", frame);
-                    fps.increment_frame();
-                    auto show_end_time = std::chrono::steady_clock::now();
-                    
-                    // 统计显示耗时
-                    double show_cost = std::chrono::duration<double, std::milli>(show_end_time - show_start_time).count();
-                    temp_show_time += show_cost;
-
-                    total_completed_frame++;  // 只有处理完的帧才累计
-                } catch (...) { std::cerr << "处理帧失败\n"; }
-            }
-            futures.erase(futures.begin());
+        // 按提交顺序取出已完成的帧，结果绘制在它自己的帧上；
+        // 不等待未完成的帧，除非缓冲区耗尽或视频文件（不丢帧）有帧在排队
+        auto process_start_time = std::chrono::steady_clock::now();
+        while (admission.next_completed(done, results, (backpressure || admission.backlogged()) ? -1 : 0,
+                                        done_capture_time, poses)) {
+            backpressure = false;
+            try {
+                tracker.Update(results, done->size());
+                processor.process_and_draw(results, *done, tracker, fps, display, poses.get());
+                done.reset();  // 帧缓冲区归还帧缓冲池
 
-            // 统计处理结果耗时（包含推理等待+跟踪+绘制）
-            auto process_end_time = std::chrono::steady_clock::now();
-            double process_cost = std::chrono::duration<double, std::milli>(process_end_time - process_start_time).count();
-            temp_process_time += process_cost;
-        } else {
-            // 未处理的帧不显示（或显示原始帧，但不计入完成帧）
-            cv::imshow("YOLOv8", frame);
+                // 处理完成后才显示并统计为“完成帧”
+                auto show_start_time = std::chrono::steady_clock::now();
+                cv::imshow("YOLOv8", display);
+                fps.increment_frame();
+                auto show_end_time = std::chrono::steady_clock::now();
+
+                // 统计显示耗时
+                double show_cost = std::chrono::duration<double, std::milli>(show_end_time - show_start_time).count();
+                temp_show_time += show_cost;
+
+                total_completed_frame++;  // 只有处理完的帧才累计
+            } catch (...) { std::cerr << "处理帧失败\n"; }
+            done.reset();
         }
 
+        // 统计处理结果耗时（包含跟踪+绘制+显示）
+        auto process_end_time = std::chrono::steady_clock::now();
+        double process_cost = std::chrono::duration<double, std::milli>(process_end_time - process_start_time).count();
+        temp_process_time += process_cost;
+
         // 每10个完成帧打印一次统计（用完成帧计数，更准确）
         if (total_completed_frame % 10 == 0 && total_completed_frame != last_completed_frame) {
             // 计算最近10个完成帧的耗时
@@ -148,24 +328,20 @@ int main(int argc, char** argv) {
     }
 
     // -------------------------- 新增修改1：处理剩余未完成的推理任务 --------------------------
-    // 避免futures.clear()时因未完成任务阻塞，确保全局统计能执行
+    // 排队帧不再提交，等待已提交的帧完成，确保全局统计能执行
     printf("\n正在等待剩余推理任务完成...\n");
-    for (auto& f : futures) {
-        if (f.valid()) {
-            try {
-                // 等待任务完成（超时1秒，防止无限阻塞）
-                if (f.wait_for(std::chrono::seconds(1)) == std::future_status::ready) {
-                    auto unused = f.get();  // 读取结果，释放future资源
-                    total_completed_frame++; // 补加未统计的完成帧
-                } else {
-                    std::cerr << "部分推理任务超时未完成，已跳过\n";
-                }
-            } catch (...) {
-                std::cerr << "处理剩余推理任务时出错\n";
+    admission.discard_queued();
+    while (admission.submitted_count() > 0) {
+        // 等待任务完成（超时1秒，防止无限阻塞）
+        if (!admission.next_completed(done, results, 1000)) {
+            if (admission.submitted_count() > 0) {
+                std::cerr << "部分推理任务超时未完成，已跳过\n";
             }
+            break;
         }
+        total_completed_frame++; // 补加未统计的完成帧
     }
-    futures.clear(); // 此时futures已无阻塞任务，可安全清理
+    done.reset();
     // ----------------------------------------------------------------------------------------
 
     // 最终全局统计
@@ -176,10 +352,19 @@ int main(int argc, char** argv) {
            total_completed_frame, global_elapsed, global_fps);
     
     // -------------------------- 新增修改2：强制刷新控制台输出 --------------------------
+    AdmissionStats admission_stats = admission.stats();
+    printf("[准入控制] 送入: %llu | 提交: %llu | 丢弃: %llu | 过期跳过: %llu | 超时越过: %llu\n",
+           (unsigned long long)admission_stats.offered, (unsigned long long)admission_stats.submitted,
+           (unsigned long long)admission_stats.dropped, (unsigned long long)admission_stats.skipped,
+           (unsigned long long)admission_stats.skipped_ahead);
+    FramePoolStats pool_stats = frame_pool.stats();
+    printf("[帧缓冲池] 取帧: %llu | 背压: %llu | 重新分配: %llu\n", (unsigned long long)pool_stats.acquired,
+           (unsigned long long)pool_stats.exhausted, (unsigned long long)pool_stats.reallocated);
     fflush(stdout); // 确保全局统计信息能立即显示，避免卡在输出缓冲区
     // ----------------------------------------------------------------------------------------
 
     // 资源释放
+    tensor_capture_stop();
     model.release();
     cap.release();
     cv::destroyAllWindows();
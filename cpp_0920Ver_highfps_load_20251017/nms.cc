@@ -0,0 +1,292 @@
+#include "nms.h"
+
+#include <string.h>
+
+#include <algorithm>
+#include <functional>
+
+#if defined(__aarch64__)
+#include <arm_neon.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+/**
+ * @brief 将分数与下标合成可排序的 64 位键：分数降序，分数相同时下标升序
+ */
+static inline uint64_t make_key(float score, int index)
+{
+    uint32_t bits;
+    memcpy(&bits, &score, sizeof(bits));
+    // 浮点位模式转换为单调递增的无符号整数（兼容负数）
+    bits = (bits & 0x80000000u) ? ~bits : (bits | 0x80000000u);
+    return ((uint64_t)bits << 32) | (uint32_t)~(uint32_t)index;
+}
+
+static inline int key_index(uint64_t key) { return (int)~(uint32_t)key; }
+
+static inline int grid_coord(float v, float origin, int cells)
+{
+    int c = (int)((v - origin) / NMS_GRID_CELL_SIZE);
+    return c < 0 ? 0 : (c >= cells ? cells - 1 : c);
+}
+
+/**
+ * @brief 计算两个框的 IoU 是否超过阈值（与原 CalculateOverlap 一致，宽高按 +1 像素计算）
+ */
+static inline bool overlap_exceeds(float x1, float y1, float x2, float y2, float area,
+                                   float kx1, float ky1, float kx2, float ky2, float karea, float threshold)
+{
+    float w = std::max(0.f, std::min(x2, kx2) - std::max(x1, kx1) + 1.f);
+    float h = std::max(0.f, std::min(y2, ky2) - std::max(y1, ky1) + 1.f);
+    float inter = w * h;
+    float uni = area + karea - inter;
+    return uni > 0.f && inter > threshold * uni;
+}
+
+bool NmsEngine::suppressed_linear(float x1, float y1, float x2, float y2, float area, int kept_num,
+                                  float threshold) const
+{
+    int k = 0;
+#if defined(__aarch64__)
+    const float32x4_t vx1 = vdupq_n_f32(x1), vy1 = vdupq_n_f32(y1);
+    const float32x4_t vx2 = vdupq_n_f32(x2), vy2 = vdupq_n_f32(y2);
+    const float32x4_t varea = vdupq_n_f32(area), vthr = vdupq_n_f32(threshold);
+    const float32x4_t zero = vdupq_n_f32(0.f), one = vdupq_n_f32(1.f);
+    for (; k + 4 <= kept_num; k += 4)
+    {
+        float32x4_t w = vsubq_f32(vminq_f32(vx2, vld1q_f32(&kept_x2_[k])), vmaxq_f32(vx1, vld1q_f32(&kept_x1_[k])));
+        float32x4_t h = vsubq_f32(vminq_f32(vy2, vld1q_f32(&kept_y2_[k])), vmaxq_f32(vy1, vld1q_f32(&kept_y1_[k])));
+        w = vmaxq_f32(zero, vaddq_f32(w, one));
+        h = vmaxq_f32(zero, vaddq_f32(h, one));
+        float32x4_t inter = vmulq_f32(w, h);
+        float32x4_t uni = vsubq_f32(vaddq_f32(varea, vld1q_f32(&kept_area_[k])), inter);
+        uint32x4_t hit = vandq_u32(vcgtq_f32(uni, zero), vcgtq_f32(inter, vmulq_f32(vthr, uni)));
+        if (vmaxvq_u32(hit) != 0)
+        {
+            return true;
+        }
+    }
+#elif defined(__SSE2__)
+    const __m128 vx1 = _mm_set1_ps(x1), vy1 = _mm_set1_ps(y1);
+    const __m128 vx2 = _mm_set1_ps(x2), vy2 = _mm_set1_ps(y2);
+    const __m128 varea = _mm_set1_ps(area), vthr = _mm_set1_ps(threshold);
+    const __m128 zero = _mm_setzero_ps(), one = _mm_set1_ps(1.f);
+    for (; k + 4 <= kept_num; k += 4)
+    {
+        __m128 w = _mm_sub_ps(_mm_min_ps(vx2, _mm_loadu_ps(&kept_x2_[k])), _mm_max_ps(vx1, _mm_loadu_ps(&kept_x1_[k])));
+        __m128 h = _mm_sub_ps(_mm_min_ps(vy2, _mm_loadu_ps(&kept_y2_[k])), _mm_max_ps(vy1, _mm_loadu_ps(&kept_y1_[k])));
+        w = _mm_max_ps(zero, _mm_add_ps(w, one));
+        h = _mm_max_ps(zero, _mm_add_ps(h, one));
+        __m128 inter = _mm_mul_ps(w, h);
+        __m128 uni = _mm_sub_ps(_mm_add_ps(varea, _mm_loadu_ps(&kept_area_[k])), inter);
+        __m128 hit = _mm_and_ps(_mm_cmpgt_ps(uni, zero), _mm_cmpgt_ps(inter, _mm_mul_ps(vthr, uni)));
+        if (_mm_movemask_ps(hit) != 0)
+        {
+            return true;
+        }
+    }
+#endif
+    for (; k < kept_num; k++)
+    {
+        if (overlap_exceeds(x1, y1, x2, y2, area, kept_x1_[k], kept_y1_[k], kept_x2_[k], kept_y2_[k], kept_area_[k],
+                            threshold))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool NmsEngine::suppressed_grid(float x1, float y1, float x2, float y2, float area, float threshold, int stamp,
+                                float origin_x, float origin_y, int cols, int rows)
+{
+    // 只有与候选框落在同一网格单元的已保留框才可能重叠
+    int c0 = grid_coord(x1, origin_x, cols), c1 = grid_coord(x2 + 1.f, origin_x, cols);
+    int r0 = grid_coord(y1, origin_y, rows), r1 = grid_coord(y2 + 1.f, origin_y, rows);
+    for (int r = r0; r <= r1; r++)
+    {
+        for (int c = c0; c <= c1; c++)
+        {
+            for (int k : grid_cells_[r * cols + c])
+            {
+                if (grid_stamp_[k] == stamp)
+                {
+                    continue;
+                }
+                grid_stamp_[k] = stamp;
+                if (overlap_exceeds(x1, y1, x2, y2, area, kept_x1_[k], kept_y1_[k], kept_x2_[k], kept_y2_[k],
+                                    kept_area_[k], threshold))
+                {
+                    return true;
+                }
+            }
+        }
+    }
+    return false;
+}
+
+void NmsEngine::reserve(int max_count, int class_num, int max_keep)
+{
+    bucket_start_.reserve(class_num + 1);
+    bucket_items_.reserve(max_count);
+    heap_.reserve(max_count);
+    kept_x1_.reserve(max_keep);
+    kept_y1_.reserve(max_keep);
+    kept_x2_.reserve(max_keep);
+    kept_y2_.reserve(max_keep);
+    kept_area_.reserve(max_keep);
+    kept_keys_.reserve(std::min(max_count, max_keep * class_num));
+    grid_stamp_.reserve(max_keep);
+    grid_cells_.resize(NMS_GRID_MAX_DIM * NMS_GRID_MAX_DIM);
+    for (auto &cell : grid_cells_)
+    {
+        cell.reserve(max_keep);
+    }
+}
+
+/**
+ * @brief 单个类别的贪心 NMS：按分数惰性出堆，与已保留框比较，保留满 max_keep 个即停止
+ * @return 该类别保留数量
+ */
+int NmsEngine::nms_class(const float *boxes, const float *scores, const int *items, int n, float threshold,
+                         int max_keep)
+{
+    heap_.clear();
+    for (int k = 0; k < n; k++)
+    {
+        heap_.push_back(make_key(scores[items[k]], items[k]));
+    }
+    std::make_heap(heap_.begin(), heap_.end());
+
+    kept_x1_.clear();
+    kept_y1_.clear();
+    kept_x2_.clear();
+    kept_y2_.clear();
+    kept_area_.clear();
+
+    // 候选很多时（密集场景）用空间网格把比较范围限制在相邻单元内
+    bool use_grid = n >= NMS_GRID_MIN_CANDIDATES;
+    float origin_x = 0, origin_y = 0;
+    int cols = 1, rows = 1;
+    if (use_grid)
+    {
+        float max_x = boxes[items[0] * 4 + 0], max_y = boxes[items[0] * 4 + 1];
+        origin_x = max_x;
+        origin_y = max_y;
+        for (int k = 0; k < n; k++)
+        {
+            const float *b = boxes + items[k] * 4;
+            origin_x = std::min(origin_x, b[0]);
+            origin_y = std::min(origin_y, b[1]);
+            max_x = std::max(max_x, b[0] + b[2] + 1.f);
+            max_y = std::max(max_y, b[1] + b[3] + 1.f);
+        }
+        cols = std::min((int)((max_x - origin_x) / NMS_GRID_CELL_SIZE) + 1, NMS_GRID_MAX_DIM);
+        rows = std::min((int)((max_y - origin_y) / NMS_GRID_CELL_SIZE) + 1, NMS_GRID_MAX_DIM);
+        if (grid_cells_.size() < NMS_GRID_MAX_DIM * NMS_GRID_MAX_DIM)
+        {
+            grid_cells_.resize(NMS_GRID_MAX_DIM * NMS_GRID_MAX_DIM);
+        }
+        for (int g = 0; g < cols * rows; g++)
+        {
+            grid_cells_[g].clear();
+        }
+        grid_stamp_.assign(std::min(n, max_keep), 0);
+    }
+
+    int kept_num = 0;
+    int stamp = 0;
+    while (!heap_.empty() && kept_num < max_keep)
+    {
+        std::pop_heap(heap_.begin(), heap_.end());
+        uint64_t key = heap_.back();
+        heap_.pop_back();
+
+        int idx = key_index(key);
+        float x1 = boxes[idx * 4 + 0];
+        float y1 = boxes[idx * 4 + 1];
+        float x2 = x1 + boxes[idx * 4 + 2];
+        float y2 = y1 + boxes[idx * 4 + 3];
+        float area = (x2 - x1 + 1.f) * (y2 - y1 + 1.f);
+
+        bool suppressed = use_grid
+                              ? suppressed_grid(x1, y1, x2, y2, area, threshold, ++stamp, origin_x, origin_y, cols, rows)
+                              : suppressed_linear(x1, y1, x2, y2, area, kept_num, threshold);
+        if (suppressed)
+        {
+            continue;
+        }
+
+        kept_x1_.push_back(x1);
+        kept_y1_.push_back(y1);
+        kept_x2_.push_back(x2);
+        kept_y2_.push_back(y2);
+        kept_area_.push_back(area);
+        kept_keys_.push_back(key);
+        if (use_grid)
+        {
+            int c0 = grid_coord(x1, origin_x, cols), c1 = grid_coord(x2 + 1.f, origin_x, cols);
+            int r0 = grid_coord(y1, origin_y, rows), r1 = grid_coord(y2 + 1.f, origin_y, rows);
+            for (int r = r0; r <= r1; r++)
+            {
+                for (int c = c0; c <= c1; c++)
+                {
+                    grid_cells_[r * cols + c].push_back(kept_num);
+                }
+            }
+        }
+        kept_num++;
+    }
+    return kept_num;
+}
+
+int NmsEngine::run(const float *boxes, const float *scores, const int *class_ids, int count, int class_num,
+                   float threshold, int max_keep, std::vector<int> &keep)
+{
+    keep.clear();
+    kept_keys_.clear();
+    if (count <= 0 || class_num <= 0 || max_keep <= 0)
+    {
+        return 0;
+    }
+
+    // 计数排序按类别分桶，各类别独立做 NMS
+    bucket_start_.assign(class_num + 1, 0);
+    for (int i = 0; i < count; i++)
+    {
+        bucket_start_[class_ids[i] + 1]++;
+    }
+    for (int c = 0; c < class_num; c++)
+    {
+        bucket_start_[c + 1] += bucket_start_[c];
+    }
+    bucket_items_.resize(count);
+    for (int i = 0; i < count; i++)
+    {
+        bucket_items_[bucket_start_[class_ids[i]]++] = i;
+    }
+    for (int c = class_num; c > 0; c--)
+    {
+        bucket_start_[c] = bucket_start_[c - 1];
+    }
+    bucket_start_[0] = 0;
+
+    for (int c = 0; c < class_num; c++)
+    {
+        int n = bucket_start_[c + 1] - bucket_start_[c];
+        if (n > 0)
+        {
+            nms_class(boxes, scores, &bucket_items_[bucket_start_[c]], n, threshold, max_keep);
+        }
+    }
+
+    // 合并各类别结果，全局按分数取前 max_keep 个
+    int keep_num = std::min((int)kept_keys_.size(), max_keep);
+    std::partial_sort(kept_keys_.begin(), kept_keys_.begin() + keep_num, kept_keys_.end(), std::greater<uint64_t>());
+    for (int k = 0; k < keep_num; k++)
+    {
+        keep.push_back(key_index(kept_keys_[k]));
+    }
+    return keep_num;
+}
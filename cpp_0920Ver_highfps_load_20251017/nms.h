@@ -0,0 +1,63 @@
+#ifndef _RKNN_YOLOV8_DEMO_NMS_H_
+#define _RKNN_YOLOV8_DEMO_NMS_H_
+
+#include <stdint.h>
+#include <vector>
+
+// 单个类别的候选数超过该值时，改用空间网格查找可能重叠的已保留框
+#define NMS_GRID_MIN_CANDIDATES 256
+// 空间网格的单元边长（模型输入坐标系，像素）
+#define NMS_GRID_CELL_SIZE 64
+// 空间网格每个方向的最大单元数，超出范围的框归入边缘单元
+#define NMS_GRID_MAX_DIM 16
+
+// 分类别贪心 NMS（内部缓冲区在多次调用间复用）
+class NmsEngine {
+public:
+    NmsEngine() = default;
+    ~NmsEngine() = default;
+
+    /**
+     * @brief 预留内部缓冲区，之后不超过该规模的调用不再申请堆内存
+     * @param max_count 最大候选数量
+     * @param class_num 类别数量
+     * @param max_keep 最多保留的框数
+     */
+    void reserve(int max_count, int class_num, int max_keep);
+
+    /**
+     * @brief 分类别贪心 NMS：同类别内按分数从高到低，与已保留框 IoU 超过阈值的候选被抑制
+     * @param boxes 候选框，按 (x, y, w, h) 交错存储
+     * @param scores 候选分数
+     * @param class_ids 候选类别，取值范围 [0, class_num)
+     * @param count 候选数量
+     * @param class_num 类别数量
+     * @param threshold IoU 阈值
+     * @param max_keep 最多保留的框数（全局按分数取前 max_keep 个）
+     * @param keep 输出：保留的候选下标，按分数降序（分数相同时下标小的在前）
+     * @return 保留数量
+     */
+    int run(const float *boxes, const float *scores, const int *class_ids, int count, int class_num,
+            float threshold, int max_keep, std::vector<int> &keep);
+
+private:
+    // 按类别分桶（计数排序）
+    std::vector<int> bucket_start_;
+    std::vector<int> bucket_items_;
+    // 惰性 top-K 选择用的堆：高32位为分数位模式，低32位为取反的下标
+    std::vector<uint64_t> heap_;
+    // 当前类别已保留框（SoA，便于向量化 IoU）
+    std::vector<float> kept_x1_, kept_y1_, kept_x2_, kept_y2_, kept_area_;
+    // 所有类别的保留结果（合并前）
+    std::vector<uint64_t> kept_keys_;
+    // 空间网格：每个单元记录覆盖它的已保留框序号
+    std::vector<std::vector<int>> grid_cells_;
+    std::vector<int> grid_stamp_;
+
+    int nms_class(const float *boxes, const float *scores, const int *items, int n, float threshold, int max_keep);
+    bool suppressed_linear(float x1, float y1, float x2, float y2, float area, int kept_num, float threshold) const;
+    bool suppressed_grid(float x1, float y1, float x2, float y2, float area, float threshold, int stamp,
+                         float origin_x, float origin_y, int cols, int rows);
+};
+
+#endif //_RKNN_YOLOV8_DEMO_NMS_H_
@@ -13,6 +13,7 @@
 // limitations under the License.
 
 #include "yolov8.h"
+#include "nms.h"
 
 #include <math.h>
 #include <stdint.h>
@@ -21,8 +22,15 @@
 #include <string.h>
 #include <sys/time.h>
 
-#include <set>
 #include <vector>
+
+#if defined(__aarch64__)
+#include <arm_neon.h>
+#define SCORE_SCAN_LANES 16
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define SCORE_SCAN_LANES 16
+#endif
 #define LABEL_NALE_TXT_PATH "/oyf/rknn_model_zoo/examples/yolov8/model/coco_80_labels_list.txt"
 
 static char *labels[OBJ_CLASS_NUM];
@@ -116,131 +124,6 @@ static int loadLabelName(const char *locationFilename, char *label[])
     return 0;
 }
 
-/**
- * @brief 计算两个边界框的交并比(IoU)
- * @param xmin0 第一个框的左上角x坐标
- * @param ymin0 第一个框的左上角y坐标
- * @param xmax0 第一个框的右下角x坐标
- * @param ymax0 第一个框的右下角y坐标
- * @param xmin1 第二个框的左上角x坐标
- * @param ymin1 第二个框的左上角y坐标
- * @param xmax1 第二个框的右下角x坐标
- * @param ymax1 第二个框的右下角y坐标
- * @return 交并比
- */
-static float CalculateOverlap(float xmin0, float ymin0, float xmax0, float ymax0, float xmin1, float ymin1, float xmax1,
-                              float ymax1)
-{
-    float w = fmax(0.f, fmin(xmax0, xmax1) - fmax(xmin0, xmin1) + 1.0);
-    float h = fmax(0.f, fmin(ymax0, ymax1) - fmax(ymin0, ymin1) + 1.0);
-    float i = w * h;
-    float u = (xmax0 - xmin0 + 1.0) * (ymax0 - ymin0 + 1.0) + (xmax1 - xmin1 + 1.0) * (ymax1 - ymin1 + 1.0) - i;
-    return u <= 0.f ? 0.f : (i / u);
-}
-
-/**
- * @brief 非极大值抑制(NMS)
- * @param validCount 有效检测数量
- * @param outputLocations 检测框位置
- * @param classIds 类别ID
- * @param order 排序后的索引
- * @param filterId 过滤的类别ID
- * @param threshold NMS阈值
- * @return 0表示成功
- */
-static int nms(int validCount, std::vector<float> &outputLocations, std::vector<int> classIds, std::vector<int> &order,
-               int filterId, float threshold)
-{
-    for (int i = 0; i < validCount; ++i)
-    {
-        // int n = order[i];
-        // if (n == -1 || classIds[n] != filterId)
-        // {
-        //     continue;
-        // }
-        // for (int j = i + 1; j < validCount; ++j)
-        // {
-        //     int m = order[j];
-        //     if (m == -1 || classIds[m] != filterId)
-        //     {
-        //         continue;
-        //     }
-        int n = order[i];
-        if (n == -1 || classIds[n] != filterId)
-            continue;
-        // 提前计算当前框的坐标（避免重复计算）
-        float xmin0 = outputLocations[n * 4 + 0];
-        float ymin0 = outputLocations[n * 4 + 1];
-        float xmax0 = xmin0 + outputLocations[n * 4 + 2];
-        float ymax0 = ymin0 + outputLocations[n * 4 + 3];
-        // 计算面积（IOU计算需要）
-        float area0 = (xmax0 - xmin0) * (ymax0 - ymin0);
-        for (int j = i + 1; j < validCount; ++j) {
-            int m = order[j];
-            if (m == -1 || classIds[m] != filterId)
-                {continue;}
-            float xmin0 = outputLocations[n * 4 + 0];
-            float ymin0 = outputLocations[n * 4 + 1];
-            float xmax0 = outputLocations[n * 4 + 0] + outputLocations[n * 4 + 2];
-            float ymax0 = outputLocations[n * 4 + 1] + outputLocations[n * 4 + 3];
-
-            float xmin1 = outputLocations[m * 4 + 0];
-            float ymin1 = outputLocations[m * 4 + 1];
-            float xmax1 = outputLocations[m * 4 + 0] + outputLocations[m * 4 + 2];
-            float ymax1 = outputLocations[m * 4 + 1] + outputLocations[m * 4 + 3];
-
-            float iou = CalculateOverlap(xmin0, ymin0, xmax0, ymax0, xmin1, ymin1, xmax1, ymax1);
-
-            if (iou > threshold)
-            {
-                order[j] = -1;
-            }
-        }
-    }
-    return 0;
-}
-
-/**
- * @brief 快速排序（降序）
- * @param input 输入数组
- * @param left 左边界
- * @param right 右边界
- * @param indices 索引数组
- * @return 排序后的中间位置
- */
-static int quick_sort_indice_inverse(std::vector<float> &input, int left, int right, std::vector<int> &indices)
-{
-    float key;
-    int key_index;
-    int low = left;
-    int high = right;
-    if (left < right)
-    {
-        key_index = indices[left];
-        key = input[left];
-        while (low < high)
-        {
-            while (low < high && input[high] <= key)
-            {
-                high--;
-            }
-            input[low] = input[high];
-            indices[low] = indices[high];
-            while (low < high && input[low] >= key)
-            {
-                low++;
-            }
-            input[high] = input[low];
-            indices[high] = indices[low];
-        }
-        input[low] = key;
-        indices[low] = key_index;
-        quick_sort_indice_inverse(input, left, low - 1, indices);
-        quick_sort_indice_inverse(input, low + 1, right, indices);
-    }
-    return low;
-}
-
 /**
  * @brief Sigmoid激活函数
  * @param x 输入值
@@ -300,404 +183,992 @@ static float deqnt_affine_to_f32(int8_t qnt, int32_t zp, float scale) { return (
 
 static float deqnt_affine_u8_to_f32(uint8_t qnt, int32_t zp, float scale) { return ((float)qnt - (float)zp) * scale; }
 
-static void compute_dfl(float* tensor, int dfl_len, float* box){
-    for (int b=0; b<4; b++){
-        float exp_t[dfl_len];
-        float exp_sum=0;
-        float acc_sum=0;
-        for (int i=0; i< dfl_len; i++){
-            exp_t[i] = exp(tensor[i+b*dfl_len]);
-            exp_sum += exp_t[i];
+// fp16 输出元素，按位存储。比较通过保序的 16 位键完成（负数翻转数值位），不需要转换成 float
+struct half_t {
+    uint16_t bits;
+};
+
+static inline int16_t half_key(uint16_t bits) { return (int16_t)(bits ^ ((uint16_t)((int16_t)bits >> 15) & 0x7fff)); }
+
+// 键变换是对合的，同一个函数也用于从键还原
+static inline half_t half_from_key(int16_t key)
+{
+    half_t h;
+    h.bits = (uint16_t)half_key((uint16_t)key);
+    return h;
+}
+
+static inline bool operator>(half_t a, half_t b) { return half_key(a.bits) > half_key(b.bits); }
+
+static inline bool operator<(half_t a, half_t b) { return half_key(a.bits) < half_key(b.bits); }
+
+// aarch64 使用硬件 fp16 转换，其他平台使用软件转换（x86 上的测试）
+static inline float half_to_float(half_t h)
+{
+#if defined(__aarch64__)
+    __fp16 v;
+    memcpy(&v, &h.bits, sizeof(v));
+    return (float)v;
+#else
+    uint32_t sign = (uint32_t)(h.bits & 0x8000) << 16;
+    uint32_t exponent = (h.bits >> 10) & 0x1f;
+    uint32_t mantissa = h.bits & 0x3ff;
+    uint32_t bits;
+    if (exponent == 0x1f)
+    {
+        bits = sign | 0x7f800000 | (mantissa << 13);
+    }
+    else if (exponent != 0)
+    {
+        bits = sign | ((exponent + 112) << 23) | (mantissa << 13);
+    }
+    else if (mantissa == 0)
+    {
+        bits = sign;
+    }
+    else
+    {
+        // 非规格化数：左移到隐含位后按规格化数表示
+        exponent = 113;
+        while ((mantissa & 0x400) == 0)
+        {
+            mantissa <<= 1;
+            exponent--;
+        }
+        bits = sign | (exponent << 23) | ((mantissa & 0x3ff) << 13);
+    }
+    float f;
+    memcpy(&f, &bits, sizeof(f));
+    return f;
+#endif
+}
+
+// 有限值的键范围 [key(-inf), key(+inf)]
+#define HALF_KEY_MIN (-31745)
+#define HALF_KEY_MAX 31744
+
+/**
+ * @brief 阈值换算为 fp16：在有序的键空间中二分查找
+ * @param round_up false 返回不大于 f32 的最大值（用于 "大于阈值"），true 返回不小于 f32 的最小值（用于 "小于阈值"）
+ *        这样 fp16 比较与把元素转换成 float 后的比较结果完全一致
+ */
+static half_t half_threshold(float f32, bool round_up)
+{
+    int lo = HALF_KEY_MIN;
+    int hi = HALF_KEY_MAX;
+    if (round_up)
+    {
+        // 最小的 key 使 value(key) >= f32
+        while (lo < hi)
+        {
+            int mid = lo + (hi - lo) / 2;
+            if (half_to_float(half_from_key(mid)) >= f32)
+                hi = mid;
+            else
+                lo = mid + 1;
         }
-        
-        for (int i=0; i< dfl_len; i++){
-            acc_sum += exp_t[i]/exp_sum *i;
+    }
+    else
+    {
+        // 最大的 key 使 value(key) <= f32
+        while (lo < hi)
+        {
+            int mid = lo + (hi - lo + 1) / 2;
+            if (half_to_float(half_from_key(mid)) <= f32)
+                lo = mid;
+            else
+                hi = mid - 1;
         }
-        box[b] = acc_sum;
     }
+    return half_from_key(lo);
 }
 
-static int process_u8(uint8_t *box_tensor, int32_t box_zp, float box_scale,
-                      uint8_t *score_tensor, int32_t score_zp, float score_scale,
-                      uint8_t *score_sum_tensor, int32_t score_sum_zp, float score_sum_scale,
-                      int grid_h, int grid_w, int stride, int dfl_len,
-                      std::vector<float> &boxes,
-                      std::vector<float> &objProbs,
-                      std::vector<int> &classId,
-                      float threshold)
+// 编译期参数为 0 时表示该维度在运行期确定
+template <int N>
+static inline int fixed_or(int runtime_value) { return N > 0 ? N : runtime_value; }
+
+// 将分数阈值换算到输出张量的数值域：量化张量在量化域中比较，浮点张量直接比较
+static inline int8_t score_thres_of(float f32, int32_t zp, float scale, const int8_t *) { return qnt_f32_to_affine(f32, zp, scale); }
+
+static inline uint8_t score_thres_of(float f32, int32_t zp, float scale, const uint8_t *) { return qnt_f32_to_affine_u8(f32, zp, scale); }
+
+static inline float score_thres_of(float f32, int32_t, float, const float *) { return f32; }
+
+static inline half_t score_thres_of(float f32, int32_t, float, const half_t *) { return half_threshold(f32, false); }
+
+// score_sum 用于 "小于阈值则跳过"：fp16 需要向上取整才与 float 比较等价，其余类型与 score 相同
+template <typename T>
+static inline T score_sum_thres_of(float f32, int32_t zp, float scale, const T *tag) { return score_thres_of(f32, zp, scale, tag); }
+
+static inline half_t score_sum_thres_of(float f32, int32_t, float, const half_t *) { return half_threshold(f32, true); }
+
+static inline float score_to_f32(int8_t v, int32_t zp, float scale) { return deqnt_affine_to_f32(v, zp, scale); }
+
+static inline float score_to_f32(uint8_t v, int32_t zp, float scale) { return deqnt_affine_u8_to_f32(v, zp, scale); }
+
+static inline float score_to_f32(float v, int32_t, float) { return v; }
+
+static inline float score_to_f32(half_t v, int32_t, float) { return half_to_float(v); }
+
+// DFL 元素取指数：量化张量以原始字节查表，浮点张量直接计算
+static inline float dfl_exp(int8_t v, const float *exp_lut) { return exp_lut[(uint8_t)v]; }
+
+static inline float dfl_exp(uint8_t v, const float *exp_lut) { return exp_lut[v]; }
+
+static inline float dfl_exp(float v, const float *) { return expf(v); }
+
+static inline float dfl_exp(half_t v, const float *exp_lut) { return dfl_exp(half_to_float(v), exp_lut); }
+
+/**
+ * @brief DFL 分布的期望：Σ e_i·i / Σ e_i
+ *        与逐项 exp_t[i]/exp_sum*i 累加相比只改变了求和顺序，框坐标误差不超过 DFL_LUT_MAX_ERROR_PX
+ * @param exp_t 已取指数的分布
+ * @param dfl_len 分布长度
+ * @return 期望值（单位：stride）
+ */
+static inline float dfl_expectation(const float *exp_t, int dfl_len)
 {
-    int validCount = 0;
-    int grid_len = grid_h * grid_w;
-    uint8_t score_thres_u8 = qnt_f32_to_affine_u8(threshold, score_zp, score_scale);
-    uint8_t score_sum_thres_u8 = qnt_f32_to_affine_u8(threshold, score_sum_zp, score_sum_scale);
+    int i = 0;
+    float exp_sum = 0;
+    float acc_sum = 0;
+#if defined(__aarch64__)
+    float32x4_t vsum = vdupq_n_f32(0);
+    float32x4_t vacc = vdupq_n_f32(0);
+    float32x4_t vidx = {0, 1, 2, 3};
+    for (; i + 4 <= dfl_len; i += 4)
+    {
+        float32x4_t e = vld1q_f32(exp_t + i);
+        vsum = vaddq_f32(vsum, e);
+        vacc = vfmaq_f32(vacc, e, vidx);
+        vidx = vaddq_f32(vidx, vdupq_n_f32(4));
+    }
+    exp_sum = vaddvq_f32(vsum);
+    acc_sum = vaddvq_f32(vacc);
+#elif defined(__SSE2__)
+    __m128 vsum = _mm_setzero_ps();
+    __m128 vacc = _mm_setzero_ps();
+    __m128 vidx = _mm_set_ps(3, 2, 1, 0);
+    for (; i + 4 <= dfl_len; i += 4)
+    {
+        __m128 e = _mm_loadu_ps(exp_t + i);
+        vsum = _mm_add_ps(vsum, e);
+        vacc = _mm_add_ps(vacc, _mm_mul_ps(e, vidx));
+        vidx = _mm_add_ps(vidx, _mm_set1_ps(4));
+    }
+    float lanes[4];
+    _mm_storeu_ps(lanes, vsum);
+    exp_sum = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+    _mm_storeu_ps(lanes, vacc);
+    acc_sum = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+#endif
+    for (; i < dfl_len; i++)
+    {
+        exp_sum += exp_t[i];
+        acc_sum += exp_t[i] * i;
+    }
+    return acc_sum / exp_sum;
+}
 
-    for (int i = 0; i < grid_h; i++)
+/**
+ * @brief box 张量的 DFL 解码（量化张量的 exp 通过查找表获得，无需逐元素反量化）
+ * @param tensor 第一个 DFL 元素的地址
+ * @param step 相邻 DFL 元素的间隔（NCHW 为 grid_len）
+ * @param dfl_len 分布长度，DFL_LEN 为 0 时使用
+ * @param exp_lut 该输出张量的 256 项查找表，以原始字节为下标；浮点张量不使用
+ * @param box 输出：四条边到网格中心的距离
+ */
+template <int DFL_LEN, typename T>
+static inline void compute_dfl(const T *tensor, int step, int dfl_len, const float *exp_lut, float *box)
+{
+    const int len = fixed_or<DFL_LEN>(dfl_len);
+    float exp_t[DFL_LEN > 0 ? DFL_LEN : DFL_LEN_MAX];
+    for (int b = 0; b < 4; b++)
     {
-        for (int j = 0; j < grid_w; j++)
+        for (int i = 0; i < len; i++)
         {
-            int offset = i * grid_w + j;
-            int max_class_id = -1;
+            exp_t[i] = dfl_exp(tensor[(b * len + i) * step], exp_lut);
+        }
+        box[b] = dfl_expectation(exp_t, len);
+    }
+}
 
-            // Use score sum to quickly filter
-            if (score_sum_tensor != nullptr)
-            {
-                if (score_sum_tensor[offset] < score_sum_thres_u8)
-                {
-                    continue;
-                }
-            }
+static inline int tensor_offset(const tensor_layout &layout, int c, int n)
+{
+    return (c / layout.c2) * layout.plane_stride + n * layout.cell_stride + c % layout.c2;
+}
 
-            uint8_t max_score = -score_zp;
-            for (int c = 0; c < OBJ_CLASS_NUM; c++)
-            {
-                if ((score_tensor[offset] > score_thres_u8) && (score_tensor[offset] > max_score))
-                {
-                    max_score = score_tensor[offset];
-                    max_class_id = c;
-                }
-                offset += grid_len;
-            }
+/**
+ * @brief 原生布局（NC1HWC2 / NHWC）box 张量的 DFL 解码，直接按 tensor_layout 寻址
+ * @param tensor box 张量首地址
+ * @param layout box 张量的布局
+ * @param n 网格下标
+ * @param dfl_len 分布长度，DFL_LEN 为 0 时使用
+ * @param exp_lut 该输出张量的 256 项查找表
+ * @param box 输出：四条边到网格中心的距离
+ */
+template <int DFL_LEN, typename T>
+static inline void compute_dfl_native(const T *tensor, const tensor_layout &layout, int n, int dfl_len,
+                                      const float *exp_lut, float *box)
+{
+    const int len = fixed_or<DFL_LEN>(dfl_len);
+    float exp_t[DFL_LEN > 0 ? DFL_LEN : DFL_LEN_MAX];
+    for (int b = 0; b < 4; b++)
+    {
+        for (int i = 0; i < len; i++)
+        {
+            exp_t[i] = dfl_exp(tensor[tensor_offset(layout, b * len + i, n)], exp_lut);
+        }
+        box[b] = dfl_expectation(exp_t, len);
+    }
+}
+
+#if defined(SCORE_SCAN_LANES)
+#if defined(__aarch64__)
+/**
+ * @brief 将16路比较结果压缩为16位掩码（每个网格1位）
+ */
+static inline uint32_t lane_mask(uint8x16_t m)
+{
+    static const uint8_t bits[16] = {1, 2, 4, 8, 16, 32, 64, 128, 1, 2, 4, 8, 16, 32, 64, 128};
+    uint8x16_t t = vandq_u8(m, vld1q_u8(bits));
+    return vaddv_u8(vget_low_u8(t)) | ((uint32_t)vaddv_u8(vget_high_u8(t)) << 8);
+}
+
+template <int CLASS_NUM, bool HAS_SCORE_SUM>
+static inline uint32_t scan_score_block(const int8_t *score, const int8_t *score_sum, int grid_len, int class_num,
+                                        int8_t score_thres, int8_t score_sum_thres)
+{
+    uint8x16_t keep = vdupq_n_u8(0xff);
+    if (HAS_SCORE_SUM)
+    {
+        keep = vcgeq_s8(vld1q_s8(score_sum), vdupq_n_s8(score_sum_thres));
+        if (vmaxvq_u8(keep) == 0)
+        {
+            return 0;
+        }
+    }
+    int8x16_t vmax = vld1q_s8(score);
+    for (int c = 1; c < fixed_or<CLASS_NUM>(class_num); c++)
+    {
+        vmax = vmaxq_s8(vmax, vld1q_s8(score + c * grid_len));
+    }
+    keep = vandq_u8(keep, vcgtq_s8(vmax, vdupq_n_s8(score_thres)));
+    return lane_mask(keep);
+}
 
-            // compute box
-            if (max_score > score_thres_u8)
+template <int CLASS_NUM, bool HAS_SCORE_SUM>
+static inline uint32_t scan_score_block(const uint8_t *score, const uint8_t *score_sum, int grid_len, int class_num,
+                                        uint8_t score_thres, uint8_t score_sum_thres)
+{
+    uint8x16_t keep = vdupq_n_u8(0xff);
+    if (HAS_SCORE_SUM)
+    {
+        keep = vcgeq_u8(vld1q_u8(score_sum), vdupq_n_u8(score_sum_thres));
+        if (vmaxvq_u8(keep) == 0)
+        {
+            return 0;
+        }
+    }
+    uint8x16_t vmax = vld1q_u8(score);
+    for (int c = 1; c < fixed_or<CLASS_NUM>(class_num); c++)
+    {
+        vmax = vmaxq_u8(vmax, vld1q_u8(score + c * grid_len));
+    }
+    keep = vandq_u8(keep, vcgtq_u8(vmax, vdupq_n_u8(score_thres)));
+    return lane_mask(keep);
+}
+// 浮点输出：每 4 个网格一组向量比较，拼成 16 位掩码
+template <int CLASS_NUM, bool HAS_SCORE_SUM>
+static inline uint32_t scan_score_block(const float *score, const float *score_sum, int grid_len, int class_num,
+                                        float score_thres, float score_sum_thres)
+{
+    static const uint32_t bits[4] = {1, 2, 4, 8};
+    uint32_t mask = 0;
+    for (int q = 0; q < SCORE_SCAN_LANES; q += 4)
+    {
+        uint32x4_t keep = vdupq_n_u32(0xffffffff);
+        if (HAS_SCORE_SUM)
+        {
+            keep = vcgeq_f32(vld1q_f32(score_sum + q), vdupq_n_f32(score_sum_thres));
+            if (vmaxvq_u32(keep) == 0)
             {
-                offset = i * grid_w + j;
-                float box[4];
-                float before_dfl[dfl_len * 4];
-                for (int k = 0; k < dfl_len * 4; k++)
-                {
-                    before_dfl[k] = deqnt_affine_u8_to_f32(box_tensor[offset], box_zp, box_scale);
-                    offset += grid_len;
-                }
-                compute_dfl(before_dfl, dfl_len, box);
-
-                float x1, y1, x2, y2, w, h;
-                x1 = (-box[0] + j + 0.5) * stride;
-                y1 = (-box[1] + i + 0.5) * stride;
-                x2 = (box[2] + j + 0.5) * stride;
-                y2 = (box[3] + i + 0.5) * stride;
-                w = x2 - x1;
-                h = y2 - y1;
-                boxes.push_back(x1);
-                boxes.push_back(y1);
-                boxes.push_back(w);
-                boxes.push_back(h);
-
-                objProbs.push_back(deqnt_affine_u8_to_f32(max_score, score_zp, score_scale));
-                classId.push_back(max_class_id);
-                validCount++;
+                continue;
             }
         }
+        float32x4_t vmax = vld1q_f32(score + q);
+        for (int c = 1; c < fixed_or<CLASS_NUM>(class_num); c++)
+        {
+            vmax = vmaxq_f32(vmax, vld1q_f32(score + c * grid_len + q));
+        }
+        keep = vandq_u32(keep, vcgtq_f32(vmax, vdupq_n_f32(score_thres)));
+        mask |= vaddvq_u32(vandq_u32(keep, vld1q_u32(bits))) << q;
     }
-    return validCount;
+    return mask;
+}
+// fp16 输出：16 个网格拆成两组 8 路 16 位键比较
+static inline int16x8_t half_keys(uint16x8_t v)
+{
+    uint16x8_t neg = vreinterpretq_u16_s16(vshrq_n_s16(vreinterpretq_s16_u16(v), 15));
+    return vreinterpretq_s16_u16(veorq_u16(v, vandq_u16(neg, vdupq_n_u16(0x7fff))));
 }
 
-static int process_i8(int8_t *box_tensor, int32_t box_zp, float box_scale,
-                      int8_t *score_tensor, int32_t score_zp, float score_scale,
-                      int8_t *score_sum_tensor, int32_t score_sum_zp, float score_sum_scale,
-                      int grid_h, int grid_w, int stride, int dfl_len,
-                      std::vector<float> &boxes, 
-                      std::vector<float> &objProbs, 
-                      std::vector<int> &classId, 
-                      float threshold)
+template <int CLASS_NUM, bool HAS_SCORE_SUM>
+static inline uint32_t scan_score_block(const half_t *score, const half_t *score_sum, int grid_len, int class_num,
+                                        half_t score_thres, half_t score_sum_thres)
 {
-    int validCount = 0;
-    int grid_len = grid_h * grid_w;
-    int8_t score_thres_i8 = qnt_f32_to_affine(threshold, score_zp, score_scale);
-    int8_t score_sum_thres_i8 = qnt_f32_to_affine(threshold, score_sum_zp, score_sum_scale);
+    const uint16_t *s = (const uint16_t *)score;
+    uint16x8_t keep_lo = vdupq_n_u16(0xffff);
+    uint16x8_t keep_hi = vdupq_n_u16(0xffff);
+    if (HAS_SCORE_SUM)
+    {
+        const uint16_t *ss = (const uint16_t *)score_sum;
+        int16x8_t thres = vdupq_n_s16(half_key(score_sum_thres.bits));
+        keep_lo = vcgeq_s16(half_keys(vld1q_u16(ss)), thres);
+        keep_hi = vcgeq_s16(half_keys(vld1q_u16(ss + 8)), thres);
+        if (vmaxvq_u16(vorrq_u16(keep_lo, keep_hi)) == 0)
+        {
+            return 0;
+        }
+    }
+    int16x8_t max_lo = half_keys(vld1q_u16(s));
+    int16x8_t max_hi = half_keys(vld1q_u16(s + 8));
+    for (int c = 1; c < fixed_or<CLASS_NUM>(class_num); c++)
+    {
+        max_lo = vmaxq_s16(max_lo, half_keys(vld1q_u16(s + c * grid_len)));
+        max_hi = vmaxq_s16(max_hi, half_keys(vld1q_u16(s + c * grid_len + 8)));
+    }
+    int16x8_t thres = vdupq_n_s16(half_key(score_thres.bits));
+    keep_lo = vandq_u16(keep_lo, vcgtq_s16(max_lo, thres));
+    keep_hi = vandq_u16(keep_hi, vcgtq_s16(max_hi, thres));
+    return lane_mask(vcombine_u8(vmovn_u16(keep_lo), vmovn_u16(keep_hi)));
+}
+#else
+// SSE2 没有有符号 int8 的 max，异或 0x80 后借用无符号 max
+template <int CLASS_NUM, bool HAS_SCORE_SUM>
+static inline uint32_t scan_score_block(const int8_t *score, const int8_t *score_sum, int grid_len, int class_num,
+                                        int8_t score_thres, int8_t score_sum_thres)
+{
+    uint32_t keep = 0xffff;
+    if (HAS_SCORE_SUM)
+    {
+        __m128i below = _mm_cmpgt_epi8(_mm_set1_epi8(score_sum_thres), _mm_loadu_si128((const __m128i *)score_sum));
+        keep = ~(uint32_t)_mm_movemask_epi8(below) & 0xffff;
+        if (keep == 0)
+        {
+            return 0;
+        }
+    }
+    const __m128i sign = _mm_set1_epi8((char)0x80);
+    __m128i vmax = _mm_xor_si128(_mm_loadu_si128((const __m128i *)score), sign);
+    for (int c = 1; c < fixed_or<CLASS_NUM>(class_num); c++)
+    {
+        vmax = _mm_max_epu8(vmax, _mm_xor_si128(_mm_loadu_si128((const __m128i *)(score + c * grid_len)), sign));
+    }
+    vmax = _mm_xor_si128(vmax, sign);
+    return keep & (uint32_t)_mm_movemask_epi8(_mm_cmpgt_epi8(vmax, _mm_set1_epi8(score_thres)));
+}
 
-    for (int i = 0; i < grid_h; i++)
+template <int CLASS_NUM, bool HAS_SCORE_SUM>
+static inline uint32_t scan_score_block(const uint8_t *score, const uint8_t *score_sum, int grid_len, int class_num,
+                                        uint8_t score_thres, uint8_t score_sum_thres)
+{
+    uint32_t keep = 0xffff;
+    if (HAS_SCORE_SUM)
     {
-        for (int j = 0; j < grid_w; j++)
+        __m128i sum = _mm_loadu_si128((const __m128i *)score_sum);
+        __m128i ge = _mm_cmpeq_epi8(_mm_max_epu8(sum, _mm_set1_epi8((char)score_sum_thres)), sum);
+        keep = (uint32_t)_mm_movemask_epi8(ge);
+        if (keep == 0)
         {
-            int offset = i* grid_w + j;
-            int max_class_id = -1;
+            return 0;
+        }
+    }
+    const __m128i sign = _mm_set1_epi8((char)0x80);
+    __m128i vmax = _mm_loadu_si128((const __m128i *)score);
+    for (int c = 1; c < fixed_or<CLASS_NUM>(class_num); c++)
+    {
+        vmax = _mm_max_epu8(vmax, _mm_loadu_si128((const __m128i *)(score + c * grid_len)));
+    }
+    __m128i gt = _mm_cmpgt_epi8(_mm_xor_si128(vmax, sign), _mm_set1_epi8((char)(score_thres ^ 0x80)));
+    return keep & (uint32_t)_mm_movemask_epi8(gt);
+}
 
-            // 通过 score sum 起到快速过滤的作用
-            if (score_sum_tensor != nullptr){
-                if (score_sum_tensor[offset] < score_sum_thres_i8){
-                    continue;
-                }
+// 浮点输出：每 4 个网格一组向量比较，拼成 16 位掩码
+template <int CLASS_NUM, bool HAS_SCORE_SUM>
+static inline uint32_t scan_score_block(const float *score, const float *score_sum, int grid_len, int class_num,
+                                        float score_thres, float score_sum_thres)
+{
+    uint32_t mask = 0;
+    for (int q = 0; q < SCORE_SCAN_LANES; q += 4)
+    {
+        uint32_t keep = 0xf;
+        if (HAS_SCORE_SUM)
+        {
+            keep = (uint32_t)_mm_movemask_ps(_mm_cmpge_ps(_mm_loadu_ps(score_sum + q), _mm_set1_ps(score_sum_thres)));
+            if (keep == 0)
+            {
+                continue;
             }
+        }
+        __m128 vmax = _mm_loadu_ps(score + q);
+        for (int c = 1; c < fixed_or<CLASS_NUM>(class_num); c++)
+        {
+            vmax = _mm_max_ps(vmax, _mm_loadu_ps(score + c * grid_len + q));
+        }
+        keep &= (uint32_t)_mm_movemask_ps(_mm_cmpgt_ps(vmax, _mm_set1_ps(score_thres)));
+        mask |= keep << q;
+    }
+    return mask;
+}
+// fp16 输出：16 个网格拆成两组 8 路 16 位键比较，SSE2 有有符号 16 位 max
+static inline __m128i half_keys(__m128i v)
+{
+    return _mm_xor_si128(v, _mm_and_si128(_mm_srai_epi16(v, 15), _mm_set1_epi16(0x7fff)));
+}
 
-            int8_t max_score = -score_zp;
-            for (int c= 0; c< OBJ_CLASS_NUM; c++){
-                if ((score_tensor[offset] > score_thres_i8) && (score_tensor[offset] > max_score))
-                {
-                    max_score = score_tensor[offset];
-                    max_class_id = c;
-                }
-                offset += grid_len;
-            }
+template <int CLASS_NUM, bool HAS_SCORE_SUM>
+static inline uint32_t scan_score_block(const half_t *score, const half_t *score_sum, int grid_len, int class_num,
+                                        half_t score_thres, half_t score_sum_thres)
+{
+    const uint16_t *s = (const uint16_t *)score;
+    uint32_t keep = 0xffff;
+    if (HAS_SCORE_SUM)
+    {
+        const uint16_t *ss = (const uint16_t *)score_sum;
+        __m128i thres = _mm_set1_epi16(half_key(score_sum_thres.bits));
+        __m128i below_lo = _mm_cmplt_epi16(half_keys(_mm_loadu_si128((const __m128i *)ss)), thres);
+        __m128i below_hi = _mm_cmplt_epi16(half_keys(_mm_loadu_si128((const __m128i *)(ss + 8))), thres);
+        keep = ~(uint32_t)_mm_movemask_epi8(_mm_packs_epi16(below_lo, below_hi)) & 0xffff;
+        if (keep == 0)
+        {
+            return 0;
+        }
+    }
+    __m128i max_lo = half_keys(_mm_loadu_si128((const __m128i *)s));
+    __m128i max_hi = half_keys(_mm_loadu_si128((const __m128i *)(s + 8)));
+    for (int c = 1; c < fixed_or<CLASS_NUM>(class_num); c++)
+    {
+        max_lo = _mm_max_epi16(max_lo, half_keys(_mm_loadu_si128((const __m128i *)(s + c * grid_len))));
+        max_hi = _mm_max_epi16(max_hi, half_keys(_mm_loadu_si128((const __m128i *)(s + c * grid_len + 8))));
+    }
+    __m128i thres = _mm_set1_epi16(half_key(score_thres.bits));
+    __m128i gt = _mm_packs_epi16(_mm_cmpgt_epi16(max_lo, thres), _mm_cmpgt_epi16(max_hi, thres));
+    return keep & (uint32_t)_mm_movemask_epi8(gt);
+}
+#endif
+#endif
 
-            // compute box
-            if (max_score> score_thres_i8){
-                offset = i* grid_w + j;
-                float box[4];
-                float before_dfl[dfl_len*4];
-                for (int k=0; k< dfl_len*4; k++){
-                    before_dfl[k] = deqnt_affine_to_f32(box_tensor[offset], box_zp, box_scale);
-                    offset += grid_len;
-                }
-                compute_dfl(before_dfl, dfl_len, box);
-
-                float x1,y1,x2,y2,w,h;
-                x1 = (-box[0] + j + 0.5)*stride;
-                y1 = (-box[1] + i + 0.5)*stride;
-                x2 = (box[2] + j + 0.5)*stride;
-                y2 = (box[3] + i + 0.5)*stride;
-                w = x2 - x1;
-                h = y2 - y1;
-                boxes.push_back(x1);
-                boxes.push_back(y1);
-                boxes.push_back(w);
-                boxes.push_back(h);
-
-                objProbs.push_back(deqnt_affine_to_f32(max_score, score_zp, score_scale));
-                classId.push_back(max_class_id);
-                validCount ++;
-            }
+#if defined(SCORE_SCAN_LANES)
+/**
+ * @brief 16 个网格一组做向量预筛：先用 score_sum 整组过滤，再对各类别平面做向量 max
+ * @return 已处理的网格数量，剩余不足一组的网格由标量路径处理
+ */
+template <int CLASS_NUM, bool HAS_SCORE_SUM, typename T>
+static inline int scan_candidate_blocks(const T *score_tensor, const T *score_sum_tensor, int grid_len, int class_num,
+                                        T score_thres, T score_sum_thres, std::vector<int> &candidates)
+{
+    int offset = 0;
+    for (; offset + SCORE_SCAN_LANES <= grid_len; offset += SCORE_SCAN_LANES)
+    {
+        uint32_t mask = scan_score_block<CLASS_NUM, HAS_SCORE_SUM>(score_tensor + offset,
+                                                                  HAS_SCORE_SUM ? score_sum_tensor + offset : nullptr,
+                                                                  grid_len, class_num, score_thres, score_sum_thres);
+        while (mask != 0)
+        {
+            candidates.push_back(offset + __builtin_ctz(mask));
+            mask &= mask - 1;
         }
     }
-    return validCount;
+    return offset;
 }
+#endif
 
-static int process_fp32(float *box_tensor, float *score_tensor, float *score_sum_tensor, 
-                        int grid_h, int grid_w, int stride, int dfl_len,
-                        std::vector<float> &boxes, 
-                        std::vector<float> &objProbs, 
-                        std::vector<int> &classId, 
-                        float threshold)
+/**
+ * @brief 逐网格的标量筛选，处理 [begin, grid_len) 的网格，向量预筛之后的剩余网格由它处理
+ */
+template <int CLASS_NUM, bool HAS_SCORE_SUM, typename T>
+static void collect_candidates_scalar(const T *score_tensor, const T *score_sum_tensor, int begin, int grid_len,
+                                      int class_num, T score_thres, T score_sum_thres, std::vector<int> &candidates)
 {
-    int validCount = 0;
-    int grid_len = grid_h * grid_w;
-    for (int i = 0; i < grid_h; i++)
+    for (int offset = begin; offset < grid_len; offset++)
     {
-        for (int j = 0; j < grid_w; j++)
+        if (HAS_SCORE_SUM && score_sum_tensor[offset] < score_sum_thres)
+        {
+            continue;
+        }
+        T max_score = score_tensor[offset];
+        for (int c = 1; c < fixed_or<CLASS_NUM>(class_num); c++)
+        {
+            T s = score_tensor[offset + c * grid_len];
+            max_score = s > max_score ? s : max_score;
+        }
+        if (max_score > score_thres)
         {
-            int offset = i* grid_w + j;
-            int max_class_id = -1;
+            candidates.push_back(offset);
+        }
+    }
+}
 
-            // 通过 score sum 起到快速过滤的作用
-            if (score_sum_tensor != nullptr){
-                if (score_sum_tensor[offset] < threshold){
-                    continue;
-                }
-            }
+/**
+ * @brief 在输出张量的数值域中筛选候选网格
+ * @param score_tensor 类别分数（NCHW，每个类别一个 grid_len 平面）
+ * @param score_sum_tensor 类别分数和，HAS_SCORE_SUM 为 false 时不读取
+ * @param grid_len 网格数量
+ * @param class_num 类别数量，CLASS_NUM 为 0 时使用
+ * @param score_thres 换算后的分数阈值
+ * @param score_sum_thres 换算后的分数和阈值
+ * @param candidates 输出：最大类别分数超过阈值的网格索引（升序）
+ * @return 候选数量
+ */
+template <int CLASS_NUM, bool HAS_SCORE_SUM, typename T>
+static int collect_candidates(const T *score_tensor, const T *score_sum_tensor, int grid_len, int class_num,
+                              T score_thres, T score_sum_thres, std::vector<int> &candidates)
+{
+    candidates.clear();
+    int offset = 0;
+#if defined(SCORE_SCAN_LANES)
+    offset = scan_candidate_blocks<CLASS_NUM, HAS_SCORE_SUM>(score_tensor, score_sum_tensor, grid_len, class_num,
+                                                             score_thres, score_sum_thres, candidates);
+#endif
+    collect_candidates_scalar<CLASS_NUM, HAS_SCORE_SUM>(score_tensor, score_sum_tensor, offset, grid_len, class_num,
+                                                        score_thres, score_sum_thres, candidates);
+    return candidates.size();
+}
 
-            float max_score = 0;
-            for (int c= 0; c< OBJ_CLASS_NUM; c++){
-                if ((score_tensor[offset] > threshold) && (score_tensor[offset] > max_score))
-                {
-                    max_score = score_tensor[offset];
-                    max_class_id = c;
-                }
-                offset += grid_len;
-            }
+/**
+ * @brief 取候选网格的最大类别（并列时取较小的类别ID）
+ */
+template <int CLASS_NUM, typename T>
+static int argmax_class(const T *score_tensor, int offset, int grid_len, int class_num, T *max_score)
+{
+    int max_class_id = 0;
+    T best = score_tensor[offset];
+    for (int c = 1; c < fixed_or<CLASS_NUM>(class_num); c++)
+    {
+        T s = score_tensor[offset + c * grid_len];
+        if (s > best)
+        {
+            best = s;
+            max_class_id = c;
+        }
+    }
+    *max_score = best;
+    return max_class_id;
+}
 
-            // compute box
-            if (max_score> threshold){
-                offset = i* grid_w + j;
-                float box[4];
-                float before_dfl[dfl_len*4];
-                for (int k=0; k< dfl_len*4; k++){
-                    before_dfl[k] = box_tensor[offset];
-                    offset += grid_len;
-                }
-                compute_dfl(before_dfl, dfl_len, box);
-
-                float x1,y1,x2,y2,w,h;
-                x1 = (-box[0] + j + 0.5)*stride;
-                y1 = (-box[1] + i + 0.5)*stride;
-                x2 = (box[2] + j + 0.5)*stride;
-                y2 = (box[3] + i + 0.5)*stride;
-                w = x2 - x1;
-                h = y2 - y1;
-                boxes.push_back(x1);
-                boxes.push_back(y1);
-                boxes.push_back(w);
-                boxes.push_back(h);
-
-                objProbs.push_back(max_score);
-                classId.push_back(max_class_id);
-                validCount ++;
+/**
+ * @brief 原生布局下取网格的最大类别（并列时取较小的类别ID），按通道组遍历避免逐元素除法
+ */
+template <int CLASS_NUM, typename T>
+static int argmax_class_native(const T *score_tensor, const tensor_layout &layout, int n, int class_num, T *max_score)
+{
+    const int num = fixed_or<CLASS_NUM>(class_num);
+    int max_class_id = 0;
+    T best = score_tensor[n * layout.cell_stride];
+    for (int base = 0; base < num; base += layout.c2)
+    {
+        const T *group = score_tensor + (base / layout.c2) * layout.plane_stride + n * layout.cell_stride;
+        int group_len = num - base < layout.c2 ? num - base : layout.c2;
+        for (int k = 0; k < group_len; k++)
+        {
+            if (group[k] > best)
+            {
+                best = group[k];
+                max_class_id = base + k;
             }
         }
     }
-    return validCount;
+    *max_score = best;
+    return max_class_id;
 }
 
+/**
+ * @brief 原生布局下网格的最大类别分数
+ */
+template <int CLASS_NUM, typename T>
+static inline T native_max_score(const T *score_tensor, const tensor_layout &layout, int n, int class_num)
+{
+    T max_score;
+    argmax_class_native<CLASS_NUM>(score_tensor, layout, n, class_num, &max_score);
+    return max_score;
+}
 
-#if defined(RV1106_1103)
-static int process_i8_rv1106(int8_t *box_tensor, int32_t box_zp, float box_scale,
-                             int8_t *score_tensor, int32_t score_zp, float score_scale,
-                             int8_t *score_sum_tensor, int32_t score_sum_zp, float score_sum_scale,
-                             int grid_h, int grid_w, int stride, int dfl_len,
-                             std::vector<float> &boxes,
-                             std::vector<float> &objProbs,
-                             std::vector<int> &classId,
-                             float threshold) {
-    int validCount = 0;
-    int grid_len = grid_h * grid_w;
-    int8_t score_thres_i8 = qnt_f32_to_affine(threshold, score_zp, score_scale);
-    int8_t score_sum_thres_i8 = qnt_f32_to_affine(threshold, score_sum_zp, score_sum_scale);
-
-    for (int i = 0; i < grid_h; i++) {
-        for (int j = 0; j < grid_w; j++) {
-            int offset = i * grid_w + j;
-            int max_class_id = -1;
-
-            // 通过 score sum 起到快速过滤的作用
-            if (score_sum_tensor != nullptr) {
-                //score_sum_tensor [1, 1, 80, 80]
-                if (score_sum_tensor[offset] < score_sum_thres_i8) {
-                    continue;
-                }
-            }
+#if defined(SCORE_SCAN_LANES)
+// c2 为 16 时一个通道组正好是一个向量：各组逐元素 max 后做一次水平 max，最后一组不足 16 个的通道用最小值屏蔽
+template <int CLASS_NUM>
+static inline int8_t native_max_score(const int8_t *score_tensor, const tensor_layout &layout, int n, int class_num)
+{
+    const int num = fixed_or<CLASS_NUM>(class_num);
+    if (layout.c2 != SCORE_SCAN_LANES || num == 1)
+    {
+        int8_t max_score;
+        argmax_class_native<CLASS_NUM>(score_tensor, layout, n, class_num, &max_score);
+        return max_score;
+    }
+    static const int8_t lane_index[SCORE_SCAN_LANES] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15};
+    const int8_t *cell = score_tensor + n * layout.cell_stride;
+    int base = 0;
+    int group = 0;
+#if defined(__aarch64__)
+    int8x16_t vmax = vdupq_n_s8(INT8_MIN);
+    for (; base + SCORE_SCAN_LANES <= num; base += SCORE_SCAN_LANES, group++)
+    {
+        vmax = vmaxq_s8(vmax, vld1q_s8(cell + group * layout.plane_stride));
+    }
+    if (base < num)
+    {
+        uint8x16_t valid = vcltq_s8(vld1q_s8(lane_index), vdupq_n_s8(num - base));
+        vmax = vmaxq_s8(vmax, vbslq_s8(valid, vld1q_s8(cell + group * layout.plane_stride), vdupq_n_s8(INT8_MIN)));
+    }
+    return vmaxvq_s8(vmax);
+#else
+    // 异或 0x80 后按无符号比较，0 对应 INT8_MIN
+    const __m128i sign = _mm_set1_epi8((char)0x80);
+    __m128i vmax = _mm_setzero_si128();
+    for (; base + SCORE_SCAN_LANES <= num; base += SCORE_SCAN_LANES, group++)
+    {
+        vmax = _mm_max_epu8(vmax, _mm_xor_si128(_mm_loadu_si128((const __m128i *)(cell + group * layout.plane_stride)), sign));
+    }
+    if (base < num)
+    {
+        __m128i valid = _mm_cmpgt_epi8(_mm_set1_epi8((char)(num - base)), _mm_loadu_si128((const __m128i *)lane_index));
+        __m128i v = _mm_xor_si128(_mm_loadu_si128((const __m128i *)(cell + group * layout.plane_stride)), sign);
+        vmax = _mm_max_epu8(vmax, _mm_and_si128(valid, v));
+    }
+    vmax = _mm_max_epu8(vmax, _mm_srli_si128(vmax, 8));
+    vmax = _mm_max_epu8(vmax, _mm_srli_si128(vmax, 4));
+    vmax = _mm_max_epu8(vmax, _mm_srli_si128(vmax, 2));
+    vmax = _mm_max_epu8(vmax, _mm_srli_si128(vmax, 1));
+    return (int8_t)((_mm_cvtsi128_si32(vmax) & 0xff) ^ 0x80);
+#endif
+}
+#endif
 
-            int8_t max_score = -score_zp;
-            offset = offset * OBJ_CLASS_NUM;
-            for (int c = 0; c < OBJ_CLASS_NUM; c++) {
-                if ((score_tensor[offset + c] > score_thres_i8) && (score_tensor[offset + c] > max_score)) {
-                    max_score = score_tensor[offset + c]; //80类 [1, 80, 80, 80] 3588NCHW 1106NHWC
-                    max_class_id = c;
-                }
-            }
+/**
+ * @brief 原生布局下筛选候选网格：同一网格的类别分数按 c2 个一组连续存放，逐网格取最大值
+ * @param score_layout 类别分数的布局
+ * @param score_sum_layout 类别分数和的布局，HAS_SCORE_SUM 为 false 时不使用
+ * @return 候选数量
+ */
+template <int CLASS_NUM, bool HAS_SCORE_SUM, typename T>
+static int collect_candidates_native(const T *score_tensor, const tensor_layout &score_layout,
+                                     const T *score_sum_tensor, const tensor_layout &score_sum_layout,
+                                     int grid_len, int class_num, T score_thres, T score_sum_thres,
+                                     std::vector<int> &candidates)
+{
+    candidates.clear();
+    for (int n = 0; n < grid_len; n++)
+    {
+        if (HAS_SCORE_SUM && score_sum_tensor[n * score_sum_layout.cell_stride] < score_sum_thres)
+        {
+            continue;
+        }
+        if (native_max_score<CLASS_NUM>(score_tensor, score_layout, n, class_num) > score_thres)
+        {
+            candidates.push_back(n);
+        }
+    }
+    return candidates.size();
+}
 
-            // compute box
-            if (max_score > score_thres_i8) {
-                offset = (i * grid_w + j) * 4 * dfl_len;
-                float box[4];
-                float before_dfl[dfl_len*4];
-                for (int k=0; k< dfl_len*4; k++){
-                    before_dfl[k] = deqnt_affine_to_f32(box_tensor[offset + k], box_zp, box_scale);
-                }
-                compute_dfl(before_dfl, dfl_len, box);
-
-                float x1, y1, x2, y2, w, h;
-                x1 = (-box[0] + j + 0.5) * stride;
-                y1 = (-box[1] + i + 0.5) * stride;
-                x2 = (box[2] + j + 0.5) * stride;
-                y2 = (box[3] + i + 0.5) * stride;
-                w = x2 - x1;
-                h = y2 - y1;
-                boxes.push_back(x1);
-                boxes.push_back(y1);
-                boxes.push_back(w);
-                boxes.push_back(h);
-
-                objProbs.push_back(deqnt_affine_to_f32(max_score, score_zp, score_scale));
-                classId.push_back(max_class_id);
-                validCount ++;
-            }
+// 单个输出分支的解码参数
+struct decode_branch_args {
+    const void *box;               // box 输出（4 * dfl_len 个通道）
+    const float *box_exp_lut;      // box 输出的 exp 查找表，仅量化模型
+    const void *score;             // 类别分数输出
+    int32_t score_zp;
+    float score_scale;
+    const void *score_sum;         // 类别分数和输出，模型没有该输出时为空
+    int32_t score_sum_zp;
+    float score_sum_scale;
+    tensor_layout box_layout;      // 以下三个布局仅原生布局解码核使用
+    tensor_layout score_layout;
+    tensor_layout score_sum_layout;
+    int grid_h;
+    int grid_w;
+    int stride;
+    int dfl_len;
+    int class_num;
+    float threshold;
+};
+
+/**
+ * @brief 单个输出分支的解码核
+ *        T 为输出元素类型；DFL_LEN、CLASS_NUM 非 0 时循环次数在编译期确定，为 0 时使用 args 中的运行期取值；
+ *        HAS_SCORE_SUM 决定是否先用 score_sum 预筛；NATIVE_LAYOUT 为 false 时输出为 NCHW，
+ *        为 true 时按 args 中的 tensor_layout 直接读取原生布局（NC1HWC2 / NHWC），不做布局转换
+ * @return 候选数量，框、分数、类别追加到暂存区
+ */
+template <typename T, int DFL_LEN, int CLASS_NUM, bool HAS_SCORE_SUM, bool NATIVE_LAYOUT>
+static int decode_branch(const decode_branch_args &args, post_process_scratch &scratch)
+{
+    const T *box_tensor = (const T *)args.box;
+    const T *score_tensor = (const T *)args.score;
+    const T *score_sum_tensor = HAS_SCORE_SUM ? (const T *)args.score_sum : nullptr;
+    int grid_w = args.grid_w;
+    int grid_len = args.grid_h * grid_w;
+    int stride = args.stride;
+    T score_thres = score_thres_of(args.threshold, args.score_zp, args.score_scale, score_tensor);
+    T score_sum_thres = score_sum_thres_of(args.threshold, args.score_sum_zp, args.score_sum_scale, score_tensor);
+
+    // 通过 score sum 与最大类别分数快速过滤，只有候选网格才读取 box
+    if (NATIVE_LAYOUT)
+    {
+        collect_candidates_native<CLASS_NUM, HAS_SCORE_SUM>(score_tensor, args.score_layout, score_sum_tensor,
+                                                            args.score_sum_layout, grid_len, args.class_num,
+                                                            score_thres, score_sum_thres, scratch.candidates);
+    }
+    else
+    {
+        collect_candidates<CLASS_NUM, HAS_SCORE_SUM>(score_tensor, score_sum_tensor, grid_len, args.class_num,
+                                                     score_thres, score_sum_thres, scratch.candidates);
+    }
+
+    for (int n : scratch.candidates)
+    {
+        int i = n / grid_w;
+        int j = n % grid_w;
+        T max_score;
+        int max_class_id = NATIVE_LAYOUT
+                               ? argmax_class_native<CLASS_NUM>(score_tensor, args.score_layout, n, args.class_num, &max_score)
+                               : argmax_class<CLASS_NUM>(score_tensor, n, grid_len, args.class_num, &max_score);
+
+        // compute box
+        float box[4];
+        if (NATIVE_LAYOUT)
+        {
+            compute_dfl_native<DFL_LEN>(box_tensor, args.box_layout, n, args.dfl_len, args.box_exp_lut, box);
+        }
+        else
+        {
+            compute_dfl<DFL_LEN>(box_tensor + n, grid_len, args.dfl_len, args.box_exp_lut, box);
         }
+
+        float x1, y1, x2, y2, w, h;
+        x1 = (-box[0] + j + 0.5) * stride;
+        y1 = (-box[1] + i + 0.5) * stride;
+        x2 = (box[2] + j + 0.5) * stride;
+        y2 = (box[3] + i + 0.5) * stride;
+        w = x2 - x1;
+        h = y2 - y1;
+        scratch.filter_boxes.push_back(x1);
+        scratch.filter_boxes.push_back(y1);
+        scratch.filter_boxes.push_back(w);
+        scratch.filter_boxes.push_back(h);
+
+        scratch.obj_probs.push_back(score_to_f32(max_score, args.score_zp, args.score_scale));
+        scratch.class_id.push_back(max_class_id);
     }
-    printf("validCount=%d\n", validCount);
-    printf("grid h-%d, w-%d, stride %d\n", grid_h, grid_w, stride);
-    return validCount;
+    return scratch.candidates.size();
 }
+
+// 解码核分派表：按 (元素类型, 是否原生布局, dfl_len, 类别数, 是否有 score_sum) 匹配，
+// dfl_len / 类别数为 0 表示任意值，靠前的条目优先
+struct decode_kernel_entry {
+    rknn_tensor_type type;
+    bool native_layout;
+    int dfl_len;
+    int class_num;
+    bool has_score_sum;
+    decode_kernel_t kernel;
+};
+
+#define DECODE_KERNELS(T, TYPE, NATIVE, DFL_LEN, CLASS_NUM) \
+    {TYPE, NATIVE, DFL_LEN, CLASS_NUM, true, decode_branch<T, DFL_LEN, CLASS_NUM, true, NATIVE>}, \
+    {TYPE, NATIVE, DFL_LEN, CLASS_NUM, false, decode_branch<T, DFL_LEN, CLASS_NUM, false, NATIVE>}
+
+// YOLOv8 默认 dfl_len 为 16；单类别与 COCO 80 类单独展开，其余类别数走通用实现
+#define DECODE_KERNELS_FOR_TYPE(T, TYPE, NATIVE) \
+    DECODE_KERNELS(T, TYPE, NATIVE, 16, 1), \
+    DECODE_KERNELS(T, TYPE, NATIVE, 16, 80), \
+    DECODE_KERNELS(T, TYPE, NATIVE, 16, 0), \
+    DECODE_KERNELS(T, TYPE, NATIVE, 0, 0)
+
+static const decode_kernel_entry decode_kernel_table[] = {
+#if defined(RV1106_1103) || defined(ZERO_COPY)
+    DECODE_KERNELS_FOR_TYPE(int8_t, RKNN_TENSOR_INT8, true),
 #endif
+#if defined(ZERO_COPY)
+    DECODE_KERNELS_FOR_TYPE(half_t, RKNN_TENSOR_FLOAT16, true),
+#endif
+#if !defined(RV1106_1103)
+    DECODE_KERNELS_FOR_TYPE(int8_t, RKNN_TENSOR_INT8, false),
+    DECODE_KERNELS_FOR_TYPE(uint8_t, RKNN_TENSOR_UINT8, false),
+    DECODE_KERNELS_FOR_TYPE(half_t, RKNN_TENSOR_FLOAT16, false),
+    DECODE_KERNELS_FOR_TYPE(float, RKNN_TENSOR_FLOAT32, false),
+#endif
+};
 
-int post_process(rknn_app_context_t *app_ctx, void *outputs, letterbox_t *letter_box, float conf_threshold, float nms_threshold, object_detect_result_list *od_results)
+static decode_kernel_t select_decode_kernel(rknn_tensor_type type, bool native_layout, int dfl_len, int class_num,
+                                            bool has_score_sum)
 {
-#if defined(RV1106_1103) 
-    rknn_tensor_mem **_outputs = (rknn_tensor_mem **)outputs;
+    for (size_t i = 0; i < sizeof(decode_kernel_table) / sizeof(decode_kernel_table[0]); i++)
+    {
+        const decode_kernel_entry &entry = decode_kernel_table[i];
+        if (entry.type == type && entry.native_layout == native_layout && entry.has_score_sum == has_score_sum &&
+            (entry.dfl_len == 0 || entry.dfl_len == dfl_len) &&
+            (entry.class_num == 0 || entry.class_num == class_num))
+        {
+            return entry.kernel;
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief 读取分支 box 输出的网格尺寸（不同平台输出维度顺序不同）
+ */
+static void get_branch_grid(const rknn_app_context_t *app_ctx, int box_idx, int *grid_h, int *grid_w)
+{
+    const rknn_tensor_attr *attr = &app_ctx->output_attrs[box_idx];
+#if defined(RV1106_1103)
+    *grid_h = attr->dims[1];
+    *grid_w = attr->dims[2];
+#elif defined(RKNPU1)
+    *grid_h = attr->dims[1];
+    *grid_w = attr->dims[0];
 #else
-    rknn_output *_outputs = (rknn_output *)outputs;
+    *grid_h = attr->dims[2];
+    *grid_w = attr->dims[3];
 #endif
-    std::vector<float> filterBoxes;
-    std::vector<float> objProbs;
-    std::vector<int> classId;
-    int validCount = 0;
-    int stride = 0;
+}
+
+/**
+ * @brief 读取输出张量的通道数（不同平台输出维度顺序不同）
+ */
+static int get_tensor_channel(const rknn_tensor_attr *attr)
+{
+#if defined(RV1106_1103)
+    return attr->dims[3];
+#elif defined(RKNPU1)
+    return attr->dims[2];
+#else
+    return attr->dims[1];
+#endif
+}
+
+/**
+ * @brief post_process 收到的输出元素类型
+ *        量化模型为原始量化类型；fp16 模型直接读取 fp16 输出（RKNPU1 仍按 want_float 取 float）；其余为 float
+ */
+static rknn_tensor_type output_decode_type(const rknn_app_context_t *app_ctx)
+{
+    if (app_ctx->is_quant)
+    {
+        return app_ctx->output_attrs[0].type;
+    }
+#if !defined(RKNPU1)
+    if (app_ctx->output_attrs[0].type == RKNN_TENSOR_FLOAT16)
+    {
+        return RKNN_TENSOR_FLOAT16;
+    }
+#endif
+    return RKNN_TENSOR_FLOAT32;
+}
+
+/**
+ * @brief 读取输出张量在 post_process 收到的内存中的布局
+ *        RV1106/1103 为 NHWC；zero copy 直接读取 rknn_set_io_mem 绑定的原生输出，通常为 NC1HWC2；其余为 NCHW
+ */
+static tensor_layout get_output_layout(const rknn_app_context_t *app_ctx, int idx)
+{
     int grid_h = 0;
     int grid_w = 0;
+    get_branch_grid(app_ctx, idx, &grid_h, &grid_w);
+    tensor_layout layout;
+#if defined(RV1106_1103)
+    int channel = get_tensor_channel(&app_ctx->output_attrs[idx]);
+    layout.c2 = channel;
+    layout.plane_stride = grid_h * grid_w * channel;
+    layout.cell_stride = channel;
+#else
+    layout.c2 = 1;
+    layout.plane_stride = grid_h * grid_w;
+    layout.cell_stride = 1;
+#endif
+#if defined(ZERO_COPY)
+    // 原生属性 dims 为 [N, C1, H, W, C2]
+    const rknn_tensor_attr *native_attr = &app_ctx->output_native_attrs[idx];
+    if (native_attr->fmt == RKNN_TENSOR_NC1HWC2)
+    {
+        layout.c2 = native_attr->dims[4];
+        layout.plane_stride = native_attr->dims[2] * native_attr->dims[3] * native_attr->dims[4];
+        layout.cell_stride = native_attr->dims[4];
+    }
+#endif
+    return layout;
+}
+
+/**
+ * @brief 取第 idx 个输出的数据地址（RV1106/1103 与 zero copy 传入的是 rknn_tensor_mem 指针数组）
+ */
+static inline const void *get_output_buf(void *outputs, int idx)
+{
+#if defined(RV1106_1103) || defined(ZERO_COPY)
+    return ((rknn_tensor_mem **)outputs)[idx]->virt_addr;
+#else
+    return ((rknn_output *)outputs)[idx].buf;
+#endif
+}
+
+int post_process(rknn_app_context_t *app_ctx, void *outputs, letterbox_t *letter_box, float conf_threshold, float nms_threshold, object_detect_result_list *od_results)
+{
+    if (app_ctx->pp_scratch == nullptr)
+    {
+        printf("post process context not initialized, call init_post_process_ctx first\n");
+        return -1;
+    }
+    if (app_ctx->pp_scratch->num_keypoints > 0)
+    {
+        printf("pose model outputs must be decoded with post_process_pose\n");
+        return -1;
+    }
+    // 所有中间结果写入上下文自带的暂存区，预分配容量在多帧之间保留
+    post_process_scratch &scratch = *app_ctx->pp_scratch;
+    std::vector<float> &filterBoxes = scratch.filter_boxes;
+    std::vector<float> &objProbs = scratch.obj_probs;
+    std::vector<int> &classId = scratch.class_id;
+    filterBoxes.clear();
+    objProbs.clear();
+    classId.clear();
+    int validCount = 0;
     int model_in_w = app_ctx->model_width;
     int model_in_h = app_ctx->model_height;
 
     memset(od_results, 0, sizeof(object_detect_result_list));
 
     // default 3 branch
-#ifdef RKNPU1
-    int dfl_len = app_ctx->output_attrs[0].dims[2] / 4;
-#else
-    int dfl_len = app_ctx->output_attrs[0].dims[1] /4;
-#endif
     int output_per_branch = app_ctx->io_num.n_output / 3;
     for (int i = 0; i < 3; i++)
     {
-#if defined(RV1106_1103)
-        dfl_len = app_ctx->output_attrs[0].dims[3] /4;
-        void *score_sum = nullptr;
-        int32_t score_sum_zp = 0;
-        float score_sum_scale = 1.0;
-        if (output_per_branch == 3) {
-            score_sum = _outputs[i * output_per_branch + 2]->virt_addr;
-            score_sum_zp = app_ctx->output_attrs[i * output_per_branch + 2].zp;
-            score_sum_scale = app_ctx->output_attrs[i * output_per_branch + 2].scale;
-        }
         int box_idx = i * output_per_branch;
         int score_idx = i * output_per_branch + 1;
-        grid_h = app_ctx->output_attrs[box_idx].dims[1];
-        grid_w = app_ctx->output_attrs[box_idx].dims[2];
-        stride = model_in_h / grid_h;
-        
-        if (app_ctx->is_quant) {
-            validCount += process_i8_rv1106((int8_t *)_outputs[box_idx]->virt_addr, app_ctx->output_attrs[box_idx].zp, app_ctx->output_attrs[box_idx].scale,
-                                (int8_t *)_outputs[score_idx]->virt_addr, app_ctx->output_attrs[score_idx].zp,
-                                app_ctx->output_attrs[score_idx].scale, (int8_t *)score_sum, score_sum_zp, score_sum_scale,
-                                grid_h, grid_w, stride, dfl_len, filterBoxes, objProbs, classId, conf_threshold);
-        }
-        else
+        decode_branch_args args;
+        args.box = get_output_buf(outputs, box_idx);
+        args.box_exp_lut = app_ctx->dfl_exp_lut != NULL ? app_ctx->dfl_exp_lut + box_idx * 256 : NULL;
+        args.score = get_output_buf(outputs, score_idx);
+        args.score_zp = app_ctx->output_attrs[score_idx].zp;
+        args.score_scale = app_ctx->output_attrs[score_idx].scale;
+        args.score_sum = nullptr;
+        args.score_sum_zp = 0;
+        args.score_sum_scale = 1.0;
+        args.box_layout = scratch.output_layouts[box_idx];
+        args.score_layout = scratch.output_layouts[score_idx];
+        args.score_sum_layout = args.score_layout;
+        if (output_per_branch == 3)
         {
-            printf("RV1106/1103 only support quantization mode\n", LABEL_NALE_TXT_PATH);
-            return -1;
+            args.score_sum = get_output_buf(outputs, i * output_per_branch + 2);
+            args.score_sum_zp = app_ctx->output_attrs[i * output_per_branch + 2].zp;
+            args.score_sum_scale = app_ctx->output_attrs[i * output_per_branch + 2].scale;
+            args.score_sum_layout = scratch.output_layouts[i * output_per_branch + 2];
         }
+        get_branch_grid(app_ctx, box_idx, &args.grid_h, &args.grid_w);
+        args.stride = model_in_h / args.grid_h;
+        args.dfl_len = scratch.dfl_len;
+        args.class_num = app_ctx->class_num;
+        args.threshold = conf_threshold;
 
-#else
-        void *score_sum = nullptr;
-        int32_t score_sum_zp = 0;
-        float score_sum_scale = 1.0;
-        if (output_per_branch == 3){
-            score_sum = _outputs[i*output_per_branch + 2].buf;
-            score_sum_zp = app_ctx->output_attrs[i*output_per_branch + 2].zp;
-            score_sum_scale = app_ctx->output_attrs[i*output_per_branch + 2].scale;
-        }
-        int box_idx = i*output_per_branch;
-        int score_idx = i*output_per_branch + 1;
-
-#ifdef RKNPU1
-        grid_h = app_ctx->output_attrs[box_idx].dims[1];
-        grid_w = app_ctx->output_attrs[box_idx].dims[0];
-#else
-        grid_h = app_ctx->output_attrs[box_idx].dims[2];
-        grid_w = app_ctx->output_attrs[box_idx].dims[3];
-#endif
-        stride = model_in_h / grid_h;
-
-        if (app_ctx->is_quant)
-        {
-#ifdef RKNPU1
-            validCount += process_u8((uint8_t *)_outputs[box_idx].buf, app_ctx->output_attrs[box_idx].zp, app_ctx->output_attrs[box_idx].scale,
-                                     (uint8_t *)_outputs[score_idx].buf, app_ctx->output_attrs[score_idx].zp, app_ctx->output_attrs[score_idx].scale,
-                                     (uint8_t *)score_sum, score_sum_zp, score_sum_scale,
-                                     grid_h, grid_w, stride, dfl_len,
-                                     filterBoxes, objProbs, classId, conf_threshold);
-#else
-            validCount += process_i8((int8_t *)_outputs[box_idx].buf, app_ctx->output_attrs[box_idx].zp, app_ctx->output_attrs[box_idx].scale,
-                                     (int8_t *)_outputs[score_idx].buf, app_ctx->output_attrs[score_idx].zp, app_ctx->output_attrs[score_idx].scale,
-                                     (int8_t *)score_sum, score_sum_zp, score_sum_scale,
-                                     grid_h, grid_w, stride, dfl_len, 
-                                     filterBoxes, objProbs, classId, conf_threshold);
-#endif
-        }
-        else
-        {
-            validCount += process_fp32((float *)_outputs[box_idx].buf, (float *)_outputs[score_idx].buf, (float *)score_sum,
-                                       grid_h, grid_w, stride, dfl_len, 
-                                       filterBoxes, objProbs, classId, conf_threshold);
-        }
-#endif
+        validCount += scratch.decode_kernel(args, scratch);
     }
 
     // no object detect
@@ -705,38 +1176,24 @@ int post_process(rknn_app_context_t *app_ctx, void *outputs, letterbox_t *letter
     {
         return 0;
     }
-    std::vector<int> indexArray;
-    for (int i = 0; i < validCount; ++i)
-    {
-        indexArray.push_back(i);
-    }
-    quick_sort_indice_inverse(objProbs, 0, validCount - 1, indexArray);
-
-    std::set<int> class_set(std::begin(classId), std::end(classId));
-
-    for (auto c : class_set)
-    {
-        nms(validCount, filterBoxes, classId, indexArray, c, nms_threshold);
-    }
+    std::vector<int> &keep = scratch.keep;
+    int keep_count = scratch.nms.run(filterBoxes.data(), objProbs.data(), classId.data(), validCount, app_ctx->class_num,
+                                    nms_threshold, OBJ_NUMB_MAX_SIZE, keep);
 
     int last_count = 0;
     od_results->count = 0;
 
     /* box valid detect target */
-    for (int i = 0; i < validCount; ++i)
+    for (int i = 0; i < keep_count; ++i)
     {
-        if (indexArray[i] == -1 || last_count >= OBJ_NUMB_MAX_SIZE)
-        {
-            continue;
-        }
-        int n = indexArray[i];
+        int n = keep[i];
 
         float x1 = filterBoxes[n * 4 + 0] - letter_box->x_pad;
         float y1 = filterBoxes[n * 4 + 1] - letter_box->y_pad;
         float x2 = x1 + filterBoxes[n * 4 + 2];
         float y2 = y1 + filterBoxes[n * 4 + 3];
         int id = classId[n];
-        float obj_conf = objProbs[i];
+        float obj_conf = objProbs[n];
 
         od_results->results[last_count].box.left = (int)(clamp(x1, 0, model_in_w) / letter_box->scale);
         od_results->results[last_count].box.top = (int)(clamp(y1, 0, model_in_h) / letter_box->scale);
@@ -750,6 +1207,154 @@ int post_process(rknn_app_context_t *app_ctx, void *outputs, letterbox_t *letter
     return 0;
 }
 
+#if defined(YOLOV8_POSE_SUPPORTED)
+/**
+ * @brief 是否为姿态模型的输出：3 个分支各一个 box + 分数输出（4 * dfl_len + 1 个通道），
+ *        第 4 个输出为 [N, 关键点数, 3, 网格总数] 的关键点（x, y, 置信度）
+ */
+static bool is_pose_layout(const rknn_app_context_t *app_ctx)
+{
+    if (app_ctx->io_num.n_output != 4)
+    {
+        return false;
+    }
+    const rknn_tensor_attr *kpt_attr = &app_ctx->output_attrs[3];
+    return kpt_attr->n_dims == 4 && kpt_attr->dims[2] == 3;
+}
+
+/**
+ * @brief 姿态模型的后处理状态：每个裁剪图只取一个人体，不经过解码核与 NMS，暂存区只记录分数通道与关键点数
+ */
+static int init_pose_post_process_ctx(rknn_app_context_t *app_ctx)
+{
+    int channel = get_tensor_channel(&app_ctx->output_attrs[0]);
+    int anchors = 0;
+    for (int i = 0; i < 3; i++)
+    {
+        if (get_tensor_channel(&app_ctx->output_attrs[i]) != channel)
+        {
+            printf("pose output branch %d does not match channel %d\n", i, channel);
+            return -1;
+        }
+        int grid_h = 0;
+        int grid_w = 0;
+        get_branch_grid(app_ctx, i, &grid_h, &grid_w);
+        anchors += grid_h * grid_w;
+    }
+    const rknn_tensor_attr *kpt_attr = &app_ctx->output_attrs[3];
+    int dfl_len = (channel - 1) / 4;
+    int num_keypoints = kpt_attr->dims[1];
+    if ((channel - 1) % 4 != 0 || dfl_len <= 0 || dfl_len > DFL_LEN_MAX || (int)kpt_attr->dims[3] != anchors ||
+        num_keypoints <= 0 || num_keypoints > POSE_KPT_NUM_MAX)
+    {
+        printf("unexpected pose outputs: channel=%d keypoints dims=[%d, %d, %d, %d] anchors=%d\n", channel,
+               kpt_attr->dims[0], kpt_attr->dims[1], kpt_attr->dims[2], kpt_attr->dims[3], anchors);
+        return -1;
+    }
+    post_process_scratch *scratch = new post_process_scratch;
+    scratch->decode_kernel = NULL;
+    scratch->dfl_len = dfl_len;
+    scratch->num_keypoints = num_keypoints;
+    app_ctx->class_num = 1;
+    app_ctx->pp_scratch = scratch;
+    return 0;
+}
+
+/**
+ * @brief 输出张量的元素类型，与 init_io_buffers 取输出的方式一致：
+ *        量化模型为各输出的原始类型，fp16 输出直接读取，其余由运行时转换为 float
+ */
+static rknn_tensor_type output_element_type(const rknn_app_context_t *app_ctx, int idx)
+{
+    const rknn_tensor_attr *attr = &app_ctx->output_attrs[idx];
+    if (app_ctx->is_quant || attr->type == RKNN_TENSOR_FLOAT16)
+    {
+        return attr->type;
+    }
+    return RKNN_TENSOR_FLOAT32;
+}
+
+/**
+ * @brief 读取输出张量第 idx 个元素并转换为 float（姿态后处理每个裁剪图只读一个通道与一组关键点，不需要专门的解码核）
+ */
+static inline float output_value(const void *buf, rknn_tensor_type type, int32_t zp, float scale, int idx)
+{
+    switch (type)
+    {
+    case RKNN_TENSOR_INT8:
+        return deqnt_affine_to_f32(((const int8_t *)buf)[idx], zp, scale);
+    case RKNN_TENSOR_UINT8:
+        return deqnt_affine_u8_to_f32(((const uint8_t *)buf)[idx], zp, scale);
+    case RKNN_TENSOR_FLOAT16:
+        return half_to_float(((const half_t *)buf)[idx]);
+    default:
+        return ((const float *)buf)[idx];
+    }
+}
+
+int post_process_pose(rknn_app_context_t *app_ctx, void *outputs, letterbox_t *letter_box, float conf_threshold,
+                      object_pose_result *pose)
+{
+    pose->kpt_count = 0;
+    pose->prop = 0;
+    if (app_ctx->pp_scratch == NULL || app_ctx->pp_scratch->num_keypoints <= 0)
+    {
+        printf("not a pose model context\n");
+        return -1;
+    }
+    const post_process_scratch &scratch = *app_ctx->pp_scratch;
+
+    // 分数通道为 box DFL 之后的最后一个通道，输出为 logit；在三个分支中找分数最高的网格
+    int score_channel = 4 * scratch.dfl_len;
+    float best_logit = -INFINITY;
+    int best_anchor = -1;
+    int anchor_base = 0;
+    for (int i = 0; i < 3; i++)
+    {
+        const rknn_tensor_attr *attr = &app_ctx->output_attrs[i];
+        rknn_tensor_type type = output_element_type(app_ctx, i);
+        const void *buf = get_output_buf(outputs, i);
+        int grid_h = 0;
+        int grid_w = 0;
+        get_branch_grid(app_ctx, i, &grid_h, &grid_w);
+        int grid_len = grid_h * grid_w;
+        for (int n = 0; n < grid_len; n++)
+        {
+            float logit = output_value(buf, type, attr->zp, attr->scale, score_channel * grid_len + n);
+            if (logit > best_logit)
+            {
+                best_logit = logit;
+                best_anchor = anchor_base + n;
+            }
+        }
+        anchor_base += grid_len;
+    }
+    float prop = sigmoid(best_logit);
+    if (best_anchor < 0 || prop <= conf_threshold)
+    {
+        return 0;
+    }
+
+    // 关键点已在模型内解码为输入像素坐标（置信度已过 sigmoid），只需去掉 letterbox
+    const rknn_tensor_attr *kpt_attr = &app_ctx->output_attrs[3];
+    rknn_tensor_type kpt_type = output_element_type(app_ctx, 3);
+    const void *kpt_buf = get_output_buf(outputs, 3);
+    int anchors = anchor_base;
+    for (int k = 0; k < scratch.num_keypoints; k++)
+    {
+        int base = k * 3 * anchors + best_anchor;
+        float x = output_value(kpt_buf, kpt_type, kpt_attr->zp, kpt_attr->scale, base);
+        float y = output_value(kpt_buf, kpt_type, kpt_attr->zp, kpt_attr->scale, base + anchors);
+        pose->keypoints[k].x = (x - letter_box->x_pad) / letter_box->scale;
+        pose->keypoints[k].y = (y - letter_box->y_pad) / letter_box->scale;
+        pose->keypoints[k].conf = output_value(kpt_buf, kpt_type, kpt_attr->zp, kpt_attr->scale, base + 2 * anchors);
+    }
+    pose->prop = prop;
+    pose->kpt_count = scratch.num_keypoints;
+    return 0;
+}
+#endif
+
 int init_post_process()
 {
     int ret = 0;
@@ -762,6 +1367,123 @@ int init_post_process()
     return 0;
 }
 
+int init_post_process_ctx(rknn_app_context_t *app_ctx)
+{
+    deinit_post_process_ctx(app_ctx);
+
+#if defined(YOLOV8_POSE_SUPPORTED)
+    if (is_pose_layout(app_ctx))
+    {
+        return init_pose_post_process_ctx(app_ctx);
+    }
+#endif
+
+    // 类别数与 DFL 长度由输出张量得到，三个分支必须一致
+    int output_per_branch = app_ctx->io_num.n_output / 3;
+    int dfl_len = get_tensor_channel(&app_ctx->output_attrs[0]) / 4;
+    int class_num = get_tensor_channel(&app_ctx->output_attrs[1]);
+    for (int i = 1; i < 3; i++)
+    {
+        if (get_tensor_channel(&app_ctx->output_attrs[i * output_per_branch]) / 4 != dfl_len ||
+            get_tensor_channel(&app_ctx->output_attrs[i * output_per_branch + 1]) != class_num)
+        {
+            printf("output branch %d does not match dfl_len %d class_num %d\n", i, dfl_len, class_num);
+            return -1;
+        }
+    }
+    if (dfl_len <= 0 || dfl_len > DFL_LEN_MAX)
+    {
+        printf("dfl_len %d exceeds DFL_LEN_MAX %d\n", dfl_len, DFL_LEN_MAX);
+        return -1;
+    }
+#if defined(RV1106_1103)
+    if (!app_ctx->is_quant)
+    {
+        printf("RV1106/1103 only support quantization mode\n");
+        return -1;
+    }
+#endif
+    // 任一输出不是 NCHW 时使用原生布局解码核（它同样能按 c2 = 1 读取 NCHW 输出）
+    std::vector<tensor_layout> output_layouts(app_ctx->io_num.n_output);
+    bool native_layout = false;
+    for (int i = 0; i < (int)app_ctx->io_num.n_output; i++)
+    {
+        output_layouts[i] = get_output_layout(app_ctx, i);
+        native_layout = native_layout || output_layouts[i].c2 != 1;
+    }
+    rknn_tensor_type type = output_decode_type(app_ctx);
+    decode_kernel_t decode_kernel = select_decode_kernel(type, native_layout, dfl_len, class_num, output_per_branch == 3);
+    if (decode_kernel == NULL)
+    {
+        printf("no decode kernel for type=%s layout=%s dfl_len=%d class_num=%d outputs=%d\n",
+               get_type_string(type), native_layout ? "native" : "NCHW", dfl_len, class_num, app_ctx->io_num.n_output);
+        return -1;
+    }
+    app_ctx->class_num = class_num;
+
+    // 按三个分支的网格总数预留暂存区，稳态下后处理不再申请堆内存
+    int max_candidates = 0;
+    for (int i = 0; i < 3; i++)
+    {
+        int grid_h = 0;
+        int grid_w = 0;
+        get_branch_grid(app_ctx, i * output_per_branch, &grid_h, &grid_w);
+        max_candidates += grid_h * grid_w;
+    }
+    post_process_scratch *scratch = new post_process_scratch;
+    scratch->filter_boxes.reserve(max_candidates * 4);
+    scratch->obj_probs.reserve(max_candidates);
+    scratch->class_id.reserve(max_candidates);
+    scratch->candidates.reserve(max_candidates);
+    scratch->keep.reserve(OBJ_NUMB_MAX_SIZE);
+    scratch->nms.reserve(max_candidates, class_num, OBJ_NUMB_MAX_SIZE);
+    scratch->decode_kernel = decode_kernel;
+    scratch->dfl_len = dfl_len;
+    scratch->output_layouts.swap(output_layouts);
+    scratch->num_keypoints = 0;
+    app_ctx->pp_scratch = scratch;
+
+    if (!app_ctx->is_quant)
+    {
+        return 0;
+    }
+
+    // 量化输出每个元素只有 256 种取值，exp 结果按 (scale, zp) 预先算好
+    int n_output = app_ctx->io_num.n_output;
+    app_ctx->dfl_exp_lut = (float *)malloc(n_output * 256 * sizeof(float));
+    if (app_ctx->dfl_exp_lut == NULL)
+    {
+        printf("malloc dfl exp lut fail!\n");
+        return -1;
+    }
+    for (int i = 0; i < n_output; i++)
+    {
+        const rknn_tensor_attr *attr = &app_ctx->output_attrs[i];
+        float *lut = app_ctx->dfl_exp_lut + i * 256;
+        for (int q = 0; q < 256; q++)
+        {
+            float deq = attr->type == RKNN_TENSOR_INT8 ? deqnt_affine_to_f32((int8_t)q, attr->zp, attr->scale)
+                                                       : deqnt_affine_u8_to_f32((uint8_t)q, attr->zp, attr->scale);
+            lut[q] = exp(deq);
+        }
+    }
+    return 0;
+}
+
+void deinit_post_process_ctx(rknn_app_context_t *app_ctx)
+{
+    if (app_ctx->pp_scratch != NULL)
+    {
+        delete app_ctx->pp_scratch;
+        app_ctx->pp_scratch = NULL;
+    }
+    if (app_ctx->dfl_exp_lut != NULL)
+    {
+        free(app_ctx->dfl_exp_lut);
+        app_ctx->dfl_exp_lut = NULL;
+    }
+}
+
 char *coco_cls_to_name(int cls_id)
 {
     static char result[] = "null";
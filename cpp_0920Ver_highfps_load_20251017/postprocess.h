@@ -6,10 +6,16 @@
 #include "rknn_api.h"
 #include "common.h"
 #include "image_utils.h"
+#include "nms.h"
 
 #define OBJ_NAME_MAX_SIZE 64
 #define OBJ_NUMB_MAX_SIZE 128
-#define OBJ_CLASS_NUM 1
+// 标签表容量（coco_80_labels_list.txt）；模型的实际类别数在 init_post_process_ctx 中由 score 输出通道数得到
+#define OBJ_CLASS_NUM 80
+#define DFL_LEN_MAX 32
+// DFL 解码（量化输出查 exp 表、float 输出用 expf、向量化求和）与逐元素反量化后 exp 的基线实现相比，
+// 框坐标的最大误差（模型输入像素，按最大 stride 32 计），误差只来自求和顺序；tests/test_dfl_lut.cc 断言
+#define DFL_LUT_MAX_ERROR_PX 0.001f
 #define NMS_THRESH 0.45
 #define BOX_THRESH 0.25
 
@@ -21,16 +27,80 @@ typedef struct {
     int cls_id;
 } object_detect_result;
 
+// 姿态关键点（COCO 17 点）与每帧做姿态估计的最多目标数
+#define POSE_KPT_NUM_MAX 17
+#define POSE_NUMB_MAX_SIZE 16
+
+typedef struct {
+    float x;
+    float y;
+    float conf;
+} object_keypoint;
+
+// 第二阶段姿态模型对一个检测框裁剪图的结果，坐标为源图像素
+typedef struct {
+    int det_index;     // 对应 results 中的检测框下标
+    float prop;        // 姿态模型对裁剪图中人体的置信度
+    int kpt_count;
+    object_keypoint keypoints[POSE_KPT_NUM_MAX];
+} object_pose_result;
+
 typedef struct {
     int id;
     int count;
     object_detect_result results[OBJ_NUMB_MAX_SIZE];
 } object_detect_result_list;
 
+// 一帧的第二阶段姿态结果，与检测结果分开交付：检测结果每帧拷贝多次，姿态结果只在配置了级联模型时才有
+typedef struct {
+    int count;
+    object_pose_result poses[POSE_NUMB_MAX_SIZE];
+} object_pose_result_list;
+
+// 输出张量的寻址方式：通道 c、网格 n 的元素位于 (c / c2) * plane_stride + n * cell_stride + c % c2
+// NCHW 为 c2 = 1；NC1HWC2（zero copy 原生输出）与 NHWC（RV1106/1103）为同一网格的 c2 个通道连续存放
+struct tensor_layout {
+    int c2;
+    int plane_stride;
+    int cell_stride;
+};
+
+struct post_process_scratch;
+struct decode_branch_args;
+// 单个输出分支的解码核：筛选候选网格并把框、分数、类别追加到暂存区，返回候选数量
+typedef int (*decode_kernel_t)(const decode_branch_args &args, post_process_scratch &scratch);
+
+// 后处理暂存区：每个上下文一份，解码与 NMS 的中间结果都写在这里，容量在多帧之间保留
+struct post_process_scratch {
+    std::vector<float> filter_boxes;   // 候选框 (x, y, w, h)
+    std::vector<float> obj_probs;      // 候选分数
+    std::vector<int> class_id;         // 候选类别
+    std::vector<int> candidates;       // 单个分支通过分数过滤的网格下标
+    std::vector<int> keep;             // NMS 保留的候选下标
+    NmsEngine nms;
+    decode_kernel_t decode_kernel;     // 按输出张量属性选定的解码核（init_post_process_ctx）
+    int dfl_len;                       // box 输出的 DFL 分布长度
+    std::vector<tensor_layout> output_layouts;  // 各输出张量在 post_process 收到的内存中的布局
+    int num_keypoints;                 // 姿态模型的关键点数，检测模型为 0
+};
+
 int init_post_process();
 void deinit_post_process();
+// 按上下文的输出张量属性构建后处理缓存（暂存区、DFL exp 查找表）并选定解码核，在 init_yolov8_model 末尾调用
+int init_post_process_ctx(rknn_app_context_t *app_ctx);
+void deinit_post_process_ctx(rknn_app_context_t *app_ctx);
 char *coco_cls_to_name(int cls_id);
 int post_process(rknn_app_context_t *app_ctx, void *outputs, letterbox_t *letter_box, float conf_threshold, float nms_threshold, object_detect_result_list *od_results);
 
+#if !defined(RV1106_1103) && !defined(ZERO_COPY) && !defined(RKNPU1)
+// 姿态模型（YOLOv8-pose，rknn_model_zoo 导出的 4 输出图）只支持通用 NCHW 输出布局
+#define YOLOV8_POSE_SUPPORTED
+
+// 解码姿态模型输出：模型输入为一个检测框的裁剪图，只取置信度最高的一个人体；
+// 关键点坐标还原到裁剪图像素，置信度不超过 conf_threshold 时 kpt_count 为 0
+int post_process_pose(rknn_app_context_t *app_ctx, void *outputs, letterbox_t *letter_box, float conf_threshold,
+                      object_pose_result *pose);
+#endif
+
 void deinitPostProcess();
 #endif //_RKNN_YOLOV8_DEMO_POSTPROCESS_H_
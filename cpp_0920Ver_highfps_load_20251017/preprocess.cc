@@ -0,0 +1,359 @@
+#include "preprocess.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#if defined(__aarch64__)
+#include <arm_neon.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#define LETTERBOX_WEIGHT_ONE (1 << LETTERBOX_WEIGHT_BITS)
+// 水平、垂直两次插值后的总小数位数
+#define LETTERBOX_SHIFT (LETTERBOX_WEIGHT_BITS * 2)
+
+/**
+ * @brief 计算一个方向的插值表（像素中心对齐，同 OpenCV INTER_LINEAR），src 为该方向的源像素数
+ */
+static void build_axis_table(int src, int dst, std::vector<int> &idx0, std::vector<int> &idx1,
+                             std::vector<uint16_t> &weight)
+{
+    idx0.resize(dst);
+    idx1.resize(dst);
+    weight.resize(dst);
+    const float ratio = (float)src / dst;
+    for (int i = 0; i < dst; i++)
+    {
+        float f = (i + 0.5f) * ratio - 0.5f;
+        int i0 = (int)floorf(f);
+        int w = (int)lrintf((f - i0) * LETTERBOX_WEIGHT_ONE);
+        if (w == LETTERBOX_WEIGHT_ONE)
+        {
+            i0++;
+            w = 0;
+        }
+        if (i0 < 0)
+        {
+            i0 = 0;
+            w = 0;
+        }
+        if (i0 >= src - 1)
+        {
+            i0 = src - 1;
+            w = 0;
+        }
+        idx0[i] = i0;
+        // 权重为 0 时两点取同一位置，垂直方向可复用同一行
+        idx1[i] = w ? i0 + 1 : i0;
+        weight[i] = (uint16_t)w;
+    }
+}
+
+/**
+ * @brief 重新计算几何参数并重写边框（源图尺寸或目标缓冲区变化时调用）
+ */
+static void update_geometry(letterbox_cache &cache, int src_width, int src_height, unsigned char *dst, int dst_width,
+                            int dst_height, int dst_stride, int bg_color)
+{
+    float scale_w = (float)dst_width / src_width;
+    float scale_h = (float)dst_height / src_height;
+    float scale = scale_w < scale_h ? scale_w : scale_h;
+    // 与 convert_image_with_letterbox 一致：宽按 4 对齐，高按 2 对齐，左上留边取偶数
+    int resize_w = (int)(src_width * scale) / 4 * 4;
+    int resize_h = (int)(src_height * scale) / 2 * 2;
+    if (resize_w <= 0)
+    {
+        resize_w = dst_width < 4 ? dst_width : 4;
+    }
+    if (resize_h <= 0)
+    {
+        resize_h = dst_height < 2 ? dst_height : 2;
+    }
+    int left = (dst_width - resize_w) / 2 / 2 * 2;
+    int top = (dst_height - resize_h) / 2 / 2 * 2;
+
+    cache.src_width = src_width;
+    cache.src_height = src_height;
+    cache.dst = dst;
+    cache.dst_width = dst_width;
+    cache.dst_height = dst_height;
+    cache.dst_stride = dst_stride;
+    cache.bg_color = bg_color;
+    cache.letter_box.scale = scale;
+    cache.letter_box.x_pad = left;
+    cache.letter_box.y_pad = top;
+    cache.resize_width = resize_w;
+    cache.resize_height = resize_h;
+
+    std::vector<int> x0, x1;
+    build_axis_table(src_width, resize_w, x0, x1, cache.x_weight);
+    cache.x_ofs0.resize(resize_w);
+    cache.x_ofs1.resize(resize_w);
+    for (int i = 0; i < resize_w; i++)
+    {
+        cache.x_ofs0[i] = x0[i] * 3;
+        cache.x_ofs1[i] = x1[i] * 3;
+    }
+    build_axis_table(src_height, resize_h, cache.y_row0, cache.y_row1, cache.y_weight);
+    cache.rows[0].resize(resize_w * 3);
+    cache.rows[1].resize(resize_w * 3);
+    cache.row_index[0] = -1;
+    cache.row_index[1] = -1;
+
+    // 边框：上下整行，内容行的左右两段
+    for (int y = 0; y < dst_height; y++)
+    {
+        unsigned char *row = dst + (size_t)y * dst_stride;
+        if (y < top || y >= top + resize_h)
+        {
+            memset(row, bg_color, dst_width * 3);
+        }
+        else
+        {
+            memset(row, bg_color, left * 3);
+            memset(row + (left + resize_w) * 3, bg_color, (dst_width - left - resize_w) * 3);
+        }
+    }
+}
+
+/**
+ * @brief 源图一行的水平插值，同时完成 BGR→RGB；结果带 LETTERBOX_WEIGHT_BITS 位小数
+ */
+static void resize_row_h(const letterbox_cache &cache, const unsigned char *src_row, uint16_t *out)
+{
+    const int *ofs0 = cache.x_ofs0.data();
+    const int *ofs1 = cache.x_ofs1.data();
+    const uint16_t *weight = cache.x_weight.data();
+    int x = 0;
+#if defined(__aarch64__) || defined(__SSE2__)
+    // 每次取 8 个像素：按预计算的偏移表以 4 字节整取像素（BGRx），第 4 字节丢弃；
+    // 整取会多读 1 字节，只处理读取不越过行尾的像素，行尾交给标量部分
+    int vec_end = cache.resize_width;
+    const int ofs_limit = cache.src_width * 3 - 4;
+    while (vec_end > 0 && ofs1[vec_end - 1] > ofs_limit)
+    {
+        vec_end--;
+    }
+    uint32_t px0[8], px1[8];
+#endif
+#if defined(__aarch64__)
+    const uint8x8_t one = vdup_n_u8(LETTERBOX_WEIGHT_ONE);
+    for (; x + 8 <= vec_end; x += 8)
+    {
+        for (int k = 0; k < 8; k++)
+        {
+            memcpy(&px0[k], src_row + ofs0[x + k], 4);
+            memcpy(&px1[k], src_row + ofs1[x + k], 4);
+        }
+        // vld4 解交错为 B/G/R 三个通道，权重不超过 128，u8 乘加结果不超过 u16
+        uint8x8x4_t a = vld4_u8((const uint8_t *)px0);
+        uint8x8x4_t b = vld4_u8((const uint8_t *)px1);
+        uint8x8_t w1 = vmovn_u16(vld1q_u16(weight + x));
+        uint8x8_t w0 = vsub_u8(one, w1);
+        uint16x8x3_t rgb;
+        rgb.val[0] = vmlal_u8(vmull_u8(a.val[2], w0), b.val[2], w1);
+        rgb.val[1] = vmlal_u8(vmull_u8(a.val[1], w0), b.val[1], w1);
+        rgb.val[2] = vmlal_u8(vmull_u8(a.val[0], w0), b.val[0], w1);
+        vst3q_u16(out + x * 3, rgb);
+    }
+#elif defined(__SSE2__)
+    // 每像素按 BGRx 四个 16 位计算，换序为 RGBx 后以 8 字节写出，x 位由下一个像素覆盖，
+    // 因此块后必须还有像素（x + 8 < vec_end）
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i one = _mm_set1_epi16(LETTERBOX_WEIGHT_ONE);
+    for (; x + 8 < vec_end; x += 8)
+    {
+        for (int k = 0; k < 8; k++)
+        {
+            memcpy(&px0[k], src_row + ofs0[x + k], 4);
+            memcpy(&px1[k], src_row + ofs1[x + k], 4);
+        }
+        __m128i w = _mm_loadu_si128((const __m128i *)(weight + x));
+        __m128i wlo = _mm_unpacklo_epi16(w, w);
+        __m128i whi = _mm_unpackhi_epi16(w, w);
+        // 每个像素的权重扩展到 4 个通道，依次对应像素 0-1、2-3、4-5、6-7
+        __m128i w1[4] = {_mm_unpacklo_epi32(wlo, wlo), _mm_unpackhi_epi32(wlo, wlo), _mm_unpacklo_epi32(whi, whi),
+                         _mm_unpackhi_epi32(whi, whi)};
+        __m128i a[2] = {_mm_loadu_si128((const __m128i *)px0), _mm_loadu_si128((const __m128i *)(px0 + 4))};
+        __m128i b[2] = {_mm_loadu_si128((const __m128i *)px1), _mm_loadu_si128((const __m128i *)(px1 + 4))};
+        uint16_t *dst = out + x * 3;
+        for (int k = 0; k < 4; k++)
+        {
+            __m128i pa = (k & 1) ? _mm_unpackhi_epi8(a[k >> 1], zero) : _mm_unpacklo_epi8(a[k >> 1], zero);
+            __m128i pb = (k & 1) ? _mm_unpackhi_epi8(b[k >> 1], zero) : _mm_unpacklo_epi8(b[k >> 1], zero);
+            __m128i s = _mm_add_epi16(_mm_mullo_epi16(pa, _mm_sub_epi16(one, w1[k])), _mm_mullo_epi16(pb, w1[k]));
+            s = _mm_shufflehi_epi16(_mm_shufflelo_epi16(s, _MM_SHUFFLE(3, 0, 1, 2)), _MM_SHUFFLE(3, 0, 1, 2));
+            _mm_storel_epi64((__m128i *)dst, s);
+            _mm_storel_epi64((__m128i *)(dst + 3), _mm_unpackhi_epi64(s, s));
+            dst += 6;
+        }
+    }
+#endif
+    out += x * 3;
+    for (; x < cache.resize_width; x++)
+    {
+        const unsigned char *p0 = src_row + ofs0[x];
+        const unsigned char *p1 = src_row + ofs1[x];
+        const int w1 = weight[x];
+        const int w0 = LETTERBOX_WEIGHT_ONE - w1;
+        out[0] = (uint16_t)(p0[2] * w0 + p1[2] * w1);
+        out[1] = (uint16_t)(p0[1] * w0 + p1[1] * w1);
+        out[2] = (uint16_t)(p0[0] * w0 + p1[0] * w1);
+        out += 3;
+    }
+}
+
+/**
+ * @brief 两行水平插值结果的垂直插值并舍入为 uint8
+ */
+static void resize_row_v(const uint16_t *row0, const uint16_t *row1, int wy, unsigned char *dst, int n)
+{
+    const int w0 = LETTERBOX_WEIGHT_ONE - wy;
+    int i = 0;
+#if defined(__aarch64__)
+    const uint16x4_t vw0 = vdup_n_u16((uint16_t)w0);
+    const uint16x4_t vw1 = vdup_n_u16((uint16_t)wy);
+    for (; i + 8 <= n; i += 8)
+    {
+        uint16x8_t a = vld1q_u16(row0 + i);
+        uint16x8_t b = vld1q_u16(row1 + i);
+        uint32x4_t lo = vmlal_u16(vmull_u16(vget_low_u16(a), vw0), vget_low_u16(b), vw1);
+        uint32x4_t hi = vmlal_u16(vmull_u16(vget_high_u16(a), vw0), vget_high_u16(b), vw1);
+        uint16x8_t s = vcombine_u16(vrshrn_n_u32(lo, LETTERBOX_SHIFT), vrshrn_n_u32(hi, LETTERBOX_SHIFT));
+        vst1_u8(dst + i, vqmovn_u16(s));
+    }
+#elif defined(__SSE2__)
+    // 水平结果不超过 255 << 7，可按有符号 16 位交错后用 madd 一次完成两行加权
+    const __m128i vw = _mm_set1_epi32((wy << 16) | w0);
+    const __m128i round = _mm_set1_epi32(1 << (LETTERBOX_SHIFT - 1));
+    for (; i + 8 <= n; i += 8)
+    {
+        __m128i a = _mm_loadu_si128((const __m128i *)(row0 + i));
+        __m128i b = _mm_loadu_si128((const __m128i *)(row1 + i));
+        __m128i lo = _mm_madd_epi16(_mm_unpacklo_epi16(a, b), vw);
+        __m128i hi = _mm_madd_epi16(_mm_unpackhi_epi16(a, b), vw);
+        lo = _mm_srai_epi32(_mm_add_epi32(lo, round), LETTERBOX_SHIFT);
+        hi = _mm_srai_epi32(_mm_add_epi32(hi, round), LETTERBOX_SHIFT);
+        __m128i s = _mm_packs_epi32(lo, hi);
+        _mm_storel_epi64((__m128i *)(dst + i), _mm_packus_epi16(s, s));
+    }
+#endif
+    for (; i < n; i++)
+    {
+        dst[i] = (unsigned char)((row0[i] * w0 + row1[i] * wy + (1 << (LETTERBOX_SHIFT - 1))) >> LETTERBOX_SHIFT);
+    }
+}
+
+/**
+ * @brief 取源行 y 的水平插值结果，命中缓存的两行之一时不重复计算；keep 为本次还要使用、不可覆盖的槽位
+ */
+static const uint16_t *fetch_row(letterbox_cache &cache, const unsigned char *src, int src_stride, int y, int keep)
+{
+    for (int s = 0; s < 2; s++)
+    {
+        if (cache.row_index[s] == y)
+        {
+            return cache.rows[s].data();
+        }
+    }
+    // 优先覆盖行号较小的槽位（逐行向下处理，较小的行不会再用到）
+    int slot = cache.row_index[0] <= cache.row_index[1] ? 0 : 1;
+    if (slot == keep)
+    {
+        slot = 1 - keep;
+    }
+    resize_row_h(cache, src + (size_t)y * src_stride, cache.rows[slot].data());
+    cache.row_index[slot] = y;
+    return cache.rows[slot].data();
+}
+
+int letterbox_bgr_to_rgb(letterbox_cache &cache, const unsigned char *src, int src_width, int src_height, int src_stride,
+                         unsigned char *dst, int dst_width, int dst_height, int dst_stride, int bg_color,
+                         letterbox_t *letter_box)
+{
+    if (src == NULL || dst == NULL || src_width <= 0 || src_height <= 0 || dst_width <= 0 || dst_height <= 0 ||
+        src_stride < src_width * 3 || dst_stride < dst_width * 3)
+    {
+        printf("letterbox_bgr_to_rgb invalid args! src=%dx%d stride=%d dst=%dx%d stride=%d\n", src_width, src_height,
+               src_stride, dst_width, dst_height, dst_stride);
+        return -1;
+    }
+
+    if (src_width != cache.src_width || src_height != cache.src_height || dst != cache.dst ||
+        dst_width != cache.dst_width || dst_height != cache.dst_height || dst_stride != cache.dst_stride ||
+        bg_color != cache.bg_color)
+    {
+        update_geometry(cache, src_width, src_height, dst, dst_width, dst_height, dst_stride, bg_color);
+    }
+    // 水平插值结果对应上一帧的源图，不能跨帧复用
+    cache.row_index[0] = -1;
+    cache.row_index[1] = -1;
+
+    const int n = cache.resize_width * 3;
+    unsigned char *out = dst + (size_t)cache.letter_box.y_pad * dst_stride + cache.letter_box.x_pad * 3;
+    for (int y = 0; y < cache.resize_height; y++, out += dst_stride)
+    {
+        const int wy = cache.y_weight[y];
+        const uint16_t *row0 = fetch_row(cache, src, src_stride, cache.y_row0[y], -1);
+        const int slot0 = row0 == cache.rows[0].data() ? 0 : 1;
+        const uint16_t *row1 = wy ? fetch_row(cache, src, src_stride, cache.y_row1[y], slot0) : row0;
+        resize_row_v(row0, row1, wy, out, n);
+    }
+
+    if (letter_box != NULL)
+    {
+        *letter_box = cache.letter_box;
+    }
+    return 0;
+}
+
+int letterbox_image_to_rgb(letterbox_cache &cache, image_buffer_t *src, unsigned char *dst, int dst_width,
+                           int dst_height, int bg_color, letterbox_t *letter_box)
+{
+    if (src == NULL || dst == NULL || src->width <= 0 || src->height <= 0 || dst_width <= 0 || dst_height <= 0)
+    {
+        printf("letterbox_image_to_rgb invalid args! dst=%dx%d\n", dst_width, dst_height);
+        return -1;
+    }
+
+    const int dst_stride = dst_width * 3;
+    if (src->width != cache.src_width || src->height != cache.src_height || dst != cache.dst ||
+        dst_width != cache.dst_width || dst_height != cache.dst_height || dst_stride != cache.dst_stride ||
+        bg_color != cache.bg_color)
+    {
+        update_geometry(cache, src->width, src->height, dst, dst_width, dst_height, dst_stride, bg_color);
+    }
+
+    image_buffer_t dst_img;
+    memset(&dst_img, 0, sizeof(image_buffer_t));
+    dst_img.width = dst_width;
+    dst_img.height = dst_height;
+    dst_img.format = IMAGE_FORMAT_RGB888;
+    dst_img.virt_addr = dst;
+    dst_img.size = get_image_size(&dst_img);
+
+    if (cache.resize_width != dst_width)
+    {
+        // 左右留边：内容行不连续，整幅交给 convert_image_with_letterbox（留边计算相同，边框不变）
+        return convert_image_with_letterbox(src, &dst_img, letter_box, bg_color);
+    }
+
+    // 只有上下留边：缩放后的行连续，只转换内容行
+    dst_img.height = cache.resize_height;
+    dst_img.virt_addr = dst + (size_t)cache.letter_box.y_pad * dst_stride;
+    dst_img.size = get_image_size(&dst_img);
+    image_rect_t src_rect = {0, 0, src->width - 1, src->height - 1};
+    image_rect_t dst_rect = {0, 0, dst_img.width - 1, dst_img.height - 1};
+    int ret = convert_image(src, &dst_img, &src_rect, &dst_rect, bg_color);
+    if (ret < 0)
+    {
+        return ret;
+    }
+    if (letter_box != NULL)
+    {
+        *letter_box = cache.letter_box;
+    }
+    return 0;
+}
@@ -0,0 +1,75 @@
+#ifndef _RKNN_YOLOV8_DEMO_PREPROCESS_H_
+#define _RKNN_YOLOV8_DEMO_PREPROCESS_H_
+
+#include <stdint.h>
+#include <vector>
+#include "common.h"
+#include "image_utils.h"
+
+// 双线性插值权重的小数位数
+#define LETTERBOX_WEIGHT_BITS 7
+
+// letterbox 几何参数及插值表（按源图尺寸与目标缓冲区缓存，多次调用间复用）
+struct letterbox_cache {
+    // 缓存键
+    int src_width;
+    int src_height;
+    const unsigned char *dst;
+    int dst_width;
+    int dst_height;
+    int dst_stride;
+    int bg_color;
+
+    letterbox_t letter_box;
+    int resize_width;
+    int resize_height;
+    // 目标列 x 对应的两个源像素字节偏移及右侧像素权重
+    std::vector<int> x_ofs0, x_ofs1;
+    std::vector<uint16_t> x_weight;
+    // 目标行 y 对应的两个源行及下方行权重
+    std::vector<int> y_row0, y_row1;
+    std::vector<uint16_t> y_weight;
+    // 水平插值后的两行（RGB 顺序，定点），row_index 记录其对应的源行
+    std::vector<uint16_t> rows[2];
+    int row_index[2];
+
+    letterbox_cache() : src_width(0), src_height(0), dst(nullptr), dst_width(0), dst_height(0), dst_stride(0), bg_color(0) {}
+};
+
+/**
+ * @brief BGR888 源图一次完成 BGR→RGB、双线性缩放与 letterbox 留边，直接写入模型输入缓冲区（RGB888, NHWC）
+ *        缩放与留边参数同 convert_image_with_letterbox；边框只在源图尺寸或目标缓冲区变化时重写
+ * @param cache 几何参数缓存（每个上下文一个）
+ * @param src 源图数据（如 cv::Mat::data）
+ * @param src_width 源图宽度
+ * @param src_height 源图高度
+ * @param src_stride 源图每行字节数
+ * @param dst 模型输入缓冲区
+ * @param dst_width 模型输入宽度
+ * @param dst_height 模型输入高度
+ * @param dst_stride 模型输入每行字节数
+ * @param bg_color 边框颜色
+ * @param letter_box 输出：缩放比例与留边，供后处理还原坐标
+ * @return 0 成功，-1 参数错误
+ */
+int letterbox_bgr_to_rgb(letterbox_cache &cache, const unsigned char *src, int src_width, int src_height, int src_stride,
+                         unsigned char *dst, int dst_width, int dst_height, int dst_stride, int bg_color,
+                         letterbox_t *letter_box);
+
+/**
+ * @brief 任意格式的源图（image_buffer_t，如读入的图片文件）letterbox 到模型输入缓冲区（RGB888, NHWC, 行紧密排列）
+ *        几何参数与边框同样按 cache 缓存，内容由 convert_image 完成格式转换与缩放；
+ *        与 letterbox_bgr_to_rgb 写出的边框相同，同一缓冲区的两种输入可共用一个 cache
+ * @param cache 几何参数缓存（每个输入缓冲区一个）
+ * @param src 源图
+ * @param dst 模型输入缓冲区
+ * @param dst_width 模型输入宽度
+ * @param dst_height 模型输入高度
+ * @param bg_color 边框颜色
+ * @param letter_box 输出：缩放比例与留边，供后处理还原坐标
+ * @return 0 成功，<0 失败
+ */
+int letterbox_image_to_rgb(letterbox_cache &cache, image_buffer_t *src, unsigned char *dst, int dst_width,
+                           int dst_height, int bg_color, letterbox_t *letter_box);
+
+#endif //_RKNN_YOLOV8_DEMO_PREPROCESS_H_
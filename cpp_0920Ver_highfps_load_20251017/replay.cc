@@ -0,0 +1,127 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <algorithm>
+#include <chrono>
+#include <vector>
+#include <opencv2/opencv.hpp>
+
+#include "tensor_capture.h"
+#include "tracker_wrapper.h"
+
+// 回放 tensor_capture 录制的原始输出张量：post_process + 跟踪全速运行，不需要 NPU 与模型文件
+// 结果文件逐帧记录检测与跟踪结果（浮点按 %a 精确输出），不同版本的回放结果可直接 diff 做逐位比较
+
+// FNV-1a：对全部帧的检测与跟踪结果求摘要，一行即可比较两个版本的输出是否完全一致
+static void hash_bytes(uint64_t& h, const void* data, size_t size) {
+    const unsigned char* p = (const unsigned char*)data;
+    for (size_t i = 0; i < size; ++i) {
+        h = (h ^ p[i]) * 1099511628211ull;
+    }
+}
+
+static void print_stage(const char* name, std::vector<double>& us) {
+    if (us.empty()) {
+        return;
+    }
+    double sum = 0;
+    for (double v : us) {
+        sum += v;
+    }
+    std::sort(us.begin(), us.end());
+    printf("[replay] %-12s avg %8.1fus | p50 %8.1fus | p99 %8.1fus | max %8.1fus\n", name, sum / us.size(),
+           us[us.size() / 2], us[(us.size() * 99) / 100], us.back());
+}
+
+int main(int argc, char** argv) {
+    if (argc != 2 && argc != 3) {
+        fprintf(stderr, "用法: %s <张量录制文件> [结果文件]\n", argv[0]);
+        return -1;
+    }
+
+    rknn_app_context_t app_ctx;
+    memset(&app_ctx, 0, sizeof(rknn_app_context_t));
+    tensor_replay* replay = tensor_replay_open(argv[1], &app_ctx);
+    if (replay == nullptr) {
+        return -1;
+    }
+    FILE* result_fp = nullptr;
+    if (argc == 3) {
+        result_fp = fopen(argv[2], "w");
+        if (result_fp == nullptr) {
+            fprintf(stderr, "无法写入结果文件: %s\n", argv[2]);
+            tensor_replay_close(replay, &app_ctx);
+            return -1;
+        }
+    }
+    TrackerWrapper tracker;
+    tracker.Init();
+
+    std::vector<double> post_process_us;
+    std::vector<double> tracker_us;
+    std::vector<TrackResult> tracks;
+    object_detect_result_list od_results;
+    uint64_t digest = 14695981039346656037ull;
+    int frames = 0;
+    int detections = 0;
+    int ret;
+    void* outputs = nullptr;
+    letterbox_t letter_box;
+    int src_width = 0;
+    int src_height = 0;
+    // 读取与解码录制数据不计入耗时
+    while ((ret = tensor_replay_next(replay, &outputs, &letter_box, &src_width, &src_height)) > 0) {
+        auto t0 = std::chrono::steady_clock::now();
+        post_process(&app_ctx, outputs, &letter_box, BOX_THRESH, NMS_THRESH, &od_results);
+        auto t1 = std::chrono::steady_clock::now();
+        tracker.Update(od_results, cv::Size(src_width, src_height));
+        tracker.GetTrackResults(tracks);
+        auto t2 = std::chrono::steady_clock::now();
+        post_process_us.push_back(std::chrono::duration<double, std::micro>(t1 - t0).count());
+        tracker_us.push_back(std::chrono::duration<double, std::micro>(t2 - t1).count());
+
+        if (result_fp != nullptr) {
+            fprintf(result_fp, "frame %d src %dx%d det %d track %d\n", frames, src_width, src_height, od_results.count,
+                    (int)tracks.size());
+        }
+        for (int i = 0; i < od_results.count; ++i) {
+            const object_detect_result& det = od_results.results[i];
+            hash_bytes(digest, &det.cls_id, sizeof(det.cls_id));
+            hash_bytes(digest, &det.prop, sizeof(det.prop));
+            hash_bytes(digest, &det.box, sizeof(det.box));
+            if (result_fp != nullptr) {
+                fprintf(result_fp, "  det cls %d prop %a box %d %d %d %d\n", det.cls_id, det.prop, det.box.left,
+                        det.box.top, det.box.right, det.box.bottom);
+            }
+        }
+        for (const TrackResult& track : tracks) {
+            int fields[6] = {track.track_id, track.cls_id, track.bbox.x, track.bbox.y, track.bbox.width,
+                             track.bbox.height};
+            hash_bytes(digest, fields, sizeof(fields));
+            if (result_fp != nullptr) {
+                fprintf(result_fp, "  track id %d cls %d box %d %d %d %d\n", fields[0], fields[1], fields[2],
+                        fields[3], fields[4], fields[5]);
+            }
+        }
+        detections += od_results.count;
+        frames++;
+    }
+
+    double total_us = 0;
+    for (size_t i = 0; i < post_process_us.size(); ++i) {
+        total_us += post_process_us[i] + tracker_us[i];
+    }
+    printf("[replay] %d frames, %d detections, %s\n", frames, detections, ret < 0 ? "file corrupted, stopped early" : "EOF");
+    print_stage("post_process", post_process_us);
+    print_stage("tracker", tracker_us);
+    if (total_us > 0) {
+        printf("[replay] post_process + tracker: %.1f fps\n", frames * 1e6 / total_us);
+    }
+    printf("[replay] digest %016llx\n", (unsigned long long)digest);
+
+    if (result_fp != nullptr) {
+        fclose(result_fp);
+    }
+    tensor_replay_close(replay, &app_ctx);
+    return ret < 0 ? -1 : 0;
+}
@@ -21,6 +21,9 @@
 #include "common.h"
 #include "file_utils.h"
 #include "image_utils.h"
+#include "preprocess.h"
+#include "logger.h"
+#include "tensor_capture.h"
 
 static void dump_tensor_attr(rknn_tensor_attr *attr)
 {
@@ -132,9 +135,54 @@ int init_yolov8_model(const char *model_path, rknn_app_context_t *app_ctx)
     printf("model input height=%d, width=%d, channel=%d\n",
            app_ctx->model_height, app_ctx->model_width, app_ctx->model_channel);
 
+    ret = init_post_process_ctx(app_ctx);
+    if (ret < 0)
+    {
+        printf("init_post_process_ctx fail! ret=%d\n", ret);
+        return -1;
+    }
+
+    // BGR 帧预处理的目标缓冲区
+    app_ctx->input_buf = (unsigned char *)malloc(app_ctx->model_width * app_ctx->model_height * 3);
+    if (app_ctx->input_buf == NULL)
+    {
+        printf("malloc input buffer fail!\n");
+        return -1;
+    }
+    app_ctx->input_cache = new letterbox_cache();
+
+    // 预分配输出缓冲区，推理结果保留到下一次推理（run_yolov8_model_bgr 之后由调用方后处理）
+    if (app_ctx->io_num.n_output > (int)(sizeof(app_ctx->outputs) / sizeof(app_ctx->outputs[0])))
+    {
+        printf("too many outputs: %d\n", app_ctx->io_num.n_output);
+        return -1;
+    }
+    memset(app_ctx->outputs, 0, sizeof(app_ctx->outputs));
+    for (int i = 0; i < app_ctx->io_num.n_output; i++)
+    {
+        rknn_output *output = &app_ctx->outputs[i];
+        output->index = i;
+        output->want_float = (!app_ctx->is_quant);
+        output->is_prealloc = 1;
+        output->size = output->want_float ? app_ctx->output_attrs[i].n_elems * sizeof(float) : app_ctx->output_attrs[i].size;
+        output->buf = malloc(output->size);
+        if (output->buf == NULL)
+        {
+            printf("malloc output buffer size:%d fail!\n", output->size);
+            return -1;
+        }
+    }
+
     return 0;
 }
 
+int dup_yolov8_model(rknn_app_context_t *src_ctx, rknn_app_context_t *app_ctx)
+{
+    // RKNPU1 运行时没有 rknn_dup_context，由调用方改用 init_yolov8_model
+    printf("dup_yolov8_model not supported on RKNPU1\n");
+    return -1;
+}
+
 int release_yolov8_model(rknn_app_context_t *app_ctx)
 {
     if (app_ctx->input_attrs != NULL)
@@ -147,6 +195,25 @@ int release_yolov8_model(rknn_app_context_t *app_ctx)
         free(app_ctx->output_attrs);
         app_ctx->output_attrs = NULL;
     }
+    if (app_ctx->input_buf != NULL)
+    {
+        free(app_ctx->input_buf);
+        app_ctx->input_buf = NULL;
+    }
+    if (app_ctx->input_cache != NULL)
+    {
+        delete app_ctx->input_cache;
+        app_ctx->input_cache = NULL;
+    }
+    for (int i = 0; i < (int)(sizeof(app_ctx->outputs) / sizeof(app_ctx->outputs[0])); i++)
+    {
+        if (app_ctx->outputs[i].buf != NULL)
+        {
+            free(app_ctx->outputs[i].buf);
+            app_ctx->outputs[i].buf = NULL;
+        }
+    }
+    deinit_post_process_ctx(app_ctx);
     if (app_ctx->rknn_ctx != 0)
     {
         rknn_destroy(app_ctx->rknn_ctx);
@@ -155,15 +222,56 @@ int release_yolov8_model(rknn_app_context_t *app_ctx)
     return 0;
 }
 
+/**
+ * 输入已完成预处理后：设置输入、推理并取输出到预分配的缓冲区
+ */
+static int run_model(rknn_app_context_t *app_ctx, unsigned char *input)
+{
+    int ret;
+    rknn_input inputs[app_ctx->io_num.n_input];
+
+    memset(inputs, 0, sizeof(inputs));
+
+    // Set Input Data
+    inputs[0].index = 0;
+    inputs[0].type = RKNN_TENSOR_UINT8;
+    inputs[0].fmt = RKNN_TENSOR_NHWC;
+    inputs[0].size = app_ctx->model_width * app_ctx->model_height * app_ctx->model_channel;
+    inputs[0].buf = input;
+
+    ret = rknn_inputs_set(app_ctx->rknn_ctx, app_ctx->io_num.n_input, inputs);
+    if (ret < 0)
+    {
+        printf("rknn_input_set fail! ret=%d\n", ret);
+        return -1;
+    }
+
+    // Run
+    LOG_DEBUG("rknn_run");
+    ret = rknn_run(app_ctx->rknn_ctx, nullptr);
+    if (ret < 0)
+    {
+        printf("rknn_run fail! ret=%d\n", ret);
+        return -1;
+    }
+
+    // Get Output：数据已写入预分配缓冲区，随即释放运行时的输出句柄
+    ret = rknn_outputs_get(app_ctx->rknn_ctx, app_ctx->io_num.n_output, app_ctx->outputs, NULL);
+    if (ret < 0)
+    {
+        printf("rknn_outputs_get fail! ret=%d\n", ret);
+        return ret;
+    }
+    rknn_outputs_release(app_ctx->rknn_ctx, app_ctx->io_num.n_output, app_ctx->outputs);
+
+    return ret;
+}
+
 int inference_yolov8_model(rknn_app_context_t *app_ctx, image_buffer_t *img, object_detect_result_list *od_results)
 {
     int ret;
     image_buffer_t dst_img;
     letterbox_t letter_box;
-    rknn_input inputs[app_ctx->io_num.n_input];
-    rknn_output outputs[app_ctx->io_num.n_output];
-    const float nms_threshold = NMS_THRESH;      // Default NMS threshold
-    const float box_conf_threshold = BOX_THRESH; // Default box threshold
     int bg_color = 114;
 
     if ((!app_ctx) || !(img) || (!od_results))
@@ -174,8 +282,6 @@ int inference_yolov8_model(rknn_app_context_t *app_ctx, image_buffer_t *img, obj
     memset(od_results, 0x00, sizeof(*od_results));
     memset(&letter_box, 0, sizeof(letterbox_t));
     memset(&dst_img, 0, sizeof(image_buffer_t));
-    memset(inputs, 0, sizeof(inputs));
-    memset(outputs, 0, sizeof(outputs));
 
     // Pre Process
     dst_img.width = app_ctx->model_width;
@@ -194,57 +300,73 @@ int inference_yolov8_model(rknn_app_context_t *app_ctx, image_buffer_t *img, obj
     if (ret < 0)
     {
         printf("convert_image_with_letterbox fail! ret=%d\n", ret);
-        return -1;
+    }
+    else
+    {
+        ret = run_model(app_ctx, dst_img.virt_addr);
+        if (ret >= 0)
+        {
+            tensor_capture_frame(app_ctx, app_ctx->outputs, &letter_box, img->width, img->height);
+            // Post Process
+            ret = post_process(app_ctx, app_ctx->outputs, &letter_box, BOX_THRESH, NMS_THRESH, od_results);
+        }
     }
 
-    // Set Input Data
-    inputs[0].index = 0;
-    inputs[0].type = RKNN_TENSOR_UINT8;
-    inputs[0].fmt = RKNN_TENSOR_NHWC;
-    inputs[0].size = app_ctx->model_width * app_ctx->model_height * app_ctx->model_channel;
-    inputs[0].buf = dst_img.virt_addr;
+    free(dst_img.virt_addr);
+    return ret;
+}
 
-    ret = rknn_inputs_set(app_ctx->rknn_ctx, app_ctx->io_num.n_input, inputs);
-    if (ret < 0)
+int run_yolov8_model_bgr(rknn_app_context_t *app_ctx, const unsigned char *bgr, int width, int height, int stride,
+                         letterbox_t *letter_box)
+{
+    int ret;
+    int bg_color = 114;
+
+    if ((!app_ctx) || !(bgr) || (!letter_box))
     {
-        printf("rknn_input_set fail! ret=%d\n", ret);
         return -1;
     }
 
-    // Run
-    printf("rknn_run\n");
-    ret = rknn_run(app_ctx->rknn_ctx, nullptr);
+    memset(letter_box, 0, sizeof(letterbox_t));
+
+    // Pre Process：BGR→RGB、缩放与 letterbox 一次写入 input_buf
+    ret = letterbox_bgr_to_rgb(*app_ctx->input_cache, bgr, width, height, stride, app_ctx->input_buf,
+                               app_ctx->model_width, app_ctx->model_height, app_ctx->model_width * 3, bg_color,
+                               letter_box);
     if (ret < 0)
     {
-        printf("rknn_run fail! ret=%d\n", ret);
+        printf("letterbox_bgr_to_rgb fail! ret=%d\n", ret);
         return -1;
     }
 
-    // Get Output
-    memset(outputs, 0, sizeof(outputs));
-    for (int i = 0; i < app_ctx->io_num.n_output; i++)
-    {
-        outputs[i].index = i;
-        outputs[i].want_float = (!app_ctx->is_quant);
-    }
-    ret = rknn_outputs_get(app_ctx->rknn_ctx, app_ctx->io_num.n_output, outputs, NULL);
-    if (ret < 0)
+    return run_model(app_ctx, app_ctx->input_buf);
+}
+
+void *yolov8_model_outputs(rknn_app_context_t *app_ctx)
+{
+    return app_ctx->outputs;
+}
+
+int inference_yolov8_model_bgr(rknn_app_context_t *app_ctx, const unsigned char *bgr, int width, int height, int stride,
+                               object_detect_result_list *od_results)
+{
+    int ret;
+    letterbox_t letter_box;
+
+    if ((!app_ctx) || !(bgr) || (!od_results))
     {
-        printf("rknn_outputs_get fail! ret=%d\n", ret);
-        goto out;
+        return -1;
     }
 
-    // Post Process
-    post_process(app_ctx, outputs, &letter_box, box_conf_threshold, nms_threshold, od_results);
-
-    // Remeber to release rknn output
-    rknn_outputs_release(app_ctx->rknn_ctx, app_ctx->io_num.n_output, outputs);
+    memset(od_results, 0x00, sizeof(*od_results));
 
-out:
-    if (dst_img.virt_addr != NULL)
+    ret = run_yolov8_model_bgr(app_ctx, bgr, width, height, stride, &letter_box);
+    if (ret < 0)
     {
-        free(dst_img.virt_addr);
+        return ret;
     }
 
-    return ret;
-}
\ No newline at end of file
+    tensor_capture_frame(app_ctx, yolov8_model_outputs(app_ctx), &letter_box, width, height);
+    // Post Process
+    return post_process(app_ctx, yolov8_model_outputs(app_ctx), &letter_box, BOX_THRESH, NMS_THRESH, od_results);
+}
@@ -7,6 +7,9 @@
 #include "common.h"
 #include "file_utils.h"
 #include "image_utils.h"
+#include "preprocess.h"
+#include "logger.h"
+#include "tensor_capture.h"
 
 static void dump_tensor_attr(rknn_tensor_attr *attr)
 {
@@ -17,6 +20,60 @@ static void dump_tensor_attr(rknn_tensor_attr *attr)
            get_qnt_type_string(attr->qnt_type), attr->zp, attr->scale);
 }
 
+/**
+ * 单帧模型输入的字节数（RGB888, NHWC）
+ */
+static inline size_t frame_input_size(const rknn_app_context_t *app_ctx)
+{
+    return (size_t)app_ctx->model_width * app_ctx->model_height * app_ctx->model_channel;
+}
+
+/**
+ * 预分配输入输出缓冲区，推理时不再逐帧申请
+ * batch>1 的模型输入缓冲区按整批分配，单帧推理只写第一个位置
+ */
+static int init_io_buffers(rknn_app_context_t *app_ctx)
+{
+    int n_output = app_ctx->io_num.n_output;
+    if (n_output > (int)(sizeof(app_ctx->outputs) / sizeof(app_ctx->outputs[0])))
+    {
+        printf("too many outputs: %d\n", n_output);
+        return -1;
+    }
+    const rknn_tensor_attr *input_attr = &app_ctx->input_attrs[0];
+    app_ctx->batch = (input_attr->n_dims == 4 && input_attr->dims[0] > 1) ? input_attr->dims[0] : 1;
+    if (app_ctx->batch > 1)
+    {
+        printf("model input batch=%d\n", app_ctx->batch);
+    }
+    app_ctx->input_buf = (unsigned char *)calloc(app_ctx->batch, frame_input_size(app_ctx));
+    if (app_ctx->input_buf == NULL)
+    {
+        printf("malloc input buffer fail!\n");
+        return -1;
+    }
+    app_ctx->input_cache = new letterbox_cache();
+
+    memset(app_ctx->outputs, 0, sizeof(app_ctx->outputs));
+    for (int i = 0; i < n_output; i++)
+    {
+        const rknn_tensor_attr *attr = &app_ctx->output_attrs[i];
+        rknn_output *output = &app_ctx->outputs[i];
+        output->index = i;
+        // fp16 输出由后处理直接解码，不让运行时在 CPU 上转换成 float
+        output->want_float = (!app_ctx->is_quant && attr->type != RKNN_TENSOR_FLOAT16);
+        output->is_prealloc = 1;
+        output->size = output->want_float ? attr->n_elems * sizeof(float) : attr->size;
+        output->buf = malloc(output->size);
+        if (output->buf == NULL)
+        {
+            printf("malloc output buffer size:%d fail!\n", output->size);
+            return -1;
+        }
+    }
+    return 0;
+}
+
 int init_yolov8_model(const char *model_path, rknn_app_context_t *app_ctx)
 {
     int ret;
@@ -118,21 +175,99 @@ int init_yolov8_model(const char *model_path, rknn_app_context_t *app_ctx)
     printf("model input height=%d, width=%d, channel=%d\n",
            app_ctx->model_height, app_ctx->model_width, app_ctx->model_channel);
 
-    return 0;
+    ret = init_post_process_ctx(app_ctx);
+    if (ret < 0)
+    {
+        printf("init_post_process_ctx fail! ret=%d\n", ret);
+        return -1;
+    }
+
+    return init_io_buffers(app_ctx);
+}
+
+int dup_yolov8_model(rknn_app_context_t *src_ctx, rknn_app_context_t *app_ctx)
+{
+    rknn_context ctx = 0;
+    int ret = rknn_dup_context(&src_ctx->rknn_ctx, &ctx);
+    if (ret < 0)
+    {
+        printf("rknn_dup_context fail! ret=%d\n", ret);
+        return -1;
+    }
+    app_ctx->rknn_ctx = ctx;
+
+    // 属性表与模型参数沿用源上下文
+    app_ctx->io_num = src_ctx->io_num;
+    app_ctx->input_attrs = src_ctx->input_attrs;
+    app_ctx->output_attrs = src_ctx->output_attrs;
+    app_ctx->shared_attrs = true;
+    app_ctx->is_quant = src_ctx->is_quant;
+    app_ctx->model_channel = src_ctx->model_channel;
+    app_ctx->model_height = src_ctx->model_height;
+    app_ctx->model_width = src_ctx->model_width;
+
+    ret = init_post_process_ctx(app_ctx);
+    if (ret < 0)
+    {
+        printf("init_post_process_ctx fail! ret=%d\n", ret);
+        return -1;
+    }
+
+    return init_io_buffers(app_ctx);
 }
 
 int release_yolov8_model(rknn_app_context_t *app_ctx)
 {
     if (app_ctx->input_attrs != NULL)
     {
-        free(app_ctx->input_attrs);
+        if (!app_ctx->shared_attrs)
+        {
+            free(app_ctx->input_attrs);
+        }
         app_ctx->input_attrs = NULL;
     }
     if (app_ctx->output_attrs != NULL)
     {
-        free(app_ctx->output_attrs);
+        if (!app_ctx->shared_attrs)
+        {
+            free(app_ctx->output_attrs);
+        }
         app_ctx->output_attrs = NULL;
     }
+    if (app_ctx->input_buf != NULL)
+    {
+        free(app_ctx->input_buf);
+        app_ctx->input_buf = NULL;
+    }
+    if (app_ctx->input_cache != NULL)
+    {
+        delete app_ctx->input_cache;
+        app_ctx->input_cache = NULL;
+    }
+    if (app_ctx->pipeline_input_buf != NULL)
+    {
+        free(app_ctx->pipeline_input_buf);
+        app_ctx->pipeline_input_buf = NULL;
+    }
+    if (app_ctx->pipeline_input_cache != NULL)
+    {
+        delete app_ctx->pipeline_input_cache;
+        app_ctx->pipeline_input_cache = NULL;
+    }
+    if (app_ctx->batch_input_caches != NULL)
+    {
+        delete[] app_ctx->batch_input_caches;
+        app_ctx->batch_input_caches = NULL;
+    }
+    for (int i = 0; i < (int)(sizeof(app_ctx->outputs) / sizeof(app_ctx->outputs[0])); i++)
+    {
+        if (app_ctx->outputs[i].buf != NULL)
+        {
+            free(app_ctx->outputs[i].buf);
+            app_ctx->outputs[i].buf = NULL;
+        }
+    }
+    deinit_post_process_ctx(app_ctx);
     if (app_ctx->rknn_ctx != 0)
     {
         rknn_destroy(app_ctx->rknn_ctx);
@@ -141,15 +276,72 @@ int release_yolov8_model(rknn_app_context_t *app_ctx)
     return 0;
 }
 
+static int set_input(rknn_app_context_t *app_ctx, unsigned char *buf)
+{
+    rknn_input inputs[app_ctx->io_num.n_input];
+    memset(inputs, 0, sizeof(inputs));
+
+    inputs[0].index = 0;
+    inputs[0].type = RKNN_TENSOR_UINT8;
+    inputs[0].fmt = RKNN_TENSOR_NHWC;
+    inputs[0].size = app_ctx->batch * frame_input_size(app_ctx);
+    inputs[0].buf = buf;
+
+    int ret = rknn_inputs_set(app_ctx->rknn_ctx, app_ctx->io_num.n_input, inputs);
+    if (ret < 0)
+    {
+        printf("rknn_input_set fail! ret=%d\n", ret);
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * 取输出到 init 时预分配的缓冲区；数据已在预分配缓冲区中，随即释放运行时的输出句柄
+ */
+static int fetch_outputs(rknn_app_context_t *app_ctx)
+{
+    int ret = rknn_outputs_get(app_ctx->rknn_ctx, app_ctx->io_num.n_output, app_ctx->outputs, NULL);
+    if (ret < 0)
+    {
+        printf("rknn_outputs_get fail! ret=%d\n", ret);
+        return ret;
+    }
+    rknn_outputs_release(app_ctx->rknn_ctx, app_ctx->io_num.n_output, app_ctx->outputs);
+    return ret;
+}
+
+/**
+ * 输入已写入 input_buf 后：设置输入、推理并取输出到预分配的缓冲区
+ */
+static int run_model(rknn_app_context_t *app_ctx)
+{
+    int ret;
+
+    // Set Input Data
+    ret = set_input(app_ctx, app_ctx->input_buf);
+    if (ret < 0)
+    {
+        return -1;
+    }
+
+    // Run
+    LOG_DEBUG("rknn_run");
+    ret = rknn_run(app_ctx->rknn_ctx, nullptr);
+    if (ret < 0)
+    {
+        printf("rknn_run fail! ret=%d\n", ret);
+        return -1;
+    }
+
+    // Get Output
+    return fetch_outputs(app_ctx);
+}
+
 int inference_yolov8_model(rknn_app_context_t *app_ctx, image_buffer_t *img, object_detect_result_list *od_results)
 {
     int ret;
-    image_buffer_t dst_img;
     letterbox_t letter_box;
-    rknn_input inputs[app_ctx->io_num.n_input];
-    rknn_output outputs[app_ctx->io_num.n_output];
-    const float nms_threshold = NMS_THRESH;      // 默认的NMS阈值
-    const float box_conf_threshold = BOX_THRESH; // 默认的置信度阈值
     int bg_color = 114;
 
     if ((!app_ctx) || !(img) || (!od_results))
@@ -159,78 +351,241 @@ int inference_yolov8_model(rknn_app_context_t *app_ctx, image_buffer_t *img, obj
 
     memset(od_results, 0x00, sizeof(*od_results));
     memset(&letter_box, 0, sizeof(letterbox_t));
-    memset(&dst_img, 0, sizeof(image_buffer_t));
-    memset(inputs, 0, sizeof(inputs));
-    memset(outputs, 0, sizeof(outputs));
 
-    // Pre Process
-    dst_img.width = app_ctx->model_width;
-    dst_img.height = app_ctx->model_height;
-    dst_img.format = IMAGE_FORMAT_RGB888;
-    dst_img.size = get_image_size(&dst_img);
-    dst_img.virt_addr = (unsigned char *)malloc(dst_img.size);
-    if (dst_img.virt_addr == NULL)
+    // Pre Process：letterbox 到预分配的输入缓冲区，与 BGR 帧路径共用 input_cache
+    ret = letterbox_image_to_rgb(*app_ctx->input_cache, img, app_ctx->input_buf, app_ctx->model_width,
+                                 app_ctx->model_height, bg_color, &letter_box);
+    if (ret < 0)
+    {
+        printf("letterbox fail! ret=%d\n", ret);
+        return -1;
+    }
+
+    ret = run_model(app_ctx);
+    if (ret < 0)
+    {
+        return ret;
+    }
+
+    tensor_capture_frame(app_ctx, app_ctx->outputs, &letter_box, img->width, img->height);
+    // Post Process
+    return post_process(app_ctx, app_ctx->outputs, &letter_box, BOX_THRESH, NMS_THRESH, od_results);
+}
+
+int run_yolov8_model_bgr(rknn_app_context_t *app_ctx, const unsigned char *bgr, int width, int height, int stride,
+                         letterbox_t *letter_box)
+{
+    int ret;
+    int bg_color = 114;
+
+    if ((!app_ctx) || !(bgr) || (!letter_box))
     {
-        printf("malloc buffer size:%d fail!\n", dst_img.size);
         return -1;
     }
 
-    // letterbox
-    ret = convert_image_with_letterbox(img, &dst_img, &letter_box, bg_color);
+    memset(letter_box, 0, sizeof(letterbox_t));
+
+    // Pre Process：BGR→RGB、缩放与 letterbox 一次写入 input_buf
+    ret = letterbox_bgr_to_rgb(*app_ctx->input_cache, bgr, width, height, stride, app_ctx->input_buf,
+                               app_ctx->model_width, app_ctx->model_height, app_ctx->model_width * 3, bg_color,
+                               letter_box);
     if (ret < 0)
     {
-        printf("convert_image_with_letterbox fail! ret=%d\n", ret);
+        printf("letterbox_bgr_to_rgb fail! ret=%d\n", ret);
         return -1;
     }
 
-    // Set Input Data
-    inputs[0].index = 0;
-    inputs[0].type = RKNN_TENSOR_UINT8;
-    inputs[0].fmt = RKNN_TENSOR_NHWC;
-    inputs[0].size = app_ctx->model_width * app_ctx->model_height * app_ctx->model_channel;
-    inputs[0].buf = dst_img.virt_addr;
+    return run_model(app_ctx);
+}
+
+void *yolov8_model_outputs(rknn_app_context_t *app_ctx)
+{
+    return app_ctx->outputs;
+}
+
+int inference_yolov8_model_bgr(rknn_app_context_t *app_ctx, const unsigned char *bgr, int width, int height, int stride,
+                               object_detect_result_list *od_results)
+{
+    int ret;
+    letterbox_t letter_box;
+
+    if ((!app_ctx) || !(bgr) || (!od_results))
+    {
+        return -1;
+    }
 
-    ret = rknn_inputs_set(app_ctx->rknn_ctx, app_ctx->io_num.n_input, inputs);
+    memset(od_results, 0x00, sizeof(*od_results));
+
+    ret = run_yolov8_model_bgr(app_ctx, bgr, width, height, stride, &letter_box);
     if (ret < 0)
     {
-        printf("rknn_input_set fail! ret=%d\n", ret);
+        return ret;
+    }
+
+    tensor_capture_frame(app_ctx, yolov8_model_outputs(app_ctx), &letter_box, width, height);
+    // Post Process
+    return post_process(app_ctx, yolov8_model_outputs(app_ctx), &letter_box, BOX_THRESH, NMS_THRESH, od_results);
+}
+
+/**
+ * 取输入槽 slot 的缓冲区及其第一个位置的 letterbox 几何缓存
+ * 第二个输入槽只在流水线模式下使用，首次使用时分配；槽 0 即单帧推理的 input_buf 与 input_cache
+ */
+static int get_input_slot(rknn_app_context_t *app_ctx, int slot, unsigned char **buf, letterbox_cache **cache)
+{
+    if (slot == 0)
+    {
+        *buf = app_ctx->input_buf;
+        *cache = app_ctx->input_cache;
+        return 0;
+    }
+    if (app_ctx->pipeline_input_buf == NULL)
+    {
+        app_ctx->pipeline_input_buf = (unsigned char *)calloc(app_ctx->batch, frame_input_size(app_ctx));
+        if (app_ctx->pipeline_input_buf == NULL)
+        {
+            printf("malloc pipeline input buffer fail!\n");
+            return -1;
+        }
+        app_ctx->pipeline_input_cache = new letterbox_cache();
+    }
+    *buf = app_ctx->pipeline_input_buf;
+    *cache = app_ctx->pipeline_input_cache;
+    return 0;
+}
+
+int prepare_yolov8_input_bgr(rknn_app_context_t *app_ctx, int slot, const unsigned char *bgr, int width, int height,
+                             int stride, letterbox_t *letter_box)
+{
+    unsigned char *buf;
+    letterbox_cache *cache;
+    if (get_input_slot(app_ctx, slot, &buf, &cache) != 0)
+    {
         return -1;
     }
 
-    // Run
-    printf("rknn_run\n");
-    ret = rknn_run(app_ctx->rknn_ctx, nullptr);
+    int ret = letterbox_bgr_to_rgb(*cache, bgr, width, height, stride, buf, app_ctx->model_width,
+                                   app_ctx->model_height, app_ctx->model_width * 3, 114, letter_box);
     if (ret < 0)
     {
-        printf("rknn_run fail! ret=%d\n", ret);
+        printf("letterbox_bgr_to_rgb fail! ret=%d\n", ret);
         return -1;
     }
+    return 0;
+}
 
-    // Get Output
-    memset(outputs, 0, sizeof(outputs));
-    for (int i = 0; i < app_ctx->io_num.n_output; i++)
+int run_yolov8_model_async(rknn_app_context_t *app_ctx, int slot)
+{
+    // rknn_inputs_set 把数据拷入运行时的输入内存，必须在上一帧 rknn_wait 之后调用
+    int ret = set_input(app_ctx, slot != 0 ? app_ctx->pipeline_input_buf : app_ctx->input_buf);
+    if (ret < 0)
     {
-        outputs[i].index = i;
-        outputs[i].want_float = (!app_ctx->is_quant);
+        return -1;
     }
-    ret = rknn_outputs_get(app_ctx->rknn_ctx, app_ctx->io_num.n_output, outputs, NULL);
+
+    app_ctx->run_extend.frame_id++;
+    app_ctx->run_extend.non_block = 1;
+    app_ctx->run_extend.timeout_ms = 0;
+    app_ctx->run_extend.fence_fd = -1;
+    ret = rknn_run(app_ctx->rknn_ctx, &app_ctx->run_extend);
     if (ret < 0)
     {
-        printf("rknn_outputs_get fail! ret=%d\n", ret);
-        goto out;
+        printf("rknn_run (non block) fail! ret=%d\n", ret);
+        return -1;
     }
+    return 0;
+}
 
-    // Post Process
-    post_process(app_ctx, outputs, &letter_box, box_conf_threshold, nms_threshold, od_results);
+int wait_yolov8_model_outputs(rknn_app_context_t *app_ctx)
+{
+    int ret = rknn_wait(app_ctx->rknn_ctx, &app_ctx->run_extend);
+    if (ret < 0)
+    {
+        printf("rknn_wait fail! ret=%d\n", ret);
+        return -1;
+    }
+    return fetch_outputs(app_ctx);
+}
 
-    // Remeber to release rknn output
-    rknn_outputs_release(app_ctx->rknn_ctx, app_ctx->io_num.n_output, outputs);
+int decode_yolov8_model_outputs(rknn_app_context_t *app_ctx, letterbox_t *letter_box, object_detect_result_list *od_results)
+{
+    memset(od_results, 0x00, sizeof(*od_results));
+    return post_process(app_ctx, app_ctx->outputs, letter_box, BOX_THRESH, NMS_THRESH, od_results);
+}
 
-out:
-    if (dst_img.virt_addr != NULL)
+int prepare_yolov8_batch_input_bgr(rknn_app_context_t *app_ctx, int slot, int index, const unsigned char *bgr,
+                                   int width, int height, int stride, letterbox_t *letter_box)
+{
+    if (index < 0 || index >= app_ctx->batch)
+    {
+        printf("batch index %d out of range (batch %d)\n", index, app_ctx->batch);
+        return -1;
+    }
+    // 位置 0 即单帧输入，沿用槽的几何缓存；其余位置的输入地址不同，几何缓存各用一个，首次使用时创建
+    unsigned char *buf;
+    letterbox_cache *cache;
+    if (get_input_slot(app_ctx, slot, &buf, &cache) != 0)
     {
-        free(dst_img.virt_addr);
+        return -1;
+    }
+    if (index > 0)
+    {
+        if (app_ctx->batch_input_caches == NULL)
+        {
+            app_ctx->batch_input_caches = new letterbox_cache[2 * (app_ctx->batch - 1)];
+        }
+        cache = &app_ctx->batch_input_caches[(slot != 0 ? app_ctx->batch - 1 : 0) + index - 1];
     }
 
-    return ret;
-}
\ No newline at end of file
+    buf += (size_t)index * frame_input_size(app_ctx);
+    int ret = letterbox_bgr_to_rgb(*cache, bgr, width, height, stride, buf,
+                                   app_ctx->model_width, app_ctx->model_height, app_ctx->model_width * 3, 114,
+                                   letter_box);
+    if (ret < 0)
+    {
+        printf("letterbox_bgr_to_rgb fail! ret=%d\n", ret);
+        return -1;
+    }
+    return 0;
+}
+
+int decode_yolov8_batch_outputs(rknn_app_context_t *app_ctx, int index, letterbox_t *letter_box, int src_width,
+                                int src_height, object_detect_result_list *od_results)
+{
+    memset(od_results, 0x00, sizeof(*od_results));
+    if (index < 0 || index >= app_ctx->batch)
+    {
+        return -1;
+    }
+
+    // 输出的 batch 维在最外层：第 index 帧为每个输出中连续的 1/batch，按单帧输出交给 post_process
+    rknn_output outputs[sizeof(app_ctx->outputs) / sizeof(app_ctx->outputs[0])];
+    for (int i = 0; i < app_ctx->io_num.n_output; i++)
+    {
+        outputs[i] = app_ctx->outputs[i];
+        outputs[i].size = app_ctx->outputs[i].size / app_ctx->batch;
+        outputs[i].buf = (unsigned char *)app_ctx->outputs[i].buf + (size_t)index * outputs[i].size;
+    }
+
+    tensor_capture_frame(app_ctx, outputs, letter_box, src_width, src_height);
+    return post_process(app_ctx, outputs, letter_box, BOX_THRESH, NMS_THRESH, od_results);
+}
+
+int decode_yolov8_batch_pose(rknn_app_context_t *app_ctx, int index, letterbox_t *letter_box, object_pose_result *pose)
+{
+    pose->kpt_count = 0;
+    if (index < 0 || index >= app_ctx->batch)
+    {
+        return -1;
+    }
+
+    // 与 decode_yolov8_batch_outputs 相同：第 index 个裁剪图为每个输出中连续的 1/batch
+    rknn_output outputs[sizeof(app_ctx->outputs) / sizeof(app_ctx->outputs[0])];
+    for (int i = 0; i < app_ctx->io_num.n_output; i++)
+    {
+        outputs[i] = app_ctx->outputs[i];
+        outputs[i].size = app_ctx->outputs[i].size / app_ctx->batch;
+        outputs[i].buf = (unsigned char *)app_ctx->outputs[i].buf + (size_t)index * outputs[i].size;
+    }
+    return post_process_pose(app_ctx, outputs, letter_box, BOX_THRESH, pose);
+}
@@ -21,6 +21,9 @@
 #include "common.h"
 #include "file_utils.h"
 #include "image_utils.h"
+#include "preprocess.h"
+#include "logger.h"
+#include "tensor_capture.h"
 
 static void dump_tensor_attr(rknn_tensor_attr *attr)
 {
@@ -31,6 +34,33 @@ static void dump_tensor_attr(rknn_tensor_attr *attr)
            get_qnt_type_string(attr->qnt_type), attr->zp, attr->scale);
 }
 
+/**
+ * 创建输入输出内存并绑定到上下文（每个上下文独占）
+ */
+static int bind_io_mems(rknn_app_context_t *app_ctx)
+{
+    int ret;
+    app_ctx->input_mems[0] = rknn_create_mem(app_ctx->rknn_ctx, app_ctx->input_attrs[0].size_with_stride);
+
+    // Set input tensor memory
+    ret = rknn_set_io_mem(app_ctx->rknn_ctx, app_ctx->input_mems[0], &app_ctx->input_attrs[0]);
+    if (ret < 0) {
+        printf("input_mems rknn_set_io_mem fail! ret=%d\n", ret);
+        return -1;
+    }
+
+    // Set output tensor memory
+    for (uint32_t i = 0; i < app_ctx->io_num.n_output; ++i) {
+        app_ctx->output_mems[i] = rknn_create_mem(app_ctx->rknn_ctx, app_ctx->output_attrs[i].size_with_stride);
+        ret = rknn_set_io_mem(app_ctx->rknn_ctx, app_ctx->output_mems[i], &app_ctx->output_attrs[i]);
+        if (ret < 0) {
+            printf("output_mems rknn_set_io_mem fail! ret=%d\n", ret);
+            return -1;
+        }
+    }
+    return 0;
+}
+
 int init_yolov8_model(const char *model_path, rknn_app_context_t *app_ctx)
 {
     int ret;
@@ -94,24 +124,6 @@ int init_yolov8_model(const char *model_path, rknn_app_context_t *app_ctx)
     // default fmt is NHWC,1106 npu only support NHWC in zero copy mode
     input_attrs[0].fmt = RKNN_TENSOR_NHWC;
     printf("input_attrs[0].size_with_stride=%d\n", input_attrs[0].size_with_stride);
-    app_ctx->input_mems[0] = rknn_create_mem(ctx, input_attrs[0].size_with_stride);
-
-    // Set input tensor memory
-    ret = rknn_set_io_mem(ctx, app_ctx->input_mems[0], &input_attrs[0]);
-    if (ret < 0) {
-        printf("input_mems rknn_set_io_mem fail! ret=%d\n", ret);
-        return -1;
-    }
-
-    // Set output tensor memory
-    for (uint32_t i = 0; i < io_num.n_output; ++i) {
-        app_ctx->output_mems[i] = rknn_create_mem(ctx, output_attrs[i].size_with_stride);
-        ret = rknn_set_io_mem(ctx, app_ctx->output_mems[i], &output_attrs[i]);
-        if (ret < 0) {
-            printf("output_mems rknn_set_io_mem fail! ret=%d\n", ret);
-            return -1;
-        }
-    }
 
     // Set to context
     app_ctx->rknn_ctx = ctx;
@@ -132,6 +144,12 @@ int init_yolov8_model(const char *model_path, rknn_app_context_t *app_ctx)
     app_ctx->output_attrs = (rknn_tensor_attr *)malloc(io_num.n_output * sizeof(rknn_tensor_attr));
     memcpy(app_ctx->output_attrs, output_attrs, io_num.n_output * sizeof(rknn_tensor_attr));
 
+    ret = bind_io_mems(app_ctx);
+    if (ret < 0)
+    {
+        return -1;
+    }
+
     if (input_attrs[0].fmt == RKNN_TENSOR_NCHW) 
     {
         printf("model is NCHW input fmt\n");
@@ -149,6 +167,52 @@ int init_yolov8_model(const char *model_path, rknn_app_context_t *app_ctx)
     printf("model input height=%d, width=%d, channel=%d\n",
            app_ctx->model_height, app_ctx->model_width, app_ctx->model_channel);
 
+    ret = init_post_process_ctx(app_ctx);
+    if (ret < 0)
+    {
+        printf("init_post_process_ctx fail! ret=%d\n", ret);
+        return -1;
+    }
+    app_ctx->input_cache = new letterbox_cache();
+
+    return 0;
+}
+
+int dup_yolov8_model(rknn_app_context_t *src_ctx, rknn_app_context_t *app_ctx)
+{
+    rknn_context ctx = 0;
+    int ret = rknn_dup_context(&src_ctx->rknn_ctx, &ctx);
+    if (ret < 0)
+    {
+        printf("rknn_dup_context fail! ret=%d\n", ret);
+        return -1;
+    }
+    app_ctx->rknn_ctx = ctx;
+
+    // 属性表与模型参数沿用源上下文，输入输出内存每个上下文独占
+    app_ctx->io_num = src_ctx->io_num;
+    app_ctx->input_attrs = src_ctx->input_attrs;
+    app_ctx->output_attrs = src_ctx->output_attrs;
+    app_ctx->shared_attrs = true;
+    app_ctx->is_quant = src_ctx->is_quant;
+    app_ctx->model_channel = src_ctx->model_channel;
+    app_ctx->model_height = src_ctx->model_height;
+    app_ctx->model_width = src_ctx->model_width;
+
+    ret = bind_io_mems(app_ctx);
+    if (ret < 0)
+    {
+        return -1;
+    }
+
+    ret = init_post_process_ctx(app_ctx);
+    if (ret < 0)
+    {
+        printf("init_post_process_ctx fail! ret=%d\n", ret);
+        return -1;
+    }
+    app_ctx->input_cache = new letterbox_cache();
+
     return 0;
 }
 
@@ -156,14 +220,26 @@ int release_yolov8_model(rknn_app_context_t *app_ctx)
 {    
     if (app_ctx->input_attrs != NULL)
     {
-        free(app_ctx->input_attrs);
+        if (!app_ctx->shared_attrs)
+        {
+            free(app_ctx->input_attrs);
+        }
         app_ctx->input_attrs = NULL;
     }
     if (app_ctx->output_attrs != NULL)
     {
-        free(app_ctx->output_attrs);
+        if (!app_ctx->shared_attrs)
+        {
+            free(app_ctx->output_attrs);
+        }
         app_ctx->output_attrs = NULL;
     }
+    deinit_post_process_ctx(app_ctx);
+    if (app_ctx->input_cache != NULL)
+    {
+        delete app_ctx->input_cache;
+        app_ctx->input_cache = NULL;
+    }
     for (int i = 0; i < app_ctx->io_num.n_input; i++) {
         if (app_ctx->input_mems[i] != NULL) {
             rknn_destroy_mem(app_ctx->rknn_ctx, app_ctx->input_mems[i]);
@@ -182,15 +258,29 @@ int release_yolov8_model(rknn_app_context_t *app_ctx)
     return 0;
 }
 
+/**
+ * 输入已写入 input_mems[0] 后推理；输出直接写入 rknn_set_io_mem 绑定的 output_mems
+ */
+static int run_model(rknn_app_context_t *app_ctx)
+{
+    // Run
+    LOG_DEBUG("rknn_run");
+    int ret = rknn_run(app_ctx->rknn_ctx, nullptr);
+    if (ret < 0)
+    {
+        printf("rknn_run fail! ret=%d\n", ret);
+        return -1;
+    }
+    return ret;
+}
+
 int inference_yolov8_model(rknn_app_context_t *app_ctx, image_buffer_t *img, object_detect_result_list *od_results)
 {
     int ret;
     image_buffer_t dst_img;
     letterbox_t letter_box;
-    const float nms_threshold = NMS_THRESH;      // 默认的NMS阈值
-    const float box_conf_threshold = BOX_THRESH; // 默认的置信度阈值
     int bg_color = 114;
-    
+
     if ((!app_ctx) || !(img) || (!od_results))
     {
         return -1;
@@ -219,16 +309,71 @@ int inference_yolov8_model(rknn_app_context_t *app_ctx, image_buffer_t *img, obj
         return -1;
     }
 
-    // Run
-    printf("rknn_run\n");
-    ret = rknn_run(app_ctx->rknn_ctx, nullptr);
-    if (ret < 0) {
-        printf("rknn_run fail! ret=%d\n", ret);
+    // 整幅输入被重写，BGR 路径缓存的边框失效
+    app_ctx->input_cache->src_width = 0;
+
+    ret = run_model(app_ctx);
+    if (ret < 0)
+    {
+        return ret;
+    }
+
+    tensor_capture_frame(app_ctx, yolov8_model_outputs(app_ctx), &letter_box, img->width, img->height);
+    // Post Process
+    return post_process(app_ctx, yolov8_model_outputs(app_ctx), &letter_box, BOX_THRESH, NMS_THRESH, od_results);
+}
+
+int run_yolov8_model_bgr(rknn_app_context_t *app_ctx, const unsigned char *bgr, int width, int height, int stride,
+                         letterbox_t *letter_box)
+{
+    int ret;
+    int bg_color = 114;
+
+    if ((!app_ctx) || !(bgr) || (!letter_box))
+    {
+        return -1;
+    }
+    memset(letter_box, 0, sizeof(letterbox_t));
+
+    // Pre Process：BGR→RGB、缩放与 letterbox 一次写入输入内存（按 w_stride 换行）
+    int w_stride = app_ctx->input_attrs[0].w_stride > 0 ? app_ctx->input_attrs[0].w_stride : app_ctx->model_width;
+    ret = letterbox_bgr_to_rgb(*app_ctx->input_cache, bgr, width, height, stride,
+                               (unsigned char *)app_ctx->input_mems[0]->virt_addr, app_ctx->model_width,
+                               app_ctx->model_height, w_stride * 3, bg_color, letter_box);
+    if (ret < 0)
+    {
+        printf("letterbox_bgr_to_rgb fail! ret=%d\n", ret);
+        return -1;
+    }
+
+    return run_model(app_ctx);
+}
+
+void *yolov8_model_outputs(rknn_app_context_t *app_ctx)
+{
+    return app_ctx->output_mems;
+}
+
+int inference_yolov8_model_bgr(rknn_app_context_t *app_ctx, const unsigned char *bgr, int width, int height, int stride,
+                               object_detect_result_list *od_results)
+{
+    int ret;
+    letterbox_t letter_box;
+
+    if ((!app_ctx) || !(bgr) || (!od_results))
+    {
         return -1;
     }
 
+    memset(od_results, 0x00, sizeof(*od_results));
+
+    ret = run_yolov8_model_bgr(app_ctx, bgr, width, height, stride, &letter_box);
+    if (ret < 0)
+    {
+        return ret;
+    }
+
+    tensor_capture_frame(app_ctx, yolov8_model_outputs(app_ctx), &letter_box, width, height);
     // Post Process
-    post_process(app_ctx, app_ctx->output_mems, &letter_box, box_conf_threshold, nms_threshold, od_results);
-out:
-    return ret;
-}
\ No newline at end of file
+    return post_process(app_ctx, yolov8_model_outputs(app_ctx), &letter_box, BOX_THRESH, NMS_THRESH, od_results);
+}
@@ -18,9 +18,12 @@
 #include <math.h>
 
 #include "yolov8.h"
+#include "preprocess.h"
 #include "common.h"
 #include "file_utils.h"
 #include "image_utils.h"
+#include "logger.h"
+#include "tensor_capture.h"
 
 static void dump_tensor_attr(rknn_tensor_attr *attr) {
     char dims[128] = {0};
@@ -36,6 +39,32 @@ static void dump_tensor_attr(rknn_tensor_attr *attr) {
            attr->scale);
 }
 
+/**
+ * 按原生属性创建输入输出内存并绑定到上下文（每个上下文独占）
+ */
+static int bind_io_mems(rknn_app_context_t *app_ctx) {
+    int ret;
+    app_ctx->input_mems[0] = rknn_create_mem(app_ctx->rknn_ctx, app_ctx->input_native_attrs[0].size_with_stride);
+
+    // Set input tensor memory
+    ret = rknn_set_io_mem(app_ctx->rknn_ctx, app_ctx->input_mems[0], &app_ctx->input_native_attrs[0]);
+    if (ret < 0) {
+        printf("input_mems rknn_set_io_mem fail! ret=%d\n", ret);
+        return -1;
+    }
+
+    // Set output tensor memory
+    for (uint32_t i = 0; i < app_ctx->io_num.n_output; ++i) {
+        app_ctx->output_mems[i] = rknn_create_mem(app_ctx->rknn_ctx, app_ctx->output_native_attrs[i].size_with_stride);
+        ret = rknn_set_io_mem(app_ctx->rknn_ctx, app_ctx->output_mems[i], &app_ctx->output_native_attrs[i]);
+        if (ret < 0) {
+            printf("output_mems rknn_set_io_mem fail! ret=%d\n", ret);
+            return -1;
+        }
+    }
+    return 0;
+}
+
 int init_yolov8_model(const char *model_path, rknn_app_context_t *app_ctx) {
     int ret;
     int model_len = 0;
@@ -82,14 +111,6 @@ int init_yolov8_model(const char *model_path, rknn_app_context_t *app_ctx) {
     // default input type is int8 (normalize and quantize need compute in outside)
     // if set uint8, will fuse normalize and quantize to npu
     input_native_attrs[0].type = RKNN_TENSOR_UINT8;
-    app_ctx->input_mems[0] = rknn_create_mem(ctx, input_native_attrs[0].size_with_stride);
-
-    // Set input tensor memory
-    ret = rknn_set_io_mem(ctx, app_ctx->input_mems[0], &input_native_attrs[0]);
-    if (ret < 0) {
-        printf("input_mems rknn_set_io_mem fail! ret=%d\n", ret);
-        return -1;
-    }
 
     // Get Model Output Info
     printf("output tensors:\n");
@@ -105,16 +126,6 @@ int init_yolov8_model(const char *model_path, rknn_app_context_t *app_ctx) {
         dump_tensor_attr(&(output_native_attrs[i]));
     }
 
-    // Set output tensor memory
-    for (uint32_t i = 0; i < io_num.n_output; ++i) {
-        app_ctx->output_mems[i] = rknn_create_mem(ctx, output_native_attrs[i].size_with_stride);
-        ret = rknn_set_io_mem(ctx, app_ctx->output_mems[i], &output_native_attrs[i]);
-        if (ret < 0) {
-            printf("output_mems rknn_set_io_mem fail! ret=%d\n", ret);
-            return -1;
-        }
-    }
-
     // Set to context
     app_ctx->rknn_ctx = ctx;
 
@@ -158,6 +169,11 @@ int init_yolov8_model(const char *model_path, rknn_app_context_t *app_ctx) {
     app_ctx->output_native_attrs = (rknn_tensor_attr *)malloc(io_num.n_output * sizeof(rknn_tensor_attr));
     memcpy(app_ctx->output_native_attrs, output_native_attrs, io_num.n_output * sizeof(rknn_tensor_attr));
 
+    ret = bind_io_mems(app_ctx);
+    if (ret < 0) {
+        return -1;
+    }
+
 
     if (input_attrs[0].fmt == RKNN_TENSOR_NCHW) {
         printf("model is NCHW input fmt\n");
@@ -173,49 +189,81 @@ int init_yolov8_model(const char *model_path, rknn_app_context_t *app_ctx) {
     printf("model input height=%d, width=%d, channel=%d\n",
            app_ctx->model_height, app_ctx->model_width, app_ctx->model_channel);
 
+    ret = init_post_process_ctx(app_ctx);
+    if (ret < 0) {
+        printf("init_post_process_ctx fail! ret=%d\n", ret);
+        return -1;
+    }
+    app_ctx->input_cache = new letterbox_cache();
+
     return 0;
 }
 
-int NC1HWC2_i8_to_NCHW_i8(const int8_t *src, int8_t *dst, int *dims, int channel, int h, int w, int zp, float scale) {
-    int batch  = dims[0];
-    int C1     = dims[1];
-    int C2     = dims[4];
-    int hw_src = dims[2] * dims[3];
-    int hw_dst = h * w;
-    for (int i = 0; i < batch; i++) {
-        const int8_t *src_b = src + i * C1 * hw_src * C2;
-        int8_t        *dst_b = dst + i * channel * hw_dst;
-        for (int c = 0; c < channel; ++c) {
-            int           plane  = c / C2;
-            const int8_t *src_bc = plane * hw_src * C2 + src_b;
-            int           offset = c % C2;
-            for (int cur_h = 0; cur_h < h; ++cur_h)
-                for (int cur_w = 0; cur_w < w; ++cur_w) {
-                    int cur_hw                 = cur_h * w + cur_w;
-                    dst_b[c * hw_dst + cur_hw] = src_bc[C2 * cur_hw + offset] ; // int8-->int8
-                }
-        }
+int dup_yolov8_model(rknn_app_context_t *src_ctx, rknn_app_context_t *app_ctx) {
+    rknn_context ctx = 0;
+    int ret = rknn_dup_context(&src_ctx->rknn_ctx, &ctx);
+    if (ret < 0) {
+        printf("rknn_dup_context fail! ret=%d\n", ret);
+        return -1;
+    }
+    app_ctx->rknn_ctx = ctx;
+
+    // 属性表与模型参数沿用源上下文，输入输出内存每个上下文独占
+    app_ctx->io_num = src_ctx->io_num;
+    app_ctx->input_attrs = src_ctx->input_attrs;
+    app_ctx->output_attrs = src_ctx->output_attrs;
+    app_ctx->input_native_attrs = src_ctx->input_native_attrs;
+    app_ctx->output_native_attrs = src_ctx->output_native_attrs;
+    app_ctx->shared_attrs = true;
+    app_ctx->is_quant = src_ctx->is_quant;
+    app_ctx->model_channel = src_ctx->model_channel;
+    app_ctx->model_height = src_ctx->model_height;
+    app_ctx->model_width = src_ctx->model_width;
+
+    ret = bind_io_mems(app_ctx);
+    if (ret < 0) {
+        return -1;
     }
 
+    ret = init_post_process_ctx(app_ctx);
+    if (ret < 0) {
+        printf("init_post_process_ctx fail! ret=%d\n", ret);
+        return -1;
+    }
+    app_ctx->input_cache = new letterbox_cache();
+
     return 0;
 }
 
 int release_yolov8_model(rknn_app_context_t *app_ctx) {
     int ret;
     if (app_ctx->input_attrs != NULL) {
-        free(app_ctx->input_attrs);
+        if (!app_ctx->shared_attrs) {
+            free(app_ctx->input_attrs);
+        }
         app_ctx->input_attrs = NULL;
     }
     if (app_ctx->output_attrs != NULL) {
-        free(app_ctx->output_attrs);
+        if (!app_ctx->shared_attrs) {
+            free(app_ctx->output_attrs);
+        }
         app_ctx->output_attrs = NULL;
     }
+    deinit_post_process_ctx(app_ctx);
+    if (app_ctx->input_cache != NULL) {
+        delete app_ctx->input_cache;
+        app_ctx->input_cache = NULL;
+    }
     if (app_ctx->input_native_attrs != NULL) {
-        free(app_ctx->input_native_attrs);
+        if (!app_ctx->shared_attrs) {
+            free(app_ctx->input_native_attrs);
+        }
         app_ctx->input_native_attrs = NULL;
     }
     if (app_ctx->output_native_attrs != NULL) {
-        free(app_ctx->output_native_attrs);
+        if (!app_ctx->shared_attrs) {
+            free(app_ctx->output_native_attrs);
+        }
         app_ctx->output_native_attrs = NULL;
     }
 
@@ -249,12 +297,24 @@ int release_yolov8_model(rknn_app_context_t *app_ctx) {
     return 0;
 }
 
+/**
+ * 输入已写入 input_mems[0] 后推理；输出直接写入 rknn_set_io_mem 绑定的 output_mems
+ */
+static int run_model(rknn_app_context_t *app_ctx) {
+    // Run
+    LOG_DEBUG("rknn_run");
+    int ret = rknn_run(app_ctx->rknn_ctx, nullptr);
+    if (ret < 0) {
+        printf("rknn_run fail! ret=%d\n", ret);
+        return -1;
+    }
+    return ret;
+}
+
 int inference_yolov8_model(rknn_app_context_t *app_ctx, image_buffer_t *img, object_detect_result_list *od_results) {
     int ret;
     image_buffer_t dst_img;
     letterbox_t letter_box;
-    const float nms_threshold = NMS_THRESH;      // 默认的NMS阈值
-    const float box_conf_threshold = BOX_THRESH; // 默认的置信度阈值
     int bg_color = 114;
 
     if ((!app_ctx) || !(img) || (!od_results)) {
@@ -284,47 +344,64 @@ int inference_yolov8_model(rknn_app_context_t *app_ctx, image_buffer_t *img, obj
         printf("convert_image_with_letterbox fail! ret=%d\n", ret);
         return -1;
     }
+    // 整幅输入被重写，BGR 路径缓存的边框失效
+    app_ctx->input_cache->src_width = 0;
 
-    // Run
-    printf("rknn_run\n");
-    ret = rknn_run(app_ctx->rknn_ctx, nullptr);
+    ret = run_model(app_ctx);
     if (ret < 0) {
-        printf("rknn_run fail! ret=%d\n", ret);
+        return ret;
+    }
+
+    tensor_capture_frame(app_ctx, yolov8_model_outputs(app_ctx), &letter_box, img->width, img->height);
+    // Post Process：解码核按原生布局（NC1HWC2）直接读取 int8 / fp16 输出内存
+    return post_process(app_ctx, yolov8_model_outputs(app_ctx), &letter_box, BOX_THRESH, NMS_THRESH, od_results);
+}
+
+int run_yolov8_model_bgr(rknn_app_context_t *app_ctx, const unsigned char *bgr, int width, int height, int stride,
+                         letterbox_t *letter_box) {
+    int ret;
+    int bg_color = 114;
+
+    if ((!app_ctx) || !(bgr) || (!letter_box)) {
         return -1;
     }
 
-    //NC1HWC2 to NCHW
-    rknn_output outputs[app_ctx->io_num.n_output];
-    memset(outputs, 0, sizeof(outputs));
-    for (uint32_t i = 0; i < app_ctx->io_num.n_output; i++) {
-        int   channel = app_ctx->output_attrs[i].dims[1];
-        int   h       = app_ctx->output_attrs[i].n_dims > 2 ? app_ctx->output_attrs[i].dims[2] : 1;
-        int   w       = app_ctx->output_attrs[i].n_dims > 3 ? app_ctx->output_attrs[i].dims[3] : 1;
-        int   hw      = h * w;
-        int   zp      = app_ctx->output_native_attrs[i].zp;
-        float scale   = app_ctx->output_native_attrs[i].scale;
-        if (app_ctx->is_quant) {
-            outputs[i].size = app_ctx->output_native_attrs[i].n_elems * sizeof(int8_t);
-            outputs[i].buf = (int8_t *)malloc(outputs[i].size);
-            if (app_ctx->output_native_attrs[i].fmt == RKNN_TENSOR_NC1HWC2) {
-                NC1HWC2_i8_to_NCHW_i8((int8_t *)app_ctx->output_mems[i]->virt_addr, (int8_t *)outputs[i].buf,
-                                      (int *)app_ctx->output_native_attrs[i].dims, channel, h, w, zp, scale);
-            } else {
-                memcpy(outputs[i].buf, app_ctx->output_mems[i]->virt_addr, outputs[i].size);
-            }
-        } else {
-            printf("Currently zero copy does not support fp16!\n");
-            goto out;
-        }
+    memset(letter_box, 0, sizeof(letterbox_t));
+
+    // Pre Process：BGR→RGB、缩放与 letterbox 一次写入输入内存（按原生属性的 w_stride 换行）
+    int w_stride = app_ctx->input_native_attrs[0].w_stride > 0 ? app_ctx->input_native_attrs[0].w_stride : app_ctx->model_width;
+    ret = letterbox_bgr_to_rgb(*app_ctx->input_cache, bgr, width, height, stride,
+                               (unsigned char*)app_ctx->input_mems[0]->virt_addr, app_ctx->model_width,
+                               app_ctx->model_height, w_stride * 3, bg_color, letter_box);
+    if (ret < 0) {
+        printf("letterbox_bgr_to_rgb fail! ret=%d\n", ret);
+        return -1;
     }
 
-    // Post Process
-    post_process(app_ctx, outputs, &letter_box, box_conf_threshold, nms_threshold, od_results);
+    return run_model(app_ctx);
+}
 
-    for (int i = 0; i < app_ctx->io_num.n_output; i++) {
-        free(outputs[i].buf);
+void *yolov8_model_outputs(rknn_app_context_t *app_ctx) {
+    return app_ctx->output_mems;
+}
+
+int inference_yolov8_model_bgr(rknn_app_context_t *app_ctx, const unsigned char *bgr, int width, int height, int stride,
+                               object_detect_result_list *od_results) {
+    int ret;
+    letterbox_t letter_box;
+
+    if ((!app_ctx) || !(bgr) || (!od_results)) {
+        return -1;
     }
 
-out:
-    return ret;
-}
\ No newline at end of file
+    memset(od_results, 0x00, sizeof(*od_results));
+
+    ret = run_yolov8_model_bgr(app_ctx, bgr, width, height, stride, &letter_box);
+    if (ret < 0) {
+        return ret;
+    }
+
+    tensor_capture_frame(app_ctx, yolov8_model_outputs(app_ctx), &letter_box, width, height);
+    // Post Process
+    return post_process(app_ctx, yolov8_model_outputs(app_ctx), &letter_box, BOX_THRESH, NMS_THRESH, od_results);
+}
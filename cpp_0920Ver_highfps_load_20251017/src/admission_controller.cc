@@ -0,0 +1,158 @@
+#include "admission_controller.h"
+#include "common_utils.h"
+#include "logger.h"
+#include "stream_scheduler.h"
+#include <chrono>
+
+AdmissionController::AdmissionController(Yolov8Model& model, const AdmissionConfig& config) : model_(model) {
+    set_config(config);
+}
+
+void AdmissionController::set_config(const AdmissionConfig& config) {
+    config_ = config;
+    if (config_.max_in_flight < 1) {
+        config_.max_in_flight = 1;
+    }
+    if (config_.policy == DropPolicy::LATEST_WINS) {
+        config_.queue_depth = 1;
+    } else if (config_.queue_depth < 0) {
+        config_.queue_depth = 0;
+    }
+    if (reorder_ && reorder_->outstanding() > 0) {
+        safe_printf("AdmissionController: config changed with frames in flight, reorder buffer kept");
+        return;
+    }
+    // 槽位数留出余量：被越过的帧结果到达前仍占用槽位
+    reorder_ = std::make_shared<ReorderBuffer>(config_.max_in_flight * 2, config_.skip_ahead_ms);
+}
+
+void AdmissionController::set_stream_scheduler(StreamScheduler* scheduler, int stream) {
+    stream_scheduler_ = scheduler;
+    stream_ = stream;
+}
+
+bool AdmissionController::submit(const Queued& entry) {
+    uint64_t seq;
+    if (!reorder_->reserve(entry.frame, entry.capture_time, seq)) {
+        return false;
+    }
+    stats_.submitted++;
+    std::shared_ptr<ReorderBuffer> reorder = reorder_;
+    InferCallback on_done = [reorder, seq](InferStatus status, const object_detect_result_list& results,
+                                           const PoseResults& poses) {
+        reorder->complete(seq, status, results, poses);
+    };
+    if (stream_scheduler_) {
+        stream_scheduler_->submit(stream_, *entry.frame, entry.capture_time, std::move(on_done));
+    } else {
+        model_.submit_infer_task(*entry.frame, entry.capture_time, std::move(on_done));
+    }
+    return true;
+}
+
+void AdmissionController::pump() {
+    if (queued_.empty()) {
+        return;
+    }
+    while (!queued_.empty() && reorder_->outstanding() < config_.max_in_flight && submit(queued_.front())) {
+        queued_.pop_front();
+    }
+}
+
+bool AdmissionController::offer(const FrameRef& frame, std::chrono::steady_clock::time_point capture_time) {
+    if (!frame) {
+        return false;
+    }
+    stats_.offered++;
+    pump();
+    Queued entry{frame, capture_time};
+    if (queued_.empty() && reorder_->outstanding() < config_.max_in_flight && submit(entry)) {
+        return true;
+    }
+
+    switch (config_.policy) {
+    case DropPolicy::BLOCK:
+        // 不丢帧，调用方取走最早的帧后提交
+        queued_.push_back(entry);
+        return true;
+    case DropPolicy::LATEST_WINS:
+        record_drop(queued_.size());
+        queued_.clear();
+        queued_.push_back(entry);
+        return true;
+    case DropPolicy::DROP_OLDEST_QUEUED:
+        if (config_.queue_depth == 0) {
+            break;
+        }
+        if ((int)queued_.size() >= config_.queue_depth) {
+            queued_.pop_front();
+            record_drop(1);
+        }
+        queued_.push_back(entry);
+        return true;
+    case DropPolicy::DROP_NEWEST:
+        if ((int)queued_.size() < config_.queue_depth) {
+            queued_.push_back(entry);
+            return true;
+        }
+        break;
+    }
+    record_drop(1);
+    return false;
+}
+
+bool AdmissionController::next_completed(FrameRef& frame, object_detect_result_list& results, int wait_ms) {
+    std::chrono::steady_clock::time_point capture_time;
+    PoseResults poses;
+    return next_completed(frame, results, wait_ms, capture_time, poses);
+}
+
+bool AdmissionController::next_completed(FrameRef& frame, object_detect_result_list& results, int wait_ms,
+                                         std::chrono::steady_clock::time_point& capture_time) {
+    PoseResults poses;
+    return next_completed(frame, results, wait_ms, capture_time, poses);
+}
+
+bool AdmissionController::next_completed(FrameRef& frame, object_detect_result_list& results, int wait_ms,
+                                         std::chrono::steady_clock::time_point& capture_time, PoseResults& poses) {
+    pump();
+    ReorderedFrame next;
+    while (reorder_->pop(next, wait_ms)) {
+        // 窗口腾出空位，立即提交排队帧
+        pump();
+        if (next.status == InferStatus::SKIPPED) {
+            stats_.skipped++;
+            continue;
+        }
+        if (next.status == InferStatus::FAILED) {
+            LOG_THROTTLED(LOG_LEVEL_ERROR, 1000, "Inference failed for frame %llu", (unsigned long long)next.seq);
+        }
+        frame = std::move(next.frame);
+        capture_time = next.capture_time;
+        results = next.results;
+        poses = std::move(next.poses);
+        stats_.completed++;
+        return true;
+    }
+    return false;
+}
+
+void AdmissionController::discard_queued() {
+    stats_.dropped += queued_.size();
+    queued_.clear();
+}
+
+void AdmissionController::record_drop(uint64_t count) {
+    if (count == 0) {
+        return;
+    }
+    stats_.dropped += count;
+    LOG_THROTTLED(LOG_LEVEL_INFO, 1000, "Inference behind capture, frames dropped: %llu",
+                  (unsigned long long)stats_.dropped);
+}
+
+AdmissionStats AdmissionController::stats() const {
+    AdmissionStats stats = stats_;
+    stats.skipped_ahead = reorder_->skipped_ahead();
+    return stats;
+}
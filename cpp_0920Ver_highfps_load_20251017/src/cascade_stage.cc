@@ -0,0 +1,101 @@
+#include "cascade_stage.h"
+#include "logger.h"
+#include <algorithm>
+
+void CascadeStage::set_config(const CascadeConfig& config) {
+    config_ = config;
+    config_.max_crops = std::max(0, std::min(config_.max_crops, POSE_NUMB_MAX_SIZE));
+    config_.crop_margin = std::max(0.0f, config_.crop_margin);
+}
+
+int CascadeStage::select(const object_detect_result_list& od_results, int frame_width, int frame_height,
+                         std::vector<CascadeCrop>& crops) const {
+    crops.clear();
+    cv::Rect bounds(0, 0, frame_width, frame_height);
+    for (int i = 0; i < od_results.count; ++i) {
+        const object_detect_result& det = od_results.results[i];
+        if (det.cls_id != config_.cls_id || det.prop < config_.min_score) {
+            continue;
+        }
+        int w = det.box.right - det.box.left;
+        int h = det.box.bottom - det.box.top;
+        if (std::min(w, h) < config_.min_box_px) {
+            continue;
+        }
+        int dx = (int)(w * config_.crop_margin);
+        int dy = (int)(h * config_.crop_margin);
+        cv::Rect rect = cv::Rect(det.box.left - dx, det.box.top - dy, w + 2 * dx, h + 2 * dy) & bounds;
+        if (rect.width > 0 && rect.height > 0) {
+            crops.push_back(CascadeCrop{i, rect});
+        }
+    }
+    // 超过上限时保留面积最大的（近处、关键点最可靠的目标）
+    if ((int)crops.size() > config_.max_crops) {
+        std::partial_sort(crops.begin(), crops.begin() + config_.max_crops, crops.end(),
+                          [](const CascadeCrop& a, const CascadeCrop& b) { return a.rect.area() > b.rect.area(); });
+        crops.resize(config_.max_crops);
+    }
+    return (int)crops.size();
+}
+
+void CascadeStage::merge(object_pose_result& pose, const CascadeCrop& crop, object_pose_result_list& poses) {
+    if (pose.kpt_count <= 0 || poses.count >= POSE_NUMB_MAX_SIZE) {
+        return;
+    }
+    pose.det_index = crop.det_index;
+    for (int k = 0; k < pose.kpt_count; ++k) {
+        pose.keypoints[k].x += crop.rect.x;
+        pose.keypoints[k].y += crop.rect.y;
+    }
+    poses.poses[poses.count++] = pose;
+}
+
+int CascadeStage::run(InferenceBackend& backend, const cv::Mat& frame, const std::vector<CascadeCrop>& crops,
+                      object_pose_result_list& poses) const {
+    poses.count = 0;
+#if defined(YOLOV8_POSE_SUPPORTED)
+    rknn_app_context_t* ctx = backend.model_context();
+    object_pose_result pose;
+#if defined(YOLOV8_PIPELINE_SUPPORTED)
+    if (backend.supports_pipeline() && ctx->batch > 1) {
+        // 裁剪图依次填入输入槽 0 的各个批量位置，一批一次推理
+        std::vector<letterbox_t> letter_boxes(ctx->batch);
+        for (size_t first = 0; first < crops.size(); first += ctx->batch) {
+            int n = (int)std::min(crops.size() - first, (size_t)ctx->batch);
+            for (int i = 0; i < n; ++i) {
+                cv::Mat crop = frame(crops[first + i].rect);
+                if (prepare_yolov8_batch_input_bgr(ctx, 0, i, crop.data, crop.cols, crop.rows, (int)crop.step,
+                                                   &letter_boxes[i]) != 0) {
+                    return -1;
+                }
+            }
+            if (run_yolov8_model_async(ctx, 0) != 0 || wait_yolov8_model_outputs(ctx) != 0) {
+                return -1;
+            }
+            for (int i = 0; i < n; ++i) {
+                if (decode_yolov8_batch_pose(ctx, i, &letter_boxes[i], &pose) == 0) {
+                    merge(pose, crops[first + i], poses);
+                }
+            }
+        }
+        return 0;
+    }
+#endif
+    for (const CascadeCrop& crop : crops) {
+        letterbox_t letter_box;
+        if (backend.run(frame(crop.rect), &letter_box) != 0) {
+            return -1;
+        }
+        if (post_process_pose(ctx, backend.outputs(), &letter_box, BOX_THRESH, &pose) == 0) {
+            merge(pose, crop, poses);
+        }
+    }
+    return 0;
+#else
+    (void)backend;
+    (void)frame;
+    LOG_THROTTLED(LOG_LEVEL_WARN, 1000, "Cascade stage not supported for this output layout, %d crops ignored",
+                  (int)crops.size());
+    return -1;
+#endif
+}
@@ -1,4 +1,5 @@
 #include "common_utils.h"
+#include "logger.h"
 #include <cstdio>
 #include <cerrno>
 #include <cstdarg> 
@@ -26,17 +27,12 @@ float FPSCounter::get_current_fps() const{
     return current_fps;
 }
 
-// 线程安全打印实现
+// 线程安全打印实现：写入异步日志（INFO 级别），调用线程不再持全局锁
 void safe_printf(const char* format, ...) {
-    static std::mutex print_mutex;
-    std::lock_guard<std::mutex> lock(print_mutex);  // 线程安全保护
-
-    // 使用va_list处理可变参数
     va_list args;
     va_start(args, format);
-    vprintf(format, args);  // 用vprintf处理格式化输出
+    log_vwrite(LOG_LEVEL_INFO, format, args);
     va_end(args);
-    printf("\n");  // 补充换行（保持原行为）
 }
 
 // 时间转换实现
@@ -0,0 +1,286 @@
+#include "context_pipeline.h"
+#include "common_utils.h"
+#include "logger.h"
+#include "tensor_capture.h"
+
+#if defined(YOLOV8_PIPELINE_SUPPORTED)
+
+ContextPipeline::ContextPipeline(rknn_app_context_t* ctx, ResultCallback on_result, int batch_max_wait_ms)
+    : ctx_(ctx), on_result_(std::move(on_result)), batch_max_wait_(batch_max_wait_ms) {
+    if (ctx_->batch > 1) {
+        thread_ = std::thread(&ContextPipeline::batch_worker, this);
+    } else {
+        thread_ = std::thread(&ContextPipeline::worker, this);
+    }
+}
+
+ContextPipeline::~ContextPipeline() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    condition_.notify_all();
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+}
+
+void ContextPipeline::submit(const cv::Mat& frame, std::chrono::steady_clock::time_point deadline,
+                             InferCallback on_done) {
+    Job job;
+    job.frame = frame;
+    job.on_done = std::move(on_done);
+    job.submit_time = std::chrono::steady_clock::now();
+    job.deadline = deadline;
+    {
+        // 按截止时间插入（截止时间相同的保持提交顺序），通常即为队尾
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = jobs_.end();
+        while (it != jobs_.begin() && (it - 1)->deadline > deadline) {
+            --it;
+        }
+        jobs_.insert(it, std::move(job));
+    }
+    condition_.notify_one();
+}
+
+void ContextPipeline::take_expired(std::vector<Job>& expired) {
+    auto now = std::chrono::steady_clock::now();
+    while (!jobs_.empty() && jobs_.front().deadline < now) {
+        expired.push_back(std::move(jobs_.front()));
+        jobs_.pop_front();
+    }
+}
+
+void ContextPipeline::deliver_skipped(std::vector<Job>& expired) {
+    object_detect_result_list empty = {};
+    for (auto& job : expired) {
+        uint64_t skipped = ++skipped_;
+        LOG_THROTTLED(LOG_LEVEL_INFO, 1000, "Skip frame past deadline, %llu skipped", (unsigned long long)skipped);
+        job.on_done(InferStatus::SKIPPED, empty, PoseResults());
+    }
+    expired.clear();
+}
+
+size_t ContextPipeline::pending() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return jobs_.size() + in_flight_;
+}
+
+void ContextPipeline::worker() {
+    // 正在 NPU 上运行的帧
+    bool running = false;
+    InferCallback running_done;
+    letterbox_t running_letter_box;
+    cv::Size running_size;
+    int next_slot = 0;
+    std::vector<Job> expired;
+
+    while (true) {
+        // 取下一帧：NPU 空闲时阻塞等待，NPU 忙时只取已排队的帧，不耽误解码
+        Job job;
+        bool has_job = false;
+        bool stopping = false;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            if (!running) {
+                condition_.wait(lock, [this] { return stop_ || !jobs_.empty(); });
+            }
+            take_expired(expired);
+            if (!jobs_.empty()) {
+                job = std::move(jobs_.front());
+                jobs_.pop_front();
+                in_flight_++;
+                has_job = true;
+            } else if (!running && stop_) {
+                stopping = true;  // stop_ 且队列已空
+            }
+        }
+        deliver_skipped(expired);
+        if (stopping) {
+            break;
+        }
+        if (!has_job && !running) {
+            continue;  // 排队的帧都已过期
+        }
+
+        // 1. 预处理下一帧（与 NPU 上的当前帧并行）
+        letterbox_t letter_box;
+        memset(&letter_box, 0, sizeof(letterbox_t));
+        if (has_job) {
+            int ret = -1;
+            if (job.frame.type() == CV_8UC3) {
+                ret = prepare_yolov8_input_bgr(ctx_, next_slot, job.frame.data, job.frame.cols, job.frame.rows,
+                                               (int)job.frame.step, &letter_box);
+            } else {
+                LOG_THROTTLED(LOG_LEVEL_ERROR, 1000, "Unsupported frame type %d, expect CV_8UC3 (BGR)", job.frame.type());
+            }
+            if (ret != 0) {
+                object_detect_result_list empty = {};
+                finish(job, InferStatus::FAILED, empty);
+                has_job = false;
+            }
+        }
+
+        // 2. 等待当前帧，输出取到预分配缓冲区后 NPU 即可接收下一帧
+        int wait_ret = 0;
+        if (running) {
+            wait_ret = wait_yolov8_model_outputs(ctx_);
+        }
+
+        // 3. 启动下一帧
+        if (has_job) {
+            if (run_yolov8_model_async(ctx_, next_slot) != 0) {
+                object_detect_result_list empty = {};
+                finish(job, InferStatus::FAILED, empty);
+                has_job = false;
+            }
+        }
+
+        // 4. 解码刚完成的帧（与 NPU 上的下一帧并行）
+        if (running) {
+            object_detect_result_list od_results = {};
+            InferStatus status = InferStatus::OK;
+            if (wait_ret >= 0) {
+                tensor_capture_frame(ctx_, yolov8_model_outputs(ctx_), &running_letter_box, running_size.width,
+                                     running_size.height);
+                decode_yolov8_model_outputs(ctx_, &running_letter_box, &od_results);
+                if (on_result_) {
+                    on_result_(running_size, od_results);
+                }
+            } else {
+                LOG_THROTTLED(LOG_LEVEL_ERROR, 1000, "Infer failed, ret=%d", wait_ret);
+                status = InferStatus::FAILED;
+            }
+            running_done(status, od_results, PoseResults());
+            std::lock_guard<std::mutex> lock(mutex_);
+            in_flight_--;
+        }
+
+        running = has_job;
+        if (has_job) {
+            running_done = std::move(job.on_done);
+            running_letter_box = letter_box;
+            running_size = job.frame.size();
+            next_slot ^= 1;
+        }
+    }
+}
+
+void ContextPipeline::finish(Job& job, InferStatus status, const object_detect_result_list& od_results) {
+    job.on_done(status, od_results, PoseResults());
+    std::lock_guard<std::mutex> lock(mutex_);
+    in_flight_--;
+}
+
+void ContextPipeline::batch_worker() {
+    const size_t batch = (size_t)ctx_->batch;
+    object_detect_result_list empty = {};
+    // 正在 NPU 上运行的一批；两个输入槽各容纳一批，交替使用
+    bool running = false;
+    std::vector<Job> running_jobs;
+    std::vector<Job> jobs;
+    std::vector<letterbox_t> letter_boxes[2] = {std::vector<letterbox_t>(batch), std::vector<letterbox_t>(batch)};
+    std::vector<bool> prepared[2] = {std::vector<bool>(batch), std::vector<bool>(batch)};
+    int next_slot = 0;
+    std::vector<Job> expired;
+
+    while (true) {
+        // 取下一批：NPU 忙时只取已凑满的一批，否则先去等待并解码当前批（交付结果后调用方才会提交更多帧）；
+        // NPU 空闲时等到凑满一批，或最早的一帧已等待 batch_max_wait_（限制延迟）
+        jobs.clear();
+        bool stopping = false;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            if (!running) {
+                condition_.wait(lock, [this] { return stop_ || !jobs_.empty(); });
+                if (!jobs_.empty()) {
+                    condition_.wait_until(lock, jobs_.front().submit_time + batch_max_wait_,
+                                          [this, batch] { return stop_ || jobs_.size() >= batch; });
+                }
+            }
+            take_expired(expired);
+            if (!jobs_.empty() && (!running || jobs_.size() >= batch)) {
+                while (!jobs_.empty() && jobs.size() < batch) {
+                    jobs.push_back(std::move(jobs_.front()));
+                    jobs_.pop_front();
+                    in_flight_++;
+                }
+            } else if (!running && stop_) {
+                stopping = true;  // stop_ 且队列已空
+            }
+        }
+        deliver_skipped(expired);
+        if (stopping) {
+            break;
+        }
+        if (jobs.empty() && !running) {
+            continue;  // 排队的帧都已过期
+        }
+
+        // 1. 预处理下一批到空闲的输入槽（与 NPU 上的当前批并行）
+        int prepared_count = 0;
+        for (size_t i = 0; i < jobs.size(); ++i) {
+            const cv::Mat& frame = jobs[i].frame;
+            int ret = -1;
+            memset(&letter_boxes[next_slot][i], 0, sizeof(letterbox_t));
+            if (frame.type() == CV_8UC3) {
+                ret = prepare_yolov8_batch_input_bgr(ctx_, next_slot, (int)i, frame.data, frame.cols, frame.rows,
+                                                     (int)frame.step, &letter_boxes[next_slot][i]);
+            } else {
+                LOG_THROTTLED(LOG_LEVEL_ERROR, 1000, "Unsupported frame type %d, expect CV_8UC3 (BGR)", frame.type());
+            }
+            prepared[next_slot][i] = (ret == 0);
+            prepared_count += (ret == 0) ? 1 : 0;
+        }
+
+        // 2. 等待当前批
+        int wait_ret = 0;
+        if (running) {
+            wait_ret = wait_yolov8_model_outputs(ctx_);
+        }
+
+        // 3. 启动下一批
+        bool started = false;
+        if (prepared_count > 0) {
+            started = run_yolov8_model_async(ctx_, next_slot) == 0;
+            LOG_DEBUG("batch run: %d/%d frames", prepared_count, (int)batch);
+        }
+        if (!started) {
+            for (size_t i = 0; i < jobs.size(); ++i) {
+                finish(jobs[i], InferStatus::FAILED, empty);
+            }
+            jobs.clear();
+        }
+
+        // 4. 逐帧解码刚完成的一批（与 NPU 上的下一批并行）
+        if (running) {
+            int slot = next_slot ^ 1;
+            if (wait_ret < 0) {
+                LOG_THROTTLED(LOG_LEVEL_ERROR, 1000, "Batch infer failed, ret=%d", wait_ret);
+            }
+            for (size_t i = 0; i < running_jobs.size(); ++i) {
+                if (wait_ret < 0 || !prepared[slot][i]) {
+                    finish(running_jobs[i], InferStatus::FAILED, empty);
+                    continue;
+                }
+                object_detect_result_list od_results;
+                const cv::Mat& frame = running_jobs[i].frame;
+                decode_yolov8_batch_outputs(ctx_, (int)i, &letter_boxes[slot][i], frame.cols, frame.rows,
+                                            &od_results);
+                if (on_result_) {
+                    on_result_(frame.size(), od_results);
+                }
+                finish(running_jobs[i], InferStatus::OK, od_results);
+            }
+        }
+
+        running = started;
+        if (started) {
+            running_jobs.swap(jobs);
+            next_slot ^= 1;
+        }
+    }
+}
+
+#endif // YOLOV8_PIPELINE_SUPPORTED
@@ -0,0 +1,153 @@
+#include "context_pool.h"
+#include <chrono>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#define CONTEXT_POOL_YIELD_TRIES 16   // 全部忙时阻塞前让出 CPU 重试的次数
+
+namespace {
+std::atomic<uint64_t> g_next_pool_id(1);
+}
+
+ContextPool::ContextPool(int first_index, int capacity, bool thread_affine)
+    : first_index_(first_index),
+      capacity_(capacity),
+      thread_affine_(thread_affine),
+      id_(g_next_pool_id++),
+      flags_(make_aligned_array<BusyFlag>(capacity > 0 ? capacity : 0)),
+      ready_(new int[capacity]) {}
+
+void ContextPool::add(int index) {
+    {
+        // 发布：先写下标再增加计数，借出方按计数访问
+        std::lock_guard<std::mutex> lock(add_mutex_);
+        int count = size_.load(std::memory_order_relaxed);
+        if (count >= capacity_ || index < first_index_ || index >= first_index_ + capacity_) {
+            return;
+        }
+        ready_[count] = index;
+        size_.store(count + 1);
+    }
+    // 排队者可能在等待第一个上下文
+    if (waiters_.load() > 0) {
+        std::lock_guard<std::mutex> lock(wait_mutex_);
+        wait_cond_.notify_all();
+    }
+}
+
+int ContextPool::size() const {
+    return size_.load(std::memory_order_acquire);
+}
+
+int ContextPool::at(int k) const {
+    return ready_[k];
+}
+
+int ContextPool::worker_slot() {
+    // 线程第一次在某个池借用时领取编号；一个线程可能为多个池（多个变体或模型）工作
+    static thread_local std::vector<std::pair<uint64_t, int>> slots;
+    for (const auto& slot : slots) {
+        if (slot.first == id_) {
+            return slot.second;
+        }
+    }
+    int worker = next_worker_++;
+    slots.push_back(std::make_pair(id_, worker));
+    return worker;
+}
+
+int ContextPool::try_acquire(int start, int count) {
+    for (int k = 0; k < count; ++k) {
+        int index = ready_[(start + k) % count];
+        std::atomic<bool>& busy = flags_[index - first_index_].busy;
+        bool expected = false;
+        if (!busy.load() && busy.compare_exchange_strong(expected, true)) {
+            return index;
+        }
+    }
+    return -1;
+}
+
+int ContextPool::checkout() {
+    int count = size_.load();
+    if (count == 0) {
+        return -1;
+    }
+    unsigned int start = thread_affine_ ? (unsigned int)worker_slot() : cursor_.fetch_add(1, std::memory_order_relaxed);
+
+    checkouts_.fetch_add(1, std::memory_order_relaxed);
+    int index = waiters_.load() > 0 ? -1 : try_acquire(start % count, count);
+    if (index >= 0) {
+        return index;
+    }
+
+    // 全部忙：先让出 CPU 重试（推理通常很快归还），已有人排队时不再抢
+    auto t0 = std::chrono::steady_clock::now();
+    for (int i = 0; i < CONTEXT_POOL_YIELD_TRIES && index < 0 && waiters_.load() == 0; ++i) {
+        std::this_thread::yield();
+        count = size_.load();
+        index = try_acquire(start % count, count);
+    }
+    if (index < 0) {
+        // 排队：只有队首取归还方交来的上下文或自己去抢；先登记等待者再检查，
+        // 与 checkin 的“先置空闲再看等待者”配对，不会漏掉唤醒
+        std::unique_lock<std::mutex> lock(wait_mutex_);
+        uint64_t ticket = next_ticket_++;
+        waiters_++;
+        wait_cond_.wait(lock, [&] {
+            if (serving_ != ticket) {
+                return false;
+            }
+            if (!handoff_.empty()) {
+                index = handoff_.back();
+                handoff_.pop_back();
+                return true;
+            }
+            count = size_.load();
+            index = try_acquire(start % count, count);
+            return index >= 0;
+        });
+        serving_++;
+        waiters_--;
+        // 下一个排队者成为队首
+        wait_cond_.notify_all();
+    }
+    record_wait((uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(
+                    std::chrono::steady_clock::now() - t0).count());
+    return index;
+}
+
+void ContextPool::checkin(int index) {
+    if (waiters_.load() > 0) {
+        // 有人排队：直接交给队首，忙标志保持占用
+        std::lock_guard<std::mutex> lock(wait_mutex_);
+        if (waiters_.load() > 0) {
+            handoff_.push_back(index);
+            wait_cond_.notify_all();
+            return;
+        }
+    }
+    flags_[index - first_index_].busy.store(false);
+    if (waiters_.load() > 0) {
+        std::lock_guard<std::mutex> lock(wait_mutex_);
+        wait_cond_.notify_all();
+    }
+}
+
+void ContextPool::record_wait(uint64_t wait_us) {
+    waits_.fetch_add(1, std::memory_order_relaxed);
+    total_wait_us_.fetch_add(wait_us, std::memory_order_relaxed);
+    uint64_t max = max_wait_us_.load(std::memory_order_relaxed);
+    while (wait_us > max && !max_wait_us_.compare_exchange_weak(max, wait_us, std::memory_order_relaxed)) {
+    }
+}
+
+ContextPoolStats ContextPool::stats() const {
+    ContextPoolStats stats;
+    stats.checkouts = checkouts_.load(std::memory_order_relaxed);
+    stats.waits = waits_.load(std::memory_order_relaxed);
+    stats.total_wait_us = total_wait_us_.load(std::memory_order_relaxed);
+    stats.max_wait_us = max_wait_us_.load(std::memory_order_relaxed);
+    return stats;
+}
@@ -0,0 +1,294 @@
+#include "inference_backend.h"
+
+#if defined(CPU_BACKEND_SUPPORTED)
+
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <vector>
+#include "common_utils.h"
+#include "preprocess.h"
+
+// ONNX 图没有给出固定输入尺寸（动态输入）时使用的输入边长
+#define CPU_BACKEND_DEFAULT_INPUT_SIZE 640
+// 第一个（网格最大的）分支的下采样倍数：模型输入尺寸 = 该分支网格 × 8
+#define CPU_BACKEND_MIN_STRIDE 8
+
+// CPU 后端：OpenCV DNN 运行同一 YOLOv8 ONNX 图（9 个或 6 个 NCHW float 输出，姿态模型 4 个），解码与 RKNN 后端共用 post_process
+// cv::dnn::Net 在 forward 时会修改内部状态，实例之间不共享，每个上下文各自加载模型文件
+class CpuDnnBackend : public InferenceBackend {
+public:
+    CpuDnnBackend() : input_buf_(nullptr) {
+        memset(&ctx_, 0, sizeof(rknn_app_context_t));
+        memset(outputs_, 0, sizeof(outputs_));
+    }
+    ~CpuDnnBackend() override {
+        deinit_post_process_ctx(&ctx_);
+        free(ctx_.input_attrs);
+        free(ctx_.output_attrs);
+        delete ctx_.input_cache;
+        free(input_buf_);
+    }
+
+    const char* name() const override {
+        return "opencv-dnn";
+    }
+
+    int init(const std::string& model_path) override {
+        try {
+            net_ = cv::dnn::readNetFromONNX(model_path);
+        } catch (const cv::Exception& e) {
+            safe_printf("readNetFromONNX fail: %s", e.what());
+            return -1;
+        }
+        if (net_.empty()) {
+            safe_printf("load onnx model fail: %s", model_path.c_str());
+            return -1;
+        }
+        net_.setPreferableBackend(cv::dnn::DNN_BACKEND_OPENCV);
+        net_.setPreferableTarget(cv::dnn::DNN_TARGET_CPU);
+        // getUnconnectedOutLayersNames 的顺序不保证与图的输出顺序一致，试推理后按形状重排
+        output_names_ = net_.getUnconnectedOutLayersNames();
+        int n_output = (int)output_names_.size();
+        // 姿态模型（YOLOv8-pose）为 3 个 box + 分数输出与 1 个关键点输出
+        if (n_output != 6 && n_output != 9 && n_output != 4) {
+            safe_printf("unexpected onnx output num: %d (expect 6 or 9, or 4 for pose)", n_output);
+            return -1;
+        }
+
+        // 输入尺寸取自 ONNX 图的输入形状（各分辨率变体导出的尺寸不同），动态输入时用默认值
+        int input_width = CPU_BACKEND_DEFAULT_INPUT_SIZE;
+        int input_height = CPU_BACKEND_DEFAULT_INPUT_SIZE;
+        if (!graph_input_size(&input_width, &input_height)) {
+            safe_printf("onnx input shape is not fixed, use %dx%d", input_width, input_height);
+        }
+        ctx_.model_width = input_width;
+        ctx_.model_height = input_height;
+        ctx_.model_channel = 3;
+        ctx_.is_quant = false;
+        input_buf_ = (unsigned char*)malloc(ctx_.model_width * ctx_.model_height * 3);
+        if (input_buf_ == nullptr) {
+            safe_printf("malloc input buffer fail!");
+            return -1;
+        }
+        ctx_.input_cache = new letterbox_cache();
+
+        // 以边框色填充的输入推理一次，得到输出形状（同时完成 DNN 的惰性初始化，首帧不再额外耗时）
+        memset(input_buf_, 114, ctx_.model_width * ctx_.model_height * 3);
+        if (forward() != 0) {
+            return -1;
+        }
+        for (int i = 0; i < n_output; ++i) {
+            const cv::Mat& out = outs_[i];
+            if (out.dims != 4 || out.type() != CV_32F) {
+                safe_printf("onnx output %d: expect 4-dim float tensor, got dims=%d type=%d", i, out.dims, out.type());
+                return -1;
+            }
+        }
+        if (!order_outputs_by_shape()) {
+            return -1;
+        }
+        // 网格最大的分支为 stride 8，与输入尺寸对照
+        if (outs_[0].size[2] * CPU_BACKEND_MIN_STRIDE != ctx_.model_height ||
+            outs_[0].size[3] * CPU_BACKEND_MIN_STRIDE != ctx_.model_width) {
+            safe_printf("onnx output grid %dx%d does not match input %dx%d (stride %d)", outs_[0].size[3],
+                        outs_[0].size[2], ctx_.model_width, ctx_.model_height, CPU_BACKEND_MIN_STRIDE);
+            return -1;
+        }
+
+        // 按 RKNN 通用布局描述输出：NCHW float32，post_process 选择 float 解码核
+        ctx_.io_num.n_input = 1;
+        ctx_.io_num.n_output = n_output;
+        ctx_.input_attrs = (rknn_tensor_attr*)calloc(1, sizeof(rknn_tensor_attr));
+        ctx_.output_attrs = (rknn_tensor_attr*)calloc(n_output, sizeof(rknn_tensor_attr));
+        if (ctx_.input_attrs == nullptr || ctx_.output_attrs == nullptr) {
+            safe_printf("malloc tensor attrs fail!");
+            return -1;
+        }
+        rknn_tensor_attr* input_attr = &ctx_.input_attrs[0];
+        input_attr->n_dims = 4;
+        input_attr->dims[0] = 1;
+        input_attr->dims[1] = ctx_.model_height;
+        input_attr->dims[2] = ctx_.model_width;
+        input_attr->dims[3] = ctx_.model_channel;
+        input_attr->n_elems = ctx_.model_width * ctx_.model_height * ctx_.model_channel;
+        input_attr->size = input_attr->n_elems;
+        input_attr->fmt = RKNN_TENSOR_NHWC;
+        input_attr->type = RKNN_TENSOR_UINT8;
+        input_attr->qnt_type = RKNN_TENSOR_QNT_NONE;
+        for (int i = 0; i < n_output; ++i) {
+            const cv::Mat& out = outs_[i];
+            rknn_tensor_attr* attr = &ctx_.output_attrs[i];
+            attr->index = i;
+            attr->n_dims = 4;
+            for (int d = 0; d < 4; ++d) {
+                attr->dims[d] = out.size[d];
+            }
+            attr->n_elems = (uint32_t)out.total();
+            attr->size = attr->n_elems * sizeof(float);
+            attr->fmt = RKNN_TENSOR_NCHW;
+            attr->type = RKNN_TENSOR_FLOAT32;
+            attr->qnt_type = RKNN_TENSOR_QNT_NONE;
+            attr->scale = 1.0f;
+            strncpy(attr->name, output_names_[i].c_str(), RKNN_MAX_NAME_LEN - 1);
+        }
+
+        int ret = init_post_process_ctx(&ctx_);
+        if (ret < 0) {
+            safe_printf("init_post_process_ctx fail! ret=%d", ret);
+            return -1;
+        }
+        safe_printf("CPU backend ready: %s, input %dx%d, %d outputs", model_path.c_str(), ctx_.model_width,
+                    ctx_.model_height, n_output);
+        return 0;
+    }
+
+    int run(const cv::Mat& frame, letterbox_t* letter_box) override {
+        int ret = letterbox_bgr_to_rgb(*ctx_.input_cache, frame.data, frame.cols, frame.rows, (int)frame.step,
+                                       input_buf_, ctx_.model_width, ctx_.model_height, ctx_.model_width * 3, 114,
+                                       letter_box);
+        if (ret < 0) {
+            return -1;
+        }
+        return forward();
+    }
+
+    rknn_app_context_t* model_context() override {
+        return &ctx_;
+    }
+
+    void* outputs() override {
+        return outputs_;
+    }
+
+private:
+    // ONNX 图中固定的输入尺寸（NCHW），输入为动态尺寸或无法推断时返回 false
+    bool graph_input_size(int* width, int* height) {
+        std::vector<cv::dnn::MatShape> in_shapes;
+        std::vector<cv::dnn::MatShape> out_shapes;
+        try {
+            // 第 0 层为网络输入，不给输入形状时取导入模型时记录的形状
+            net_.getLayerShapes(cv::dnn::MatShape(), 0, in_shapes, out_shapes);
+        } catch (const cv::Exception&) {
+            return false;
+        }
+        if (out_shapes.empty() || out_shapes[0].size() != 4 || out_shapes[0][2] <= 0 || out_shapes[0][3] <= 0) {
+            return false;
+        }
+        *height = out_shapes[0][2];
+        *width = out_shapes[0][3];
+        return true;
+    }
+
+    // 把 outs_ / output_names_ 重排为 post_process 要求的顺序：分支按网格从大到小（stride 8 / 16 / 32），
+    // 分支内依次为 box（4 * dfl_len 通道）、score（class_num 通道）、score_sum（1 通道）；
+    // 姿态模型为 3 个分支（4 * dfl_len + 1 通道）后接关键点输出 [N, 关键点数, 3, 网格总数]
+    bool order_outputs_by_shape() {
+        int n_output = (int)outs_.size();
+        std::vector<int> branch;   // 分支输出的下标
+        int keypoints = -1;        // 姿态模型的关键点输出
+        if (n_output == 4) {
+            for (int i = 0; i < n_output; ++i) {
+                int anchors = 0;
+                for (int j = 0; j < n_output; ++j) {
+                    if (j != i) {
+                        anchors += outs_[j].size[2] * outs_[j].size[3];
+                    }
+                }
+                if (keypoints < 0 && outs_[i].size[2] == 3 && outs_[i].size[3] == anchors) {
+                    keypoints = i;
+                } else {
+                    branch.push_back(i);
+                }
+            }
+            if (keypoints < 0) {
+                safe_printf("pose onnx model: keypoint output [N, K, 3, anchors] not found");
+                return false;
+            }
+        } else {
+            for (int i = 0; i < n_output; ++i) {
+                branch.push_back(i);
+            }
+        }
+
+        // 分支内的输出在网格相同的输出中按通道区分；网格从大到小稳定排序，同一网格内保持图中的先后
+        int per_branch = (int)branch.size() / 3;
+        std::stable_sort(branch.begin(), branch.end(), [this](int a, int b) {
+            return outs_[a].size[2] * outs_[a].size[3] > outs_[b].size[2] * outs_[b].size[3];
+        });
+        std::vector<int> order;
+        for (int b = 0; b < 3; ++b) {
+            std::vector<int> group(branch.begin() + b * per_branch, branch.begin() + (b + 1) * per_branch);
+            int grid = outs_[group[0]].size[2] * outs_[group[0]].size[3];
+            for (int idx : group) {
+                if (outs_[idx].size[2] * outs_[idx].size[3] != grid) {
+                    safe_printf("onnx outputs do not form 3 branches of %d outputs with equal grids", per_branch);
+                    return false;
+                }
+            }
+            if (per_branch > 1) {
+                // score_sum 为 1 通道，排到最后
+                std::stable_sort(group.begin(), group.end(), [this](int a, int c) {
+                    return (outs_[a].size[1] == 1) < (outs_[c].size[1] == 1);
+                });
+                // box 为 4 * dfl_len 通道（YOLOv8 的 dfl_len 为 16）；两个都可能时优先 64 通道，否则保持图中的先后
+                int first = outs_[group[0]].size[1];
+                int second = outs_[group[1]].size[1];
+                bool first_box = first % 4 == 0 && first / 4 <= DFL_LEN_MAX;
+                bool second_box = second % 4 == 0 && second / 4 <= DFL_LEN_MAX;
+                if ((second_box && !first_box) || (first_box && second_box && second == 64 && first != 64)) {
+                    std::swap(group[0], group[1]);
+                }
+            }
+            order.insert(order.end(), group.begin(), group.end());
+        }
+        if (keypoints >= 0) {
+            order.push_back(keypoints);
+        }
+
+        std::vector<cv::Mat> outs(n_output);
+        std::vector<std::string> names(n_output);
+        for (int i = 0; i < n_output; ++i) {
+            outs[i] = outs_[order[i]];
+            names[i] = output_names_[order[i]];
+        }
+        outs_.swap(outs);
+        output_names_.swap(names);
+        return true;
+    }
+
+    // input_buf_（letterbox 后的 RGB888）→ 输出张量，outputs_ 指向本次 forward 的结果
+    int forward() {
+        cv::Mat image(ctx_.model_height, ctx_.model_width, CV_8UC3, input_buf_);
+        // RKNN 模型在 NPU 上做的归一化（/255）在这里完成；输入已是 RGB，不再交换通道
+        cv::dnn::blobFromImage(image, blob_, 1.0 / 255.0, cv::Size(), cv::Scalar(), false, false, CV_32F);
+        try {
+            net_.setInput(blob_);
+            net_.forward(outs_, output_names_);
+        } catch (const cv::Exception& e) {
+            safe_printf("onnx forward fail: %s", e.what());
+            return -1;
+        }
+        for (size_t i = 0; i < outs_.size(); ++i) {
+            outputs_[i].index = (uint32_t)i;
+            outputs_[i].want_float = 1;
+            outputs_[i].buf = outs_[i].ptr<float>();
+            outputs_[i].size = (uint32_t)(outs_[i].total() * sizeof(float));
+        }
+        return 0;
+    }
+
+    rknn_app_context_t ctx_;                // 输出描述与后处理状态（不含 rknn 运行时句柄）
+    cv::dnn::Net net_;
+    std::vector<std::string> output_names_;
+    unsigned char* input_buf_;
+    cv::Mat blob_;
+    std::vector<cv::Mat> outs_;
+    rknn_output outputs_[9];
+};
+
+InferenceBackend* create_cpu_dnn_backend() {
+    return new CpuDnnBackend();
+}
+
+#endif // CPU_BACKEND_SUPPORTED
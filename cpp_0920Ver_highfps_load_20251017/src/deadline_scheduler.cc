@@ -0,0 +1,44 @@
+#include "deadline_scheduler.h"
+#include <utility>
+
+void DeadlineScheduler::put(Clock::time_point deadline, Task task) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        entries_.push(Entry{deadline, next_seq_++, std::move(task)});
+    }
+    // 令牌与任务一一对应，令牌本身不携带任务
+    pool_->put([this]() {
+        run_next();
+    });
+}
+
+void DeadlineScheduler::run_next() {
+    Task task;
+    Clock::time_point deadline;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (entries_.empty()) {
+            return;
+        }
+        // top() 只给出常量引用，出堆前移走任务，避免拷贝其捕获的帧与 promise
+        deadline = entries_.top().deadline;
+        task = std::move(const_cast<Entry&>(entries_.top()).task);
+        entries_.pop();
+    }
+    // 排队期间已过截止时间的任务直接交付跳过，不再占用上下文
+    task(Clock::now() > deadline);
+}
+
+void DeadlineScheduler::cancel_all() {
+    std::vector<Task> tasks;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        while (!entries_.empty()) {
+            tasks.push_back(std::move(const_cast<Entry&>(entries_.top()).task));
+            entries_.pop();
+        }
+    }
+    for (auto& task : tasks) {
+        task(true);
+    }
+}
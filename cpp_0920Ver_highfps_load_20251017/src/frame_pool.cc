@@ -0,0 +1,71 @@
+#include "frame_pool.h"
+#include "common_utils.h"
+
+bool FramePool::init(int capacity, int width, int height, int type) {
+    if (capacity <= 0 || width <= 0 || height <= 0) {
+        safe_printf("FramePool: invalid capacity %d or frame size %dx%d", capacity, width, height);
+        return false;
+    }
+    std::shared_ptr<State> state(new State());
+    state->frames.resize(capacity);
+    state->buffers.resize(capacity);
+    for (int i = capacity - 1; i >= 0; --i) {
+        state->frames[i].create(height, width, type);
+        state->buffers[i] = state->frames[i].data;
+        state->free.push_back(i);
+    }
+    state_ = state;
+    safe_printf("FramePool initialized: %d buffers of %dx%d", capacity, width, height);
+    return true;
+}
+
+FrameRef FramePool::acquire() {
+    if (!state_) {
+        return FrameRef();
+    }
+    std::shared_ptr<State> state = state_;
+    int index;
+    {
+        std::lock_guard<std::mutex> lock(state->mutex);
+        if (state->free.empty()) {
+            state->stats.exhausted++;
+            return FrameRef();
+        }
+        index = state->free.back();
+        state->free.pop_back();
+        state->stats.acquired++;
+    }
+    // 引用指向池中的 Mat，释放时只归还下标，不析构缓冲区
+    return FrameRef(&state->frames[index], [state, index](cv::Mat*) {
+        state->release(index);
+    });
+}
+
+void FramePool::State::release(int index) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (frames[index].data != buffers[index]) {
+        buffers[index] = frames[index].data;
+        stats.reallocated++;
+    }
+    free.push_back(index);
+}
+
+int FramePool::capacity() const {
+    return state_ ? (int)state_->frames.size() : 0;
+}
+
+int FramePool::available() const {
+    if (!state_) {
+        return 0;
+    }
+    std::lock_guard<std::mutex> lock(state_->mutex);
+    return (int)state_->free.size();
+}
+
+FramePoolStats FramePool::stats() const {
+    if (!state_) {
+        return FramePoolStats();
+    }
+    std::lock_guard<std::mutex> lock(state_->mutex);
+    return state_->stats;
+}
@@ -0,0 +1,122 @@
+#include "inference_backend.h"
+#include "common_utils.h"
+#include "tensor_capture.h"
+#include <ctype.h>
+#include <string.h>
+
+int InferenceBackend::infer(const cv::Mat& frame, object_detect_result_list* od_results) {
+    memset(od_results, 0, sizeof(object_detect_result_list));
+    letterbox_t letter_box;
+    int ret = run(frame, &letter_box);
+    if (ret < 0) {
+        return ret;
+    }
+    tensor_capture_frame(model_context(), outputs(), &letter_box, frame.cols, frame.rows);
+    return post_process(model_context(), outputs(), &letter_box, BOX_THRESH, NMS_THRESH, od_results);
+}
+
+#if defined(ENABLE_RKNN_BACKEND)
+
+// RKNN 后端：上下文即 rknn_app_context_t，各平台的差异由编译进来的 rknpu 实现处理
+class RknnBackend : public InferenceBackend {
+public:
+    RknnBackend() {
+        memset(&ctx_, 0, sizeof(rknn_app_context_t));
+    }
+    ~RknnBackend() override {
+        release_yolov8_model(&ctx_);
+    }
+
+    const char* name() const override {
+        return "rknn";
+    }
+
+    int init(const std::string& model_path) override {
+        int ret = init_yolov8_model(model_path.c_str(), &ctx_);
+        if (ret != 0) {
+            reset();  // 释放初始化失败时已申请的部分
+        }
+        return ret;
+    }
+
+    int init_from(InferenceBackend& src) override {
+        RknnBackend* rknn_src = dynamic_cast<RknnBackend*>(&src);
+        if (rknn_src == nullptr) {
+            return -1;
+        }
+        int ret = dup_yolov8_model(&rknn_src->ctx_, &ctx_);
+        if (ret != 0) {
+            reset();
+        }
+        return ret;
+    }
+
+    int run(const cv::Mat& frame, letterbox_t* letter_box) override {
+        return run_yolov8_model_bgr(&ctx_, frame.data, frame.cols, frame.rows, (int)frame.step, letter_box);
+    }
+
+    rknn_app_context_t* model_context() override {
+        return &ctx_;
+    }
+
+    void* outputs() override {
+        return yolov8_model_outputs(&ctx_);
+    }
+
+    bool supports_pipeline() const override {
+#if defined(YOLOV8_PIPELINE_SUPPORTED)
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    int infer(const cv::Mat& frame, object_detect_result_list* od_results) override {
+        return inference_yolov8_model_bgr(&ctx_, frame.data, frame.cols, frame.rows, (int)frame.step, od_results);
+    }
+
+private:
+    void reset() {
+        release_yolov8_model(&ctx_);
+        memset(&ctx_, 0, sizeof(rknn_app_context_t));
+    }
+
+    rknn_app_context_t ctx_;
+};
+
+InferenceBackend* create_rknn_backend() {
+    return new RknnBackend();
+}
+
+#endif // ENABLE_RKNN_BACKEND
+
+static bool has_suffix(const std::string& str, const char* suffix) {
+    size_t len = strlen(suffix);
+    if (str.size() < len) {
+        return false;
+    }
+    for (size_t i = 0; i < len; ++i) {
+        if (tolower((unsigned char)str[str.size() - len + i]) != suffix[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+InferenceBackend* create_inference_backend(const std::string& model_path) {
+    if (has_suffix(model_path, ".onnx")) {
+#if defined(CPU_BACKEND_SUPPORTED)
+        return create_cpu_dnn_backend();
+#else
+        safe_printf("ONNX model requires the CPU backend (build with -DENABLE_CPU_BACKEND=ON, generic RKNPU2 layout only): %s",
+                    model_path.c_str());
+        return nullptr;
+#endif
+    }
+#if defined(ENABLE_RKNN_BACKEND)
+    return create_rknn_backend();
+#else
+    safe_printf("RKNN backend not built (ENABLE_RKNN_BACKEND=OFF), cannot load: %s", model_path.c_str());
+    return nullptr;
+#endif
+}
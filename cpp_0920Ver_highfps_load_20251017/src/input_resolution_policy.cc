@@ -0,0 +1,91 @@
+#include "input_resolution_policy.h"
+#include "common_utils.h"
+#include <algorithm>
+
+void InputResolutionPolicy::set_config(const InputPolicyConfig& config) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    config_ = config;
+}
+
+void InputResolutionPolicy::set_variant_input(int variant, int width, int height) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if ((int)variants_.size() <= variant) {
+        variants_.resize(variant + 1);
+    }
+    variants_[variant].width = width;
+    variants_[variant].height = height;
+}
+
+int InputResolutionPolicy::choose() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    frame_count_++;
+    if (current_ != 0 && config_.probe_interval > 0 && frame_count_ % config_.probe_interval == 0) {
+        return 0;
+    }
+    return current_;
+}
+
+int InputResolutionPolicy::current() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return current_;
+}
+
+int InputResolutionPolicy::smallest_allowed(int count, int min_side, int src_width, int src_height) const {
+    int best = 0;
+    if (count > config_.max_objects || src_width <= 0 || src_height <= 0) {
+        return best;
+    }
+    for (int v = 1; v < (int)variants_.size(); ++v) {
+        const VariantInput& input = variants_[v];
+        if (!input.ready() || (variants_[best].ready() && input.area() >= variants_[best].area())) {
+            continue;
+        }
+        // 目标经 letterbox 缩放到该输入后的短边
+        float scale = std::min((float)input.width / src_width, (float)input.height / src_height);
+        if (count == 0 || min_side * scale >= config_.min_object_px) {
+            best = v;
+        }
+    }
+    return best;
+}
+
+void InputResolutionPolicy::observe(const object_detect_result_list& od_results, int src_width, int src_height) {
+    int min_side = 0;
+    for (int i = 0; i < od_results.count; ++i) {
+        const image_rect_t& box = od_results.results[i].box;
+        int side = std::min(box.right - box.left, box.bottom - box.top);
+        min_side = i == 0 ? side : std::min(min_side, side);
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (variants_.empty()) {
+        return;
+    }
+    int allowed = smallest_allowed(od_results.count, min_side, src_width, src_height);
+    int current_area = variants_[current_].area();
+    int allowed_area = variants_[allowed].area();
+    if (allowed_area > current_area || allowed == 0) {
+        // 出现小目标或目标变多：立即升到允许的分辨率
+        calm_count_ = 0;
+        if (allowed != current_) {
+            current_ = allowed;
+            safe_printf("Input resolution -> %dx%d (variant %d, %d objects, min side %d px)",
+                        variants_[current_].width, variants_[current_].height, current_, od_results.count, min_side);
+        }
+        return;
+    }
+    if (allowed == current_) {
+        calm_count_ = 0;
+        return;
+    }
+    // 可以更低：连续 calm_frames 帧都允许时，降到这些帧共同允许的分辨率
+    if (calm_count_ == 0 || allowed_area > variants_[calm_target_].area()) {
+        calm_target_ = allowed;
+    }
+    if (++calm_count_ >= config_.calm_frames) {
+        calm_count_ = 0;
+        current_ = calm_target_;
+        safe_printf("Input resolution -> %dx%d (variant %d, sparse scene)", variants_[current_].width,
+                    variants_[current_].height, current_);
+    }
+}
@@ -0,0 +1,216 @@
+#include "logger.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#define LOG_RING_CAPACITY 256      // 每个线程缓冲的日志条数（2 的幂）
+#define LOG_ENTRY_SIZE 256         // 单条日志的最大长度，超出截断
+#define LOG_DRAIN_INTERVAL_MS 2    // 后台线程的汇总周期
+
+std::atomic<int> g_log_level(LOG_LEVEL_INFO);
+
+namespace {
+
+struct LogEntry {
+    int level;
+    int len;
+    char text[LOG_ENTRY_SIZE];
+};
+
+// 单生产者（所属线程）单消费者（持 drain_mutex_ 的汇总方）环形缓冲区
+struct LogRing {
+    LogEntry entries[LOG_RING_CAPACITY];
+    std::atomic<uint32_t> head{0};      // 生产者写入位置
+    std::atomic<uint32_t> tail{0};      // 消费者读取位置
+    std::atomic<uint32_t> dropped{0};   // 缓冲区满时丢弃的条数
+    std::atomic<bool> closed{false};    // 所属线程已退出，读空后移除
+};
+
+const char* level_prefix(int level) {
+    switch (level) {
+        case LOG_LEVEL_DEBUG: return "[DEBUG] ";
+        case LOG_LEVEL_WARN: return "[WARN] ";
+        case LOG_LEVEL_ERROR: return "[ERROR] ";
+        default: return "";
+    }
+}
+
+class Logger {
+public:
+    // 不析构：退出阶段的静态对象析构时仍可能写日志；atexit 时停止后台线程并输出剩余日志
+    static Logger& instance() {
+        static Logger* logger = new Logger();
+        return *logger;
+    }
+
+    bool running() const {
+        return running_.load(std::memory_order_acquire);
+    }
+
+    // 当前线程的缓冲区；线程退出阶段（thread_local 已析构）返回 nullptr
+    LogRing* thread_ring() {
+        // 线程退出时标记缓冲区关闭，由后台线程读空后释放
+        static thread_local bool released = false;
+        struct RingHandle {
+            std::shared_ptr<LogRing> ring;
+            ~RingHandle() {
+                released = true;
+                if (ring) {
+                    ring->closed.store(true, std::memory_order_release);
+                }
+            }
+        };
+        if (released) {
+            return nullptr;
+        }
+        static thread_local RingHandle handle;
+        if (!handle.ring) {
+            handle.ring = std::make_shared<LogRing>();
+            std::lock_guard<std::mutex> lock(rings_mutex_);
+            rings_.push_back(handle.ring);
+        }
+        return handle.ring.get();
+    }
+
+    void flush() {
+        std::lock_guard<std::mutex> lock(drain_mutex_);
+        drain_locked();
+    }
+
+    void stop() {
+        {
+            std::lock_guard<std::mutex> lock(wake_mutex_);
+            stop_ = true;
+        }
+        wake_.notify_all();
+        if (thread_.joinable()) {
+            thread_.join();
+        }
+        running_.store(false, std::memory_order_release);
+        flush();
+    }
+
+private:
+    Logger() : stop_(false), running_(true) {
+        thread_ = std::thread(&Logger::worker, this);
+        atexit([] { Logger::instance().stop(); });
+    }
+
+    void worker() {
+        std::unique_lock<std::mutex> lock(wake_mutex_);
+        while (!stop_) {
+            wake_.wait_for(lock, std::chrono::milliseconds(LOG_DRAIN_INTERVAL_MS));
+            lock.unlock();
+            flush();
+            lock.lock();
+        }
+    }
+
+    // 读出所有线程的日志并一次写到 stdout；调用方持有 drain_mutex_
+    void drain_locked() {
+        out_.clear();
+        {
+            std::lock_guard<std::mutex> lock(rings_mutex_);
+            for (size_t i = 0; i < rings_.size();) {
+                LogRing& ring = *rings_[i];
+                // 先读 closed：线程退出前写入的日志此时都已可见
+                bool closed = ring.closed.load(std::memory_order_acquire);
+                uint32_t tail = ring.tail.load(std::memory_order_relaxed);
+                uint32_t head = ring.head.load(std::memory_order_acquire);
+                for (; tail != head; ++tail) {
+                    const LogEntry& entry = ring.entries[tail & (LOG_RING_CAPACITY - 1)];
+                    out_.append(level_prefix(entry.level));
+                    out_.append(entry.text, entry.len);
+                    out_.push_back('\n');
+                }
+                ring.tail.store(tail, std::memory_order_release);
+                uint32_t dropped = ring.dropped.exchange(0, std::memory_order_relaxed);
+                if (dropped > 0) {
+                    out_.append("[WARN] log buffer full, ").append(std::to_string(dropped)).append(" messages dropped\n");
+                }
+                if (closed) {
+                    rings_.erase(rings_.begin() + i);
+                } else {
+                    ++i;
+                }
+            }
+        }
+        if (!out_.empty()) {
+            fwrite(out_.data(), 1, out_.size(), stdout);
+            fflush(stdout);
+        }
+    }
+
+    std::mutex rings_mutex_;
+    std::vector<std::shared_ptr<LogRing>> rings_;
+    std::mutex drain_mutex_;
+    std::string out_;
+    std::mutex wake_mutex_;
+    std::condition_variable wake_;
+    bool stop_;
+    std::atomic<bool> running_;
+    std::thread thread_;
+};
+
+}  // namespace
+
+void log_set_level(int level) {
+    g_log_level.store(level, std::memory_order_relaxed);
+}
+
+void log_vwrite(int level, const char* format, va_list args) {
+    if (!log_enabled(level)) {
+        return;
+    }
+    Logger& logger = Logger::instance();
+    LogRing* ring = logger.running() ? logger.thread_ring() : nullptr;
+    if (ring == nullptr) {
+        // 进程或线程退出阶段：直接输出
+        printf("%s", level_prefix(level));
+        vprintf(format, args);
+        printf("\n");
+        return;
+    }
+    uint32_t head = ring->head.load(std::memory_order_relaxed);
+    if (head - ring->tail.load(std::memory_order_acquire) >= LOG_RING_CAPACITY) {
+        ring->dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    LogEntry& entry = ring->entries[head & (LOG_RING_CAPACITY - 1)];
+    int len = vsnprintf(entry.text, sizeof(entry.text), format, args);
+    entry.len = len < 0 ? 0 : (len < (int)sizeof(entry.text) ? len : (int)sizeof(entry.text) - 1);
+    entry.level = level;
+    ring->head.store(head + 1, std::memory_order_release);
+}
+
+void log_write(int level, const char* format, ...) {
+    va_list args;
+    va_start(args, format);
+    log_vwrite(level, format, args);
+    va_end(args);
+}
+
+void log_flush() {
+    Logger& logger = Logger::instance();
+    if (logger.running()) {
+        logger.flush();
+    }
+}
+
+bool LogThrottle::allow(uint32_t* suppressed) {
+    int64_t now = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                      std::chrono::steady_clock::now().time_since_epoch()).count();
+    int64_t next = next_ns_.load(std::memory_order_relaxed);
+    if (now < next || !next_ns_.compare_exchange_strong(next, now + interval_ns_, std::memory_order_relaxed)) {
+        suppressed_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    *suppressed = suppressed_.exchange(0, std::memory_order_relaxed);
+    return true;
+}
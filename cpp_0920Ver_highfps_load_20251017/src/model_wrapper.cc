@@ -1,67 +1,449 @@
 #include "model_wrapper.h"
 #include "common_utils.h"
+#include "logger.h"
 #include "image_utils.h"
 #include <mutex>
 #include <atomic>
+#include <algorithm>
 #include <opencv2/opencv.hpp>
 
 Yolov8Model::~Yolov8Model() {
     release();
 }
 
-bool Yolov8Model::init(const std::string& model_path, int thread_num) {
+bool Yolov8Model::init(const std::string& model_path, int thread_num, bool pipelined) {
     // 初始化线程池
     thread_pool_ = new ThreadPool(thread_num);
     if (!thread_pool_) {
         safe_printf("Failed to create thread pool");
         return false;
     }
+    scheduler_.reset(new DeadlineScheduler(thread_pool_));
 
-    // 初始化多线程模型上下文
-    model_contexts_.clear();
-    for (int i = 0; i < thread_num; ++i) {
-        rknn_app_context_t ctx;
-        memset(&ctx, 0, sizeof(rknn_app_context_t));
-        int ret = init_yolov8_model(model_path.c_str(), &ctx);
+    // 变体：[0] 为全分辨率模型，其后为 add_input_variant 登记的较小输入模型，最后为级联第二阶段模型，
+    // 各自占一段连续的上下文槽位
+    variants_.clear();
+    int total = 0;
+    std::vector<std::pair<std::string, int>> requests;
+    requests.push_back(std::make_pair(model_path, thread_num));
+    requests.insert(requests.end(), variant_requests_.begin(), variant_requests_.end());
+    cascade_variant_ = -1;
+    if (cascade_request_.second > 0) {
+        cascade_variant_ = (int)requests.size();
+        requests.push_back(cascade_request_);
+    }
+    for (const auto& request : requests) {
+        std::unique_ptr<InputVariant> variant(new InputVariant());
+        variant->model_path = request.first;
+        variant->cascade = (int)variants_.size() == cascade_variant_;
+        variant->first_index = total;
+        variant->context_num = request.second;
+        variant->contexts.reset(new ContextPool(total, request.second, thread_affine_));
+        total += request.second;
+        variants_.push_back(std::move(variant));
+    }
+
+    // 上下文槽位一次分配好，之后只填充、不增删（后台初始化与推理任务可以安全地按下标访问）
+    backends_.clear();
+    backends_.resize(total);
+    pipelined_ = false;
+#if defined(YOLOV8_PIPELINE_SUPPORTED)
+    // 后端不支持时由第一个上下文的初始化关闭
+    pipelined_ = pipelined;
+    if (pipelined_) {
+        pipelines_.resize(total);
+    }
+#endif
+
+    // 第一个上下文同步加载模型文件，就绪后即可接收推理任务
+    if (!init_context(0, 0)) {
+        release();
+        return false;
+    }
+    if (pipelined && !pipelined_) {
+        safe_printf("Pipelined mode not supported by %s backend, fall back to sequential mode", backends_[0]->name());
+    }
+
+    // 其余上下文在专用线程上并行初始化（由第一个上下文派生），逐个加入服务；
+    // 不占用线程池，否则初始化任务与推理任务同在一个先进先出队列，启动阶段的推理会排在耗时的加载之后
+    for (int i = 1; i < thread_num; ++i) {
+        init_threads_.emplace_back([this, i]() {
+            init_context(0, i);
+        });
+    }
+    // 每个变体一个线程：先加载第一个上下文，其余由它派生
+    for (int v = 1; v < (int)variants_.size(); ++v) {
+        init_threads_.emplace_back([this, v]() {
+            const InputVariant& variant = *variants_[v];
+            for (int i = variant.first_index; i < variant.first_index + variant.context_num; ++i) {
+                if (!init_context(v, i) && i == variant.first_index) {
+                    break;
+                }
+            }
+        });
+    }
+
+    is_inited_ = true;
+    safe_printf("Model initialized: %s, thread num: %d (1 ready, others initializing), %d input variants%s",
+                model_path.c_str(), thread_num, input_variant_count() - 1,
+                cascade_variant_ >= 0 ? ", cascade stage" : "");
+    return true;
+}
+
+void Yolov8Model::add_input_variant(const std::string& model_path, int context_num) {
+    if (is_inited_) {
+        safe_printf("add_input_variant must be called before init: %s", model_path.c_str());
+        return;
+    }
+    if (context_num > 0) {
+        variant_requests_.push_back(std::make_pair(model_path, context_num));
+    }
+}
+
+void Yolov8Model::set_input_policy(const InputPolicyConfig& config) {
+    input_policy_.set_config(config);
+}
+
+void Yolov8Model::set_cascade_model(const std::string& model_path, const CascadeConfig& config, int context_num) {
+    if (is_inited_) {
+        safe_printf("set_cascade_model must be called before init: %s", model_path.c_str());
+        return;
+    }
+    cascade_request_ = std::make_pair(model_path, context_num > 0 ? context_num : 1);
+    cascade_.set_config(config);
+}
+
+void Yolov8Model::set_batch_max_wait(int max_wait_ms) {
+    batch_max_wait_ms_ = max_wait_ms > 0 ? max_wait_ms : 0;
+}
+
+void Yolov8Model::set_thread_affine(bool thread_affine) {
+    thread_affine_ = thread_affine;
+}
+
+void Yolov8Model::set_frame_deadline(int deadline_ms) {
+    frame_deadline_ms_ = deadline_ms > 0 ? deadline_ms : 0;
+}
+
+bool Yolov8Model::init_context(int variant_id, int index) {
+    InputVariant& variant = *variants_[variant_id];
+    std::unique_ptr<InferenceBackend> backend(create_inference_backend(variant.model_path));
+    if (!backend) {
+        return false;
+    }
+    int ret = -1;
+    // 由变体的第一个上下文派生（共享权重与属性表），不支持时各自加载模型文件
+    if (index > variant.first_index && variant.dup_supported) {
+        ret = backend->init_from(*backends_[variant.first_index]);
         if (ret != 0) {
-            safe_printf("Failed to init model context (thread %d), ret=%d", i, ret);
-            release();  // 释放已初始化的上下文
+            safe_printf("Context dup not available for %s backend, load model for each context", backend->name());
+            variant.dup_supported = false;
+        }
+    }
+    if (ret != 0) {
+        ret = backend->init(variant.model_path);
+    }
+    if (ret != 0) {
+        safe_printf("Failed to init %s model context (thread %d), ret=%d", backend->name(), index, ret);
+        return false;
+    }
+
+#if defined(YOLOV8_PIPELINE_SUPPORTED)
+    if (pipelined_ && !variant.cascade) {
+        if (backend->supports_pipeline()) {
+            ContextPipeline::ResultCallback on_result;
+            if (input_variant_count() > 1) {
+                on_result = [this](const cv::Size& size, const object_detect_result_list& od_results) {
+                    input_policy_.observe(od_results, size.width, size.height);
+                };
+            }
+            rknn_app_context_t* ctx = backend->model_context();
+            pipelines_[index].reset(new ContextPipeline(ctx, on_result, batch_max_wait_ms_));
+            if (ctx->batch > 1 && index == variant.first_index) {
+                safe_printf("Batched inference: %s, batch %d, max wait %d ms", variant.model_path.c_str(), ctx->batch,
+                            batch_max_wait_ms_);
+            }
+        } else if (index == 0) {
+            // 第一个上下文决定运行模式，其余上下文创建前即退回顺序执行
+            pipelined_ = false;
+        } else {
+            safe_printf("%s backend cannot run pipelined, context %d (%s) not used", backend->name(), index,
+                        variant.model_path.c_str());
             return false;
         }
-        model_contexts_.push_back(ctx);
+    } else if (index == 0 && backend->supports_pipeline() && backend->model_context()->batch > 1) {
+        safe_printf("Model batch is %d but pipelined mode is off, running one frame per inference",
+                    backend->model_context()->batch);
     }
+#endif
+    backends_[index] = std::move(backend);
 
-    is_inited_ = true;
-    safe_printf("Model initialized: %s, thread num: %d", model_path.c_str(), thread_num);
+    // 变体的第一个上下文（派生源，总是最先就绪）：输入尺寸先登记到策略，加入池后变体才会被选择
+    rknn_app_context_t* ctx = backends_[index]->model_context();
+    if (index == variant.first_index && !variant.cascade) {
+        input_policy_.set_variant_input(variant_id, ctx->model_width, ctx->model_height);
+    }
+    variant.contexts->add(index);
+    if (index != variant.first_index) {
+        safe_printf("Model context %d ready, %d contexts serving", index, variant.contexts->size());
+    } else if (variant.cascade) {
+        safe_printf("Cascade model ready: %s, input %dx%d, batch %d", variant.model_path.c_str(), ctx->model_width,
+                    ctx->model_height, backends_[index]->supports_pipeline() ? ctx->batch : 1);
+    } else if (variant_id > 0) {
+        safe_printf("Input variant %d ready: %s, input %dx%d", variant_id, variant.model_path.c_str(),
+                    ctx->model_width, ctx->model_height);
+    }
     return true;
 }
 
+int Yolov8Model::ready_context_count() const {
+    int count = 0;
+    for (const auto& variant : variants_) {
+        count += variant->contexts->size();
+    }
+    return count;
+}
+
+uint64_t Yolov8Model::skipped_task_count() const {
+    uint64_t count = skipped_count_.load();
+#if defined(YOLOV8_PIPELINE_SUPPORTED)
+    for (const auto& pipeline : pipelines_) {
+        if (pipeline) {
+            count += pipeline->skipped();
+        }
+    }
+#endif
+    return count;
+}
+
+ContextPoolStats Yolov8Model::context_wait_stats() const {
+    ContextPoolStats total;
+    for (const auto& variant : variants_) {
+        ContextPoolStats stats = variant->contexts->stats();
+        total.checkouts += stats.checkouts;
+        total.waits += stats.waits;
+        total.total_wait_us += stats.total_wait_us;
+        total.max_wait_us = std::max(total.max_wait_us, stats.max_wait_us);
+    }
+    return total;
+}
+
+PoseResults Yolov8Model::run_cascade(const cv::Mat& frame, std::chrono::steady_clock::time_point deadline,
+                                     const object_detect_result_list& od_results) {
+    std::vector<CascadeCrop> crops;
+    if (cascade_variant_ < 0 || cascade_.select(od_results, frame.cols, frame.rows, crops) == 0) {
+        return PoseResults();
+    }
+    ContextPool& contexts = *variants_[cascade_variant_]->contexts;
+    if (contexts.size() == 0) {
+        return PoseResults();
+    }
+    // 一帧的所有裁剪图在同一次借用内完成（模型 batch>1 时一次推理一批）
+    ContextLease lease(contexts);
+    if (std::chrono::steady_clock::now() > deadline) {
+        return PoseResults();
+    }
+    std::shared_ptr<object_pose_result_list> poses(new object_pose_result_list());
+    if (cascade_.run(*backends_[lease.index()], frame, crops, *poses) != 0) {
+        LOG_THROTTLED(LOG_LEVEL_ERROR, 1000, "Cascade stage failed on %d crops", (int)crops.size());
+    }
+    return poses->count > 0 ? poses : PoseResults();
+}
+
+int Yolov8Model::choose_variant() {
+    if (input_variant_count() < 2) {
+        return 0;
+    }
+    int variant = input_policy_.choose();
+    return variants_[variant]->contexts->size() > 0 ? variant : 0;
+}
+
 std::future<object_detect_result_list> Yolov8Model::submit_infer_task(const cv::Mat& frame) {
+    return submit_infer_task(frame, std::chrono::steady_clock::now());
+}
+
+std::chrono::steady_clock::time_point Yolov8Model::deadline_for(std::chrono::steady_clock::time_point capture_time) const {
+    int deadline_ms = frame_deadline_ms_.load();
+    if (deadline_ms <= 0) {
+        return std::chrono::steady_clock::time_point::max();
+    }
+    return capture_time + std::chrono::milliseconds(deadline_ms);
+}
+
+std::future<object_detect_result_list> Yolov8Model::submit_infer_task(const cv::Mat& frame,
+                                                                      std::chrono::steady_clock::time_point capture_time) {
+    return submit_infer_task(frame, capture_time, deadline_for(capture_time));
+}
+
+std::future<object_detect_result_list> Yolov8Model::submit_infer_task(const cv::Mat& frame,
+                                                                      std::chrono::steady_clock::time_point capture_time,
+                                                                      std::chrono::steady_clock::time_point deadline) {
     if (!is_inited_) {
-        safe_printf("Model not initialized, cannot submit task");
+        LOG_THROTTLED(LOG_LEVEL_ERROR, 1000, "Model not initialized, cannot submit task");
         // 返回空future（应用层需判断valid()）
         return std::future<object_detect_result_list>();
     }
+    // 经完成回调交付到 promise
+    std::shared_ptr<std::promise<object_detect_result_list>> promise(new std::promise<object_detect_result_list>());
+    std::future<object_detect_result_list> result = promise->get_future();
+    submit_infer_task(frame, capture_time, deadline, [promise](InferStatus status, const object_detect_result_list& results,
+                                                              const PoseResults&) {
+        if (status == InferStatus::OK) {
+            promise->set_value(results);
+        } else if (status == InferStatus::SKIPPED) {
+            promise->set_exception(std::make_exception_ptr(InferenceSkipped()));
+        } else {
+            promise->set_exception(std::make_exception_ptr(std::runtime_error("inference task failed")));
+        }
+    });
+    return result;
+}
 
-    // 提交异步推理任务
-    return thread_pool_->put([this, frame]() {
-        rknn_app_context_t& ctx = get_next_context();
-        return infer_internal(frame, ctx);
+void Yolov8Model::submit_infer_task(const cv::Mat& frame, std::chrono::steady_clock::time_point capture_time,
+                                    InferCallback on_done) {
+    submit_infer_task(frame, capture_time, deadline_for(capture_time), std::move(on_done));
+}
+
+void Yolov8Model::submit_infer_task(const cv::Mat& frame, std::chrono::steady_clock::time_point capture_time,
+                                    std::chrono::steady_clock::time_point deadline, InferCallback on_done) {
+    if (!is_inited_) {
+        LOG_THROTTLED(LOG_LEVEL_ERROR, 1000, "Model not initialized, cannot submit task");
+        object_detect_result_list empty = {};
+        on_done(InferStatus::FAILED, empty, PoseResults());
+        return;
+    }
+
+    int variant_id = choose_variant();
+#if defined(YOLOV8_PIPELINE_SUPPORTED)
+    if (pipelined_) {
+        // 在所选变体已就绪的上下文中分派给未完成帧最少的一个，相同时轮询
+        const ContextPool& contexts = *variants_[variant_id]->contexts;
+        int ready = contexts.size();
+        size_t start = dispatch_count_++;
+        int best = contexts.at(start % ready);
+        size_t best_pending = pipelines_[best]->pending();
+        for (int i = 1; i < ready && best_pending > 0; ++i) {
+            int idx = contexts.at((start + i) % ready);
+            size_t pending = pipelines_[idx]->pending();
+            if (pending < best_pending) {
+                best = idx;
+                best_pending = pending;
+            }
+        }
+        if (cascade_variant_ >= 0) {
+            // 第二阶段不占用流水线线程：检测完成后经调度器在线程池中执行，排到时已过截止时间则只交付检测结果
+            InferCallback deliver = std::move(on_done);
+            on_done = [this, frame, deadline, deliver](InferStatus status, const object_detect_result_list& results,
+                                                       const PoseResults& poses) {
+                if (status != InferStatus::OK) {
+                    deliver(status, results, poses);
+                    return;
+                }
+                std::shared_ptr<object_detect_result_list> detections(new object_detect_result_list(results));
+                scheduler_->put(deadline, [this, frame, deadline, deliver, detections](bool expired) {
+                    PoseResults poses;
+                    if (!expired) {
+                        poses = run_cascade(frame, deadline, *detections);
+                    }
+                    deliver(InferStatus::OK, *detections, poses);
+                });
+            };
+        }
+        pipelines_[best]->submit(frame, deadline, std::move(on_done));
+        return;
+    }
+#endif
+
+    // 提交异步推理任务：按截止时间最早优先取出执行，过期的不再推理
+    auto skip = [this, capture_time, on_done]() {
+        uint64_t skipped = ++skipped_count_;
+        LOG_THROTTLED(LOG_LEVEL_INFO, 1000, "Skip frame captured %.1f ms ago (deadline passed), %llu skipped",
+                      std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - capture_time).count(),
+                      (unsigned long long)skipped);
+        object_detect_result_list empty = {};
+        on_done(InferStatus::SKIPPED, empty, PoseResults());
+    };
+    scheduler_->put(deadline, [this, frame, variant_id, deadline, on_done, skip](bool expired) {
+        if (expired) {
+            skip();
+            return;
+        }
+        object_detect_result_list od_results = {};
+        PoseResults poses;
+        try {
+            int ret = 0;
+            {
+                // 借用一个空闲上下文，全部忙（就绪上下文少于线程数）时等待归还；等待期间过期的同样跳过
+                ContextLease lease(*variants_[variant_id]->contexts);
+                if (std::chrono::steady_clock::now() > deadline) {
+                    skip();
+                    return;
+                }
+                ret = infer_internal(frame, *backends_[lease.index()], &od_results);
+            }
+            if (ret != 0) {
+                object_detect_result_list empty = {};
+                on_done(InferStatus::FAILED, empty, PoseResults());
+                return;
+            }
+            if (input_variant_count() > 1) {
+                input_policy_.observe(od_results, frame.cols, frame.rows);
+            }
+            // 检测上下文已归还，第二阶段借用自己的上下文
+            poses = run_cascade(frame, deadline, od_results);
+        } catch (const std::exception& e) {
+            LOG_THROTTLED(LOG_LEVEL_ERROR, 1000, "Inference task failed: %s", e.what());
+            object_detect_result_list empty = {};
+            on_done(InferStatus::FAILED, empty, PoseResults());
+            return;
+        }
+        on_done(InferStatus::OK, od_results, poses);
     });
 }
 
 void Yolov8Model::release() {
-    // 释放模型上下文
-    for (auto& ctx : model_contexts_) {
-        release_yolov8_model(&ctx);
+    // 未初始化或已释放（调用方 release 后析构函数会再调用一次）时没有需要释放的资源
+    if (!thread_pool_ && !scheduler_ && backends_.empty() && variants_.empty()) {
+        return;
+    }
+
+    // 等待后台初始化线程结束，之后上下文槽位不再被写入
+    for (auto& t : init_threads_) {
+        if (t.joinable()) {
+            t.join();
+        }
     }
-    model_contexts_.clear();
+    init_threads_.clear();
+
+#if defined(YOLOV8_PIPELINE_SUPPORTED)
+    // 先停止流水线线程（处理完已提交的帧），其完成回调可能向调度器提交第二阶段任务，须在线程池停止之前
+    pipelines_.clear();
+#endif
 
-    // 释放线程池
+    // 再停止线程池（正在执行的任务完成后退出），之后才释放任务使用的上下文；
+    // 线程池停止时丢弃的令牌对应的任务交付跳过，future 不会悬挂
     if (thread_pool_) {
         delete thread_pool_;
         thread_pool_ = nullptr;
     }
+    if (scheduler_) {
+        scheduler_->cancel_all();
+        scheduler_.reset();
+    }
+
+    // 释放后端实例：逆序，派生的上下文先于其源上下文释放
+    for (auto it = backends_.rbegin(); it != backends_.rend(); ++it) {
+        it->reset();
+    }
+    backends_.clear();
+    ContextPoolStats stats = context_wait_stats();
+    if (stats.waits > 0) {
+        safe_printf("Context wait: %llu of %llu tasks waited, avg %.1f us, max %llu us",
+                    (unsigned long long)stats.waits, (unsigned long long)stats.checkouts,
+                    (double)stats.total_wait_us / stats.waits, (unsigned long long)stats.max_wait_us);
+    }
+    variants_.clear();
+    cascade_variant_ = -1;
 
     is_inited_ = false;
     safe_printf("Model released");
@@ -72,41 +454,21 @@ bool Yolov8Model::is_inited() const {
 }
 
 // 内部推理实现
-object_detect_result_list Yolov8Model::infer_internal(const cv::Mat& frame, rknn_app_context_t& ctx) {
-    object_detect_result_list od_results = {0};
-    image_buffer_t src_image = {0};
-
-    // 图像格式转换（BGR→RGB）
-    cv::Mat rgb_frame;
-    cv::cvtColor(frame, rgb_frame, cv::COLOR_BGR2RGB);
-
-    // 初始化图像缓冲区
-    src_image.width = rgb_frame.cols;
-    src_image.height = rgb_frame.rows;
-    src_image.format = IMAGE_FORMAT_RGB888;
-    src_image.virt_addr = new unsigned char[rgb_frame.total() * 3];
-    memcpy(src_image.virt_addr, rgb_frame.data, rgb_frame.total() * 3);
-
-    // 调用底层推理接口
-    int ret = inference_yolov8_model(&ctx, &src_image, &od_results);
-    if (ret != 0) {
-        // safe_printf("Infer failed, ret=" + std::to_string(ret));
-        safe_printf("Infer failed, ret=%d", ret);
+int Yolov8Model::infer_internal(const cv::Mat& frame, InferenceBackend& backend, object_detect_result_list* od_results) {
+    *od_results = object_detect_result_list();
+
+    if (frame.type() != CV_8UC3) {
+        LOG_THROTTLED(LOG_LEVEL_ERROR, 1000, "Unsupported frame type %d, expect CV_8UC3 (BGR)", frame.type());
+        return -1;
     }
 
-    // 释放图像缓冲区
-    delete[] src_image.virt_addr;
-    src_image.virt_addr = nullptr;
+    // 调用后端推理接口：BGR→RGB、缩放与 letterbox 在上下文的输入缓冲区内一次完成，再由 post_process 解码
+    int ret = backend.infer(frame, od_results);
+    if (ret != 0) {
+        LOG_THROTTLED(LOG_LEVEL_ERROR, 1000, "Infer failed, ret=%d", ret);
+        // 出错时后端可能已写入部分结果，交付 FAILED 时结果为空
+        *od_results = object_detect_result_list();
+    }
 
-    return od_results;
+    return ret;
 }
-
-// 轮询获取模型上下文（线程安全）
-rknn_app_context_t& Yolov8Model::get_next_context() {
-    static std::atomic<int> ctx_index(0);
-    static std::mutex ctx_mutex;
-
-    std::lock_guard<std::mutex> lock(ctx_mutex);
-    int idx = ctx_index++ % model_contexts_.size();
-    return model_contexts_[idx];
-}
\ No newline at end of file
@@ -0,0 +1,124 @@
+#include "reorder_buffer.h"
+#include <algorithm>
+#include <utility>
+
+ReorderBuffer::ReorderBuffer(int capacity, int skip_ahead_ms)
+    : capacity_(capacity > 0 ? capacity : 1),
+      skip_ahead_(skip_ahead_ms > 0 ? skip_ahead_ms : 0),
+      slots_(make_aligned_array<Slot>(capacity > 0 ? capacity : 1)) {}
+
+bool ReorderBuffer::reserve(const FrameRef& frame, Clock::time_point capture_time, uint64_t& seq) {
+    if (outstanding() >= capacity_) {
+        return false;
+    }
+    Slot& slot = slots_[next_seq_ % capacity_];
+    // 被越过的帧结果未到之前槽位不能复用
+    if (slot.state.load(std::memory_order_acquire) != SLOT_EMPTY) {
+        return false;
+    }
+    slot.seq = next_seq_;
+    slot.reserve_time = Clock::now();
+    slot.capture_time = capture_time;
+    slot.frame = frame;
+    slot.state.store(SLOT_PENDING, std::memory_order_release);
+    seq = next_seq_++;
+    return true;
+}
+
+void ReorderBuffer::complete(uint64_t seq, InferStatus status, const object_detect_result_list& results,
+                             const PoseResults& poses) {
+    Slot& slot = slots_[seq % capacity_];
+    int expected = SLOT_PENDING;
+    if (!slot.state.compare_exchange_strong(expected, SLOT_WRITING, std::memory_order_acquire)) {
+        // 已被越过：结果作废，释放帧并归还槽位
+        slot.frame.reset();
+        slot.state.store(SLOT_EMPTY, std::memory_order_release);
+        return;
+    }
+    slot.status = status;
+    slot.results = results;
+    slot.poses = poses;
+    slot.state.store(SLOT_READY);
+    // 与 pop 的“先登记等待再检查”配对，不会漏掉唤醒
+    if (waiting_.load()) {
+        std::lock_guard<std::mutex> lock(wait_mutex_);
+        wait_cond_.notify_all();
+    }
+}
+
+bool ReorderBuffer::later_ready() const {
+    for (uint64_t seq = head_seq_ + 1; seq < next_seq_; ++seq) {
+        if (slots_[seq % capacity_].state.load(std::memory_order_acquire) == SLOT_READY) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool ReorderBuffer::try_pop(ReorderedFrame& out, Clock::time_point& wake) {
+    wake = Clock::time_point::max();
+    while (head_seq_ < next_seq_) {
+        Slot& slot = slots_[head_seq_ % capacity_];
+        int state = slot.state.load(std::memory_order_acquire);
+        if (state == SLOT_READY) {
+            out.seq = slot.seq;
+            out.frame = std::move(slot.frame);
+            out.capture_time = slot.capture_time;
+            out.status = slot.status;
+            out.results = slot.results;
+            out.poses = std::move(slot.poses);
+            slot.state.store(SLOT_EMPTY, std::memory_order_release);
+            head_seq_++;
+            return true;
+        }
+        if (skip_ahead_.count() == 0 || !later_ready()) {
+            return false;
+        }
+        Clock::time_point skip_time = slot.reserve_time + skip_ahead_;
+        if (Clock::now() < skip_time) {
+            wake = skip_time;
+            return false;
+        }
+        // 越过最早的帧；若它恰好开始交付（WRITING）则等它写完
+        int expected = SLOT_PENDING;
+        if (!slot.state.compare_exchange_strong(expected, SLOT_ABANDONED, std::memory_order_acq_rel)) {
+            wake = Clock::now();
+            return false;
+        }
+        head_seq_++;
+        skipped_ahead_++;
+    }
+    return false;
+}
+
+bool ReorderBuffer::pop(ReorderedFrame& out, int wait_ms) {
+    Clock::time_point wake;
+    if (try_pop(out, wake)) {
+        return true;
+    }
+    if (wait_ms == 0 || outstanding() == 0) {
+        return false;
+    }
+    Clock::time_point deadline = wait_ms > 0 ? Clock::now() + std::chrono::milliseconds(wait_ms)
+                                             : Clock::time_point::max();
+    std::unique_lock<std::mutex> lock(wait_mutex_);
+    waiting_.store(true);
+    bool popped = false;
+    while (true) {
+        if (try_pop(out, wake)) {
+            popped = true;
+            break;
+        }
+        Clock::time_point until = std::min(deadline, wake);
+        if (Clock::now() >= deadline || outstanding() == 0) {
+            break;
+        }
+        if (until == Clock::time_point::max()) {
+            wait_cond_.wait(lock);
+        } else {
+            wait_cond_.wait_until(lock, until);
+        }
+    }
+    waiting_.store(false);
+    return popped;
+}
@@ -1,5 +1,6 @@
 #include "result_processor.h"
 #include "common_utils.h"
+#include "logger.h"
 #include <unordered_map>
 #include <vector>
 #include <future>
@@ -19,9 +20,11 @@ bool ResultProcessor::init(ThreadPool* thread_pool) {
 void ResultProcessor::process_and_draw(const object_detect_result_list& od_results,
                                        cv::Mat& frame,
                                        const TrackerWrapper& tracker,
-                                       const FPSCounter& fps_counter) {
+                                       const FPSCounter& fps_counter,
+                                       cv::Mat& display,
+                                       const object_pose_result_list* poses) {
     if (!is_inited_ || frame.empty()) {
-        safe_printf("ResultProcessor: not inited or frame is empty");
+        LOG_THROTTLED(LOG_LEVEL_WARN, 1000, "ResultProcessor: not inited or frame is empty");
         return;
     }
 
@@ -45,14 +48,21 @@ void ResultProcessor::process_and_draw(const object_detect_result_list& od_resul
         }));
     }
 
+    // 级联姿态模型的关键点与骨架
+    for (int i = 0; poses != nullptr && i < poses->count; i++) {
+        const auto& pose = poses->poses[i];
+        draw_futures.push_back(draw_thread_pool_->put([this, pose, &frame]() {
+            draw_pose(pose, frame);
+        }));
+    }
+
     // 3. 等待所有绘制任务完成
     for (auto& fut : draw_futures) {
         if (fut.valid()) {
             try {
                 fut.get();
             } catch (const std::exception& e) {
-                // safe_printf("ResultProcessor: draw task exception: " + std::string(e.what()));
-                safe_printf("ResultProcessor: draw task exception: %s", e.what());
+                LOG_THROTTLED(LOG_LEVEL_ERROR, 1000, "ResultProcessor: draw task exception: %s", e.what());
             }
         }
     }
@@ -71,8 +81,8 @@ void ResultProcessor::process_and_draw(const object_detect_result_list& od_resul
                 cv::Point(10, 100), cv::FONT_HERSHEY_SIMPLEX, 
                 1.5, cv::Scalar(0, 255, 0), 2, cv::LINE_AA);
 
-    // 5. 固定输出尺寸（简化显示逻辑）
-    cv::resize(frame, frame, cv::Size(1280, 720), 0, 0, cv::INTER_CUBIC);
+    // 5. 固定输出尺寸（简化显示逻辑）：写入单独的显示缓冲区，frame 可能是帧缓冲池的缓冲区，原地缩放会使其重新分配
+    cv::resize(frame, display, cv::Size(1280, 720), 0, 0, cv::INTER_CUBIC);
 }
 
 // 建立「检测框-追踪ID」映射：通过中心距离匹配
@@ -133,12 +143,31 @@ void ResultProcessor::draw_single_detection(const object_detect_result& det,
     cv::putText(frame, text, cv::Point(x1, text_y), 
                 cv::FONT_HERSHEY_SIMPLEX, 0.7, cv::Scalar(0, 0, 255), 2, cv::LINE_AA);
 
-    // 4. 线程安全打印检测结果
+    // 4. 打印检测结果（DEBUG 级别，发布版本编译期消除）
     if (track_id != -1) {
-        safe_printf(cv::format("ID:%d %s @ (%d, %d, %d, %d) Conf:%.3f", 
-                            track_id, cls_name, x1, y1, x2, y2, det.prop).c_str());
+        LOG_DEBUG("ID:%d %s @ (%d, %d, %d, %d) Conf:%.3f", track_id, cls_name, x1, y1, x2, y2, det.prop);
     } else {
-        safe_printf(cv::format("%s @ (%d, %d, %d, %d) Conf:%.3f", 
-                            cls_name, x1, y1, x2, y2, det.prop).c_str());
+        LOG_DEBUG("%s @ (%d, %d, %d, %d) Conf:%.3f", cls_name, x1, y1, x2, y2, det.prop);
     }
-}
\ No newline at end of file
+}
+
+// 关键点与骨架绘制：只画置信度足够的关键点及两端都可见的骨架连线
+void ResultProcessor::draw_pose(const object_pose_result& pose, cv::Mat& frame) {
+    const float kpt_threshold = 0.5f;
+    for (int i = 0; i + 1 < (int)(sizeof(skeleton_) / sizeof(skeleton_[0])); i += 2) {
+        // skeleton_ 中的关键点编号从 1 开始
+        int a = skeleton_[i] - 1;
+        int b = skeleton_[i + 1] - 1;
+        if (a >= pose.kpt_count || b >= pose.kpt_count ||
+            pose.keypoints[a].conf < kpt_threshold || pose.keypoints[b].conf < kpt_threshold) {
+            continue;
+        }
+        cv::line(frame, cv::Point((int)pose.keypoints[a].x, (int)pose.keypoints[a].y),
+                 cv::Point((int)pose.keypoints[b].x, (int)pose.keypoints[b].y), cv::Scalar(0, 255, 255), 2, cv::LINE_AA);
+    }
+    for (int k = 0; k < pose.kpt_count; k++) {
+        if (pose.keypoints[k].conf < kpt_threshold) continue;
+        cv::circle(frame, cv::Point((int)pose.keypoints[k].x, (int)pose.keypoints[k].y), 3, cv::Scalar(0, 255, 0), -1,
+                   cv::LINE_AA);
+    }
+}
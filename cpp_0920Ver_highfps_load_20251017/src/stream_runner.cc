@@ -0,0 +1,189 @@
+#include "stream_runner.h"
+#include "logger.h"
+#include <algorithm>
+#include <utility>
+
+namespace {
+// BoTSORT 的轨迹编号计数器是全局静态变量，多路跟踪器的 Update 需串行
+std::mutex& tracker_mutex() {
+    static std::mutex mutex;
+    return mutex;
+}
+}
+
+StreamRunner::StreamRunner(Yolov8Model& model, StreamScheduler& scheduler)
+    : model_(model), scheduler_(scheduler), admission_(model) {}
+
+StreamRunner::~StreamRunner() {
+    stop();
+    cap_.release();
+}
+
+bool StreamRunner::init(const StreamConfig& config, int max_in_flight) {
+    config_ = config;
+    if (!cap_.init(config_.source, config_.width, config_.height, config_.fps)) {
+        safe_printf("StreamRunner: open source %s failed", config_.source.c_str());
+        return false;
+    }
+    if (!processor_.init(model_.get_thread_pool())) {
+        return false;
+    }
+
+    // 与单路相同：实时源只保留最新一帧排队、最早的帧 100ms 未完成即越过，视频文件不丢帧
+    AdmissionConfig admission_config;
+    admission_config.max_in_flight = max_in_flight;
+    admission_config.policy = cap_.is_live() ? DropPolicy::LATEST_WINS : DropPolicy::BLOCK;
+    admission_config.skip_ahead_ms = cap_.is_live() ? 100 : 0;
+    admission_.set_config(admission_config);
+    stream_id_ = scheduler_.add_stream(config_.weight);
+    admission_.set_stream_scheduler(&scheduler_, stream_id_);
+
+    // 在途帧 + 排队帧 + 正在绘制的一帧 + 正在读取的一帧
+    int buffers = admission_.config().max_in_flight + std::max(admission_.config().queue_depth, 1) + 2;
+    if (!frame_pool_.init(buffers, cap_.frame_size().width, cap_.frame_size().height)) {
+        safe_printf("StreamRunner: frame pool init failed for %s", config_.source.c_str());
+        return false;
+    }
+    tracker_.Init();
+    safe_printf("Stream %d: %s, weight %d, %s", stream_id_, config_.source.c_str(), config_.weight,
+                cap_.is_live() ? "live" : "file");
+    return true;
+}
+
+void StreamRunner::start() {
+    if (thread_.joinable()) {
+        return;
+    }
+    start_time_ = Clock::now();
+    window_start_ = start_time_;
+    stop_ = false;
+    finished_ = false;
+    thread_ = std::thread(&StreamRunner::run, this);
+}
+
+void StreamRunner::stop() {
+    stop_ = true;
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+}
+
+void StreamRunner::run() {
+    FrameRef done;
+    object_detect_result_list results;
+    PoseResults poses;
+    Clock::time_point capture_time;
+    while (!stop_) {
+        // 与单路主循环相同：缓冲区全部在用时先等待最早的一帧完成
+        FrameRef frame = frame_pool_.acquire();
+        bool backpressure = !frame;
+        if (backpressure) {
+            if (admission_.submitted_count() == 0 && admission_.queued_count() == 0) {
+                break;
+            }
+        } else {
+            if (!cap_.read_frame(*frame)) {
+                break;
+            }
+            admission_.offer(frame, Clock::now());
+            frame.reset();
+            std::lock_guard<std::mutex> lock(mutex_);
+            read_++;
+        }
+
+        while (admission_.next_completed(done, results, (backpressure || admission_.backlogged()) ? -1 : 0,
+                                         capture_time, poses)) {
+            backpressure = false;
+            present(done, results, poses, capture_time);
+            done.reset();  // 帧缓冲区归还帧缓冲池
+        }
+        std::lock_guard<std::mutex> lock(mutex_);
+        admission_stats_ = admission_.stats();
+    }
+
+    // 排队帧不再提交，取完已提交的帧（不再绘制）
+    admission_.discard_queued();
+    while (admission_.submitted_count() > 0) {
+        if (!admission_.next_completed(done, results, 1000, capture_time)) {
+            if (admission_.submitted_count() > 0) {
+                safe_printf("Stream %d: %d frames timed out at exit", stream_id_, admission_.submitted_count());
+            }
+            break;
+        }
+        record_completed(capture_time);
+        done.reset();
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        admission_stats_ = admission_.stats();
+    }
+    finished_ = true;
+}
+
+void StreamRunner::present(FrameRef& frame, const object_detect_result_list& results, const PoseResults& poses,
+                           Clock::time_point capture_time) {
+    try {
+        {
+            std::lock_guard<std::mutex> lock(tracker_mutex());
+            tracker_.Update(results, frame->size());
+        }
+        processor_.process_and_draw(results, *frame, tracker_, fps_, drawn_, poses.get());
+        fps_.increment_frame();
+    } catch (...) {
+        LOG_THROTTLED(LOG_LEVEL_ERROR, 1000, "Stream %d: process frame failed", stream_id_);
+        return;
+    }
+    record_completed(capture_time);
+    // 主线程未取走的上一帧直接被替换；交换缓冲区，下一帧绘制复用主线程显示完的那一个
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::swap(display_, drawn_);
+    has_display_ = true;
+}
+
+void StreamRunner::record_completed(Clock::time_point capture_time) {
+    double latency = std::chrono::duration<double, std::milli>(Clock::now() - capture_time).count();
+    std::lock_guard<std::mutex> lock(mutex_);
+    completed_++;
+    total_latency_ms_ += latency;
+    total_max_latency_ms_ = std::max(total_max_latency_ms_, latency);
+    window_completed_++;
+    window_latency_ms_ += latency;
+    window_max_latency_ms_ = std::max(window_max_latency_ms_, latency);
+}
+
+bool StreamRunner::take_display(cv::Mat& display) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!has_display_) {
+        return false;
+    }
+    std::swap(display, display_);
+    has_display_ = false;
+    return true;
+}
+
+StreamReport StreamRunner::report(bool reset_window) {
+    StreamReport report;
+    Clock::time_point now = Clock::now();
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        double window_s = std::chrono::duration<double>(now - window_start_).count();
+        double total_s = std::chrono::duration<double>(now - start_time_).count();
+        report.read = read_;
+        report.completed = completed_;
+        report.fps = window_s > 0 ? window_completed_ / window_s : 0;
+        report.avg_latency_ms = window_completed_ > 0 ? window_latency_ms_ / window_completed_ : 0;
+        report.max_latency_ms = window_max_latency_ms_;
+        report.total_fps = total_s > 0 ? completed_ / total_s : 0;
+        report.total_avg_latency_ms = completed_ > 0 ? total_latency_ms_ / completed_ : 0;
+        report.total_max_latency_ms = total_max_latency_ms_;
+        report.admission = admission_stats_;
+        if (reset_window) {
+            window_completed_ = 0;
+            window_latency_ms_ = 0;
+            window_max_latency_ms_ = 0;
+            window_start_ = now;
+        }
+    }
+    report.queue = scheduler_.stats(stream_id_);
+    return report;
+}
@@ -0,0 +1,144 @@
+#include "stream_scheduler.h"
+#include <algorithm>
+#include <limits>
+#include <utility>
+
+StreamScheduler::StreamScheduler(Yolov8Model& model, int max_in_flight)
+    : model_(model), max_in_flight_(max_in_flight > 0 ? max_in_flight : 1) {}
+
+StreamScheduler::~StreamScheduler() {
+    close();
+}
+
+int StreamScheduler::add_stream(int weight) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::unique_ptr<Stream> stream(new Stream());
+    stream->weight = std::max(weight, 1);
+    streams_.push_back(std::move(stream));
+    return (int)streams_.size() - 1;
+}
+
+void StreamScheduler::submit(int stream, const cv::Mat& frame, Clock::time_point capture_time,
+                             InferCallback on_done) {
+    Pending next;
+    int next_stream = -1;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (closed_ || stream < 0 || stream >= (int)streams_.size()) {
+            next_stream = -2;
+        } else {
+            // 起始时间：空闲后重新有帧的流从当前虚拟时间开始，不累积空闲期间的份额
+            Stream& s = *streams_[stream];
+            Pending pending;
+            pending.frame = frame;
+            pending.capture_time = capture_time;
+            pending.enqueue_time = Clock::now();
+            pending.start_tag = std::max(virtual_time_, s.finish_tag);
+            pending.on_done = std::move(on_done);
+            s.finish_tag = pending.start_tag + 1.0 / s.weight;
+            s.queue.push_back(std::move(pending));
+            s.stats.submitted++;
+            next_stream = take_next(next);
+        }
+    }
+    if (next_stream == -2) {
+        object_detect_result_list empty = {};
+        on_done(InferStatus::SKIPPED, empty, PoseResults());
+        return;
+    }
+    if (next_stream >= 0) {
+        dispatch(next);
+    }
+}
+
+int StreamScheduler::take_next(Pending& next) {
+    if (in_flight_ >= max_in_flight_) {
+        return -1;
+    }
+    int best = -1;
+    double best_tag = std::numeric_limits<double>::max();
+    for (size_t i = 0; i < streams_.size(); ++i) {
+        const std::deque<Pending>& queue = streams_[i]->queue;
+        if (!queue.empty() && queue.front().start_tag < best_tag) {
+            best = (int)i;
+            best_tag = queue.front().start_tag;
+        }
+    }
+    if (best < 0) {
+        return -1;
+    }
+    Stream& s = *streams_[best];
+    next = std::move(s.queue.front());
+    s.queue.pop_front();
+    virtual_time_ = next.start_tag;
+    in_flight_++;
+
+    uint64_t wait_us = (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(
+                           Clock::now() - next.enqueue_time).count();
+    s.stats.dispatched++;
+    s.stats.total_wait_us += wait_us;
+    s.stats.max_wait_us = std::max(s.stats.max_wait_us, wait_us);
+    return best;
+}
+
+void StreamScheduler::dispatch(Pending& pending) {
+    InferCallback deliver = std::move(pending.on_done);
+    model_.submit_infer_task(pending.frame, pending.capture_time,
+                             [this, deliver](InferStatus status, const object_detect_result_list& results,
+                                             const PoseResults& poses) {
+                                 // 先释放名额并提交下一帧，NPU 不等本帧结果交付
+                                 on_complete();
+                                 deliver(status, results, poses);
+                             });
+}
+
+void StreamScheduler::on_complete() {
+    Pending next;
+    int next_stream;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        in_flight_--;
+        next_stream = closed_ ? -1 : take_next(next);
+    }
+    if (next_stream >= 0) {
+        dispatch(next);
+    }
+}
+
+void StreamScheduler::close() {
+    std::vector<Pending> cancelled;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        closed_ = true;
+        for (auto& stream : streams_) {
+            for (auto& pending : stream->queue) {
+                cancelled.push_back(std::move(pending));
+            }
+            stream->queue.clear();
+        }
+    }
+    object_detect_result_list empty = {};
+    for (auto& pending : cancelled) {
+        pending.on_done(InferStatus::SKIPPED, empty, PoseResults());
+    }
+}
+
+int StreamScheduler::stream_count() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return (int)streams_.size();
+}
+
+int StreamScheduler::in_flight() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return in_flight_;
+}
+
+StreamQueueStats StreamScheduler::stats(int stream) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (stream < 0 || stream >= (int)streams_.size()) {
+        return StreamQueueStats();
+    }
+    StreamQueueStats stats = streams_[stream]->stats;
+    stats.queued = (int)streams_[stream]->queue.size();
+    return stats;
+}
@@ -1,6 +1,7 @@
 #include "tracker_wrapper.h"
 #include "tracking.h"
 #include "common_utils.h"  // 通用工具（线程安全打印）
+#include "logger.h"        // 逐帧日志（DEBUG 级别编译期消除）
 #include <algorithm>       // 用于过滤无效检测框
 
 // 初始化追踪器
@@ -25,7 +26,7 @@ bool TrackerWrapper::Init(int max_age, int min_hits, float iou_threshold) {
 // 更新追踪结果（核心逻辑）
 void TrackerWrapper::Update(const object_detect_result_list& det_results, const cv::Size& frame_size) {
     if (!is_initialized_) {
-        safe_printf("[TrackerWrapper] Error: Call Update before Init!");
+        LOG_THROTTLED(LOG_LEVEL_ERROR, 1000, "[TrackerWrapper] Error: Call Update before Init!");
         return;
     }
 
@@ -39,15 +40,15 @@ void TrackerWrapper::Update(const object_detect_result_list& det_results, const
     cv::Rect frame_region(0, 0, frame_size.width, frame_size.height);  // 帧完整区域
     tracker_.update(detections, cls_ids, frame_region);
 
-    safe_printf("[TrackerWrapper] Updated with %d valid detections (total input: %d)",
-                static_cast<int>(detections.size()), det_results.count);
+    LOG_DEBUG("[TrackerWrapper] Updated with %d valid detections (total input: %d)",
+              static_cast<int>(detections.size()), det_results.count);
 }
 
 // 获取所有有效追踪结果
 void TrackerWrapper::GetTrackResults(std::vector<TrackResult>& results) const {
     results.clear();
     if (!is_initialized_) {
-        safe_printf("[TrackerWrapper] Error: Call GetTrackResults before Init!");
+        LOG_THROTTLED(LOG_LEVEL_ERROR, 1000, "[TrackerWrapper] Error: Call GetTrackResults before Init!");
         return;
     }
 
@@ -61,7 +62,8 @@ void TrackerWrapper::GetTrackResults(std::vector<TrackResult>& results) const {
         // 获取追踪框（发现实际返回的是2维状态向量：[中心x, 中心y]，而非期望的4维）
         const Eigen::VectorXd& track_state = track.get_state();
         if (track_state.size() < 2) {
-            safe_printf("[TrackerWrapper] Invalid track state size: %d", static_cast<int>(track_state.size()));
+            LOG_THROTTLED(LOG_LEVEL_WARN, 1000, "[TrackerWrapper] Invalid track state size: %d",
+                          static_cast<int>(track_state.size()));
             continue;
         }
 
@@ -89,7 +91,7 @@ void TrackerWrapper::GetTrackResults(std::vector<TrackResult>& results) const {
         results.push_back(result);
     }
 
-    safe_printf("[TrackerWrapper] Got %d valid track results", static_cast<int>(results.size()));
+    LOG_DEBUG("[TrackerWrapper] Got %d valid track results", static_cast<int>(results.size()));
 }
 
 // 辅助函数：将YOLOv8-Pose检测结果转换为追踪器输入格式
@@ -129,8 +131,8 @@ void TrackerWrapper::ConvertDetToTrackerInput(
         confidences.push_back(det.prop);        // 置信度
     }
 
-    safe_printf("[TrackerWrapper] Converted %d valid detections (total input: %d)",
-                static_cast<int>(detections.size()), det_results.count);
+    LOG_DEBUG("[TrackerWrapper] Converted %d valid detections (total input: %d)",
+              static_cast<int>(detections.size()), det_results.count);
 }
 
 // 辅助函数：过滤无效检测框（直接使用object_detect_result的box字段）
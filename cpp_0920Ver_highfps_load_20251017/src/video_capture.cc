@@ -46,6 +46,7 @@ bool VideoCaptureWrapper::init(const std::string& device, int width, int height,
     int actual_w = cap_.get(cv::CAP_PROP_FRAME_WIDTH);
     int actual_h = cap_.get(cv::CAP_PROP_FRAME_HEIGHT);
     safe_printf("实际处理分辨率: %dx%d", actual_w, actual_h);
+    is_live_ = is_network_cam || is_usb_cam;
     is_initialized_ = true;
     return true;
 }
@@ -58,6 +59,13 @@ bool VideoCaptureWrapper::read_frame(cv::Mat& frame) {
     return cap_.read(frame);
 }
 
+cv::Size VideoCaptureWrapper::frame_size() const {
+    if (!is_opened()) {
+        return cv::Size();
+    }
+    return cv::Size((int)cap_.get(cv::CAP_PROP_FRAME_WIDTH), (int)cap_.get(cv::CAP_PROP_FRAME_HEIGHT));
+}
+
 void VideoCaptureWrapper::release() {
     if (is_initialized_ && cap_.isOpened()) {
         cap_.release();
@@ -0,0 +1,517 @@
+#include "tensor_capture.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <atomic>
+#include <mutex>
+#include <vector>
+
+// 文件格式（小端，各字段 4 字节）：
+//   文件头  "YV8T" version layout n_output model_w model_h model_c is_quant
+//           n_output × {张量属性, 每帧数据字节数}，zero copy 另有 n_output × 原生属性
+//   每帧    "FRAM" seq src_w src_h x_pad y_pad scale，n_output × {编码, 存储字节数, 数据}
+#define TENSOR_CAPTURE_MAGIC "YV8T"
+#define TENSOR_CAPTURE_FRAME_MAGIC "FRAM"
+#define TENSOR_CAPTURE_VERSION 1
+#define TENSOR_ENCODING_RAW 0
+#define TENSOR_ENCODING_PACKBITS 1
+#define TENSOR_CAPTURE_MAX_OUTPUT 9
+
+#if defined(RV1106_1103)
+#define TENSOR_CAPTURE_LAYOUT TENSOR_CAPTURE_LAYOUT_RV1106
+#elif defined(ZERO_COPY)
+#define TENSOR_CAPTURE_LAYOUT TENSOR_CAPTURE_LAYOUT_ZERO_COPY
+#elif defined(RKNPU1)
+#define TENSOR_CAPTURE_LAYOUT TENSOR_CAPTURE_LAYOUT_RKNPU1
+#else
+#define TENSOR_CAPTURE_LAYOUT TENSOR_CAPTURE_LAYOUT_NCHW
+#endif
+
+/**
+ * @brief 取第 idx 个输出的数据与字节数（RV1106/1103 与 zero copy 传入的是 rknn_tensor_mem 指针数组）
+ */
+static void get_output_data(void *outputs, int idx, const uint8_t **data, uint32_t *size)
+{
+#if defined(RV1106_1103) || defined(ZERO_COPY)
+    const rknn_tensor_mem *mem = ((rknn_tensor_mem **)outputs)[idx];
+    *data = (const uint8_t *)mem->virt_addr;
+    *size = mem->size;
+#else
+    const rknn_output *output = &((rknn_output *)outputs)[idx];
+    *data = (const uint8_t *)output->buf;
+    *size = output->size;
+#endif
+}
+
+static void put_u32(std::vector<uint8_t> &buf, uint32_t v)
+{
+    size_t pos = buf.size();
+    buf.resize(pos + 4);
+    memcpy(&buf[pos], &v, 4);
+}
+
+static void put_i32(std::vector<uint8_t> &buf, int32_t v) { put_u32(buf, (uint32_t)v); }
+
+static void put_f32(std::vector<uint8_t> &buf, float v)
+{
+    uint32_t bits;
+    memcpy(&bits, &v, 4);
+    put_u32(buf, bits);
+}
+
+/**
+ * @brief 序列化 post_process 用到的张量属性字段（各平台 rknn_tensor_attr 的公共部分）
+ */
+static void put_attr(std::vector<uint8_t> &buf, const rknn_tensor_attr *attr)
+{
+    put_u32(buf, attr->index);
+    put_u32(buf, attr->n_dims);
+    for (int d = 0; d < RKNN_MAX_DIMS; d++)
+    {
+        put_u32(buf, attr->dims[d]);
+    }
+    put_u32(buf, attr->n_elems);
+    put_u32(buf, attr->size);
+    put_u32(buf, (uint32_t)attr->fmt);
+    put_u32(buf, (uint32_t)attr->type);
+    put_u32(buf, (uint32_t)attr->qnt_type);
+    put_i32(buf, attr->zp);
+    put_f32(buf, attr->scale);
+}
+
+/**
+ * @brief PackBits 游程编码：控制字节 n 为 0..127 时其后 n+1 个字节原样复制，-1..-127 时下一字节重复 1-n 次
+ */
+static void packbits_encode(const uint8_t *src, uint32_t size, std::vector<uint8_t> &dst)
+{
+    dst.clear();
+    uint32_t i = 0;
+    while (i < size)
+    {
+        // 当前位置的重复长度
+        uint32_t run = 1;
+        while (i + run < size && run < 128 && src[i + run] == src[i])
+        {
+            run++;
+        }
+        if (run >= 2)
+        {
+            dst.push_back((uint8_t)(int8_t)(1 - (int)run));
+            dst.push_back(src[i]);
+            i += run;
+            continue;
+        }
+        // 原样段：延伸到下一个至少 3 字节的重复段之前
+        uint32_t start = i;
+        while (i < size && i - start < 128)
+        {
+            if (i + 2 < size && src[i] == src[i + 1] && src[i] == src[i + 2])
+            {
+                break;
+            }
+            i++;
+        }
+        dst.push_back((uint8_t)(i - start - 1));
+        dst.insert(dst.end(), src + start, src + i);
+    }
+}
+
+/**
+ * @brief PackBits 解码，输出必须恰好为 size 字节，否则视为损坏
+ */
+static int packbits_decode(const uint8_t *src, uint32_t src_size, uint8_t *dst, uint32_t size)
+{
+    uint32_t i = 0;
+    uint32_t o = 0;
+    while (i < src_size)
+    {
+        int n = (int8_t)src[i++];
+        if (n >= 0)
+        {
+            uint32_t len = (uint32_t)n + 1;
+            if (i + len > src_size || o + len > size)
+            {
+                return -1;
+            }
+            memcpy(dst + o, src + i, len);
+            i += len;
+            o += len;
+        }
+        else if (n != -128)
+        {
+            uint32_t len = (uint32_t)(1 - n);
+            if (i >= src_size || o + len > size)
+            {
+                return -1;
+            }
+            memset(dst + o, src[i++], len);
+            o += len;
+        }
+    }
+    return o == size ? 0 : -1;
+}
+
+// ------------------------------------------------------------ 录制
+
+static std::atomic<bool> g_capture_enabled(false);
+static std::mutex g_capture_mutex;
+static FILE *g_capture_fp = NULL;
+static bool g_capture_header_written = false;
+static std::vector<uint32_t> g_capture_sizes;  // 文件头记录的每个输出的字节数
+static uint32_t g_capture_seq = 0;
+static int g_capture_max_frames = 0;
+
+int tensor_capture_start(const char *path, int max_frames)
+{
+    std::lock_guard<std::mutex> lock(g_capture_mutex);
+    if (g_capture_fp != NULL)
+    {
+        printf("tensor capture already started\n");
+        return -1;
+    }
+    g_capture_fp = fopen(path, "wb");
+    if (g_capture_fp == NULL)
+    {
+        printf("open tensor capture file fail: %s\n", path);
+        return -1;
+    }
+    g_capture_header_written = false;
+    g_capture_sizes.clear();
+    g_capture_seq = 0;
+    g_capture_max_frames = max_frames;
+    g_capture_enabled.store(true, std::memory_order_release);
+    printf("tensor capture start: %s (max frames %d)\n", path, max_frames);
+    return 0;
+}
+
+static void close_capture_locked()
+{
+    g_capture_enabled.store(false, std::memory_order_release);
+    if (g_capture_fp != NULL)
+    {
+        fclose(g_capture_fp);
+        g_capture_fp = NULL;
+        printf("tensor capture stop: %u frames\n", g_capture_seq);
+    }
+}
+
+void tensor_capture_stop()
+{
+    std::lock_guard<std::mutex> lock(g_capture_mutex);
+    close_capture_locked();
+}
+
+static void write_header_locked(rknn_app_context_t *app_ctx, void *outputs)
+{
+    int n_output = app_ctx->io_num.n_output;
+    std::vector<uint8_t> buf;
+    buf.insert(buf.end(), TENSOR_CAPTURE_MAGIC, TENSOR_CAPTURE_MAGIC + 4);
+    put_u32(buf, TENSOR_CAPTURE_VERSION);
+    put_u32(buf, TENSOR_CAPTURE_LAYOUT);
+    put_u32(buf, n_output);
+    put_i32(buf, app_ctx->model_width);
+    put_i32(buf, app_ctx->model_height);
+    put_i32(buf, app_ctx->model_channel);
+    put_u32(buf, app_ctx->is_quant ? 1 : 0);
+    g_capture_sizes.resize(n_output);
+    for (int i = 0; i < n_output; i++)
+    {
+        const uint8_t *data;
+        get_output_data(outputs, i, &data, &g_capture_sizes[i]);
+        put_attr(buf, &app_ctx->output_attrs[i]);
+        put_u32(buf, g_capture_sizes[i]);
+    }
+#if defined(ZERO_COPY)
+    for (int i = 0; i < n_output; i++)
+    {
+        put_attr(buf, &app_ctx->output_native_attrs[i]);
+    }
+#endif
+    fwrite(buf.data(), 1, buf.size(), g_capture_fp);
+    g_capture_header_written = true;
+}
+
+void tensor_capture_frame(rknn_app_context_t *app_ctx, void *outputs, const letterbox_t *letter_box, int src_width,
+                          int src_height)
+{
+    if (!g_capture_enabled.load(std::memory_order_acquire))
+    {
+        return;
+    }
+    int n_output = app_ctx->io_num.n_output;
+    if (n_output <= 0 || n_output > TENSOR_CAPTURE_MAX_OUTPUT)
+    {
+        return;
+    }
+
+    // 编码在锁外完成，多个上下文只在写文件时互斥
+    static thread_local std::vector<uint8_t> record;
+    static thread_local std::vector<uint8_t> encoded;
+    record.clear();
+    record.insert(record.end(), TENSOR_CAPTURE_FRAME_MAGIC, TENSOR_CAPTURE_FRAME_MAGIC + 4);
+    size_t seq_pos = record.size();
+    put_u32(record, 0);  // seq，写入时按文件中的顺序填写
+    put_i32(record, src_width);
+    put_i32(record, src_height);
+    put_i32(record, letter_box->x_pad);
+    put_i32(record, letter_box->y_pad);
+    put_f32(record, letter_box->scale);
+    uint32_t sizes[TENSOR_CAPTURE_MAX_OUTPUT];
+    for (int i = 0; i < n_output; i++)
+    {
+        const uint8_t *data;
+        get_output_data(outputs, i, &data, &sizes[i]);
+        packbits_encode(data, sizes[i], encoded);
+        if (encoded.size() < sizes[i])
+        {
+            put_u32(record, TENSOR_ENCODING_PACKBITS);
+            put_u32(record, (uint32_t)encoded.size());
+            record.insert(record.end(), encoded.begin(), encoded.end());
+        }
+        else
+        {
+            put_u32(record, TENSOR_ENCODING_RAW);
+            put_u32(record, sizes[i]);
+            record.insert(record.end(), data, data + sizes[i]);
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(g_capture_mutex);
+    if (g_capture_fp == NULL)
+    {
+        return;
+    }
+    if (!g_capture_header_written)
+    {
+        write_header_locked(app_ctx, outputs);
+    }
+    if ((int)g_capture_sizes.size() != n_output ||
+        memcmp(g_capture_sizes.data(), sizes, n_output * sizeof(uint32_t)) != 0)
+    {
+        printf("tensor capture: output sizes differ from the first frame, frame skipped\n");
+        return;
+    }
+    memcpy(&record[seq_pos], &g_capture_seq, 4);
+    if (fwrite(record.data(), 1, record.size(), g_capture_fp) != record.size())
+    {
+        printf("tensor capture: write fail, stop capture\n");
+        close_capture_locked();
+        return;
+    }
+    g_capture_seq++;
+    if (g_capture_max_frames > 0 && (int)g_capture_seq >= g_capture_max_frames)
+    {
+        close_capture_locked();
+    }
+}
+
+// ------------------------------------------------------------ 回放
+
+struct tensor_replay {
+    FILE *fp;
+    int n_output;
+    std::vector<uint32_t> sizes;
+    std::vector<std::vector<uint8_t> > data;  // 解码后的各输出
+    std::vector<uint8_t> encoded;
+#if defined(RV1106_1103) || defined(ZERO_COPY)
+    rknn_tensor_mem mems[TENSOR_CAPTURE_MAX_OUTPUT];
+    rknn_tensor_mem *mem_ptrs[TENSOR_CAPTURE_MAX_OUTPUT];
+#else
+    rknn_output outputs[TENSOR_CAPTURE_MAX_OUTPUT];
+#endif
+};
+
+static bool get_u32(FILE *fp, uint32_t *v) { return fread(v, 4, 1, fp) == 1; }
+
+static bool get_i32(FILE *fp, int32_t *v) { return fread(v, 4, 1, fp) == 1; }
+
+static bool get_f32(FILE *fp, float *v) { return fread(v, 4, 1, fp) == 1; }
+
+static bool get_attr(FILE *fp, rknn_tensor_attr *attr)
+{
+    uint32_t fmt, type, qnt_type;
+    bool ok = get_u32(fp, &attr->index) && get_u32(fp, &attr->n_dims);
+    for (int d = 0; ok && d < RKNN_MAX_DIMS; d++)
+    {
+        ok = get_u32(fp, &attr->dims[d]);
+    }
+    ok = ok && get_u32(fp, &attr->n_elems) && get_u32(fp, &attr->size) && get_u32(fp, &fmt) && get_u32(fp, &type) &&
+         get_u32(fp, &qnt_type) && get_i32(fp, &attr->zp) && get_f32(fp, &attr->scale);
+    attr->fmt = (rknn_tensor_format)fmt;
+    attr->type = (rknn_tensor_type)type;
+    attr->qnt_type = (rknn_tensor_qnt_type)qnt_type;
+    return ok;
+}
+
+static void free_replay_attrs(rknn_app_context_t *app_ctx)
+{
+    deinit_post_process_ctx(app_ctx);
+    free(app_ctx->output_attrs);
+    app_ctx->output_attrs = NULL;
+#if defined(ZERO_COPY)
+    free(app_ctx->output_native_attrs);
+    app_ctx->output_native_attrs = NULL;
+#endif
+}
+
+tensor_replay *tensor_replay_open(const char *path, rknn_app_context_t *app_ctx)
+{
+    FILE *fp = fopen(path, "rb");
+    if (fp == NULL)
+    {
+        printf("open tensor capture file fail: %s\n", path);
+        return NULL;
+    }
+    char magic[4];
+    uint32_t version = 0, layout = 0, n_output = 0, is_quant = 0;
+    int32_t model_w = 0, model_h = 0, model_c = 0;
+    if (fread(magic, 4, 1, fp) != 1 || memcmp(magic, TENSOR_CAPTURE_MAGIC, 4) != 0 || !get_u32(fp, &version) ||
+        version != TENSOR_CAPTURE_VERSION)
+    {
+        printf("%s: not a tensor capture file (or unsupported version)\n", path);
+        fclose(fp);
+        return NULL;
+    }
+    if (!get_u32(fp, &layout) || !get_u32(fp, &n_output) || !get_i32(fp, &model_w) || !get_i32(fp, &model_h) ||
+        !get_i32(fp, &model_c) || !get_u32(fp, &is_quant))
+    {
+        printf("%s: truncated header\n", path);
+        fclose(fp);
+        return NULL;
+    }
+    if (layout != TENSOR_CAPTURE_LAYOUT)
+    {
+        printf("%s: recorded with output layout %u, this build decodes layout %d\n", path, layout,
+               TENSOR_CAPTURE_LAYOUT);
+        fclose(fp);
+        return NULL;
+    }
+    if (n_output != 6 && n_output != 9)
+    {
+        printf("%s: unexpected output num %u\n", path, n_output);
+        fclose(fp);
+        return NULL;
+    }
+
+    tensor_replay *replay = new tensor_replay();
+    replay->fp = fp;
+    replay->n_output = n_output;
+    replay->sizes.resize(n_output);
+    replay->data.resize(n_output);
+    app_ctx->io_num.n_output = n_output;
+    app_ctx->model_width = model_w;
+    app_ctx->model_height = model_h;
+    app_ctx->model_channel = model_c;
+    app_ctx->is_quant = is_quant != 0;
+    app_ctx->output_attrs = (rknn_tensor_attr *)calloc(n_output, sizeof(rknn_tensor_attr));
+    bool ok = app_ctx->output_attrs != NULL;
+    for (uint32_t i = 0; ok && i < n_output; i++)
+    {
+        ok = get_attr(fp, &app_ctx->output_attrs[i]) && get_u32(fp, &replay->sizes[i]);
+    }
+#if defined(ZERO_COPY)
+    app_ctx->output_native_attrs = (rknn_tensor_attr *)calloc(n_output, sizeof(rknn_tensor_attr));
+    ok = ok && app_ctx->output_native_attrs != NULL;
+    for (uint32_t i = 0; ok && i < n_output; i++)
+    {
+        ok = get_attr(fp, &app_ctx->output_native_attrs[i]);
+    }
+#endif
+    if (!ok)
+    {
+        printf("%s: truncated tensor attrs\n", path);
+        tensor_replay_close(replay, app_ctx);
+        return NULL;
+    }
+    if (init_post_process_ctx(app_ctx) < 0)
+    {
+        printf("%s: init_post_process_ctx fail\n", path);
+        tensor_replay_close(replay, app_ctx);
+        return NULL;
+    }
+
+    for (int i = 0; i < replay->n_output; i++)
+    {
+        replay->data[i].resize(replay->sizes[i]);
+#if defined(RV1106_1103) || defined(ZERO_COPY)
+        memset(&replay->mems[i], 0, sizeof(rknn_tensor_mem));
+        replay->mems[i].virt_addr = replay->data[i].data();
+        replay->mems[i].size = replay->sizes[i];
+        replay->mem_ptrs[i] = &replay->mems[i];
+#else
+        memset(&replay->outputs[i], 0, sizeof(rknn_output));
+        replay->outputs[i].index = i;
+        replay->outputs[i].want_float = !app_ctx->is_quant;
+        replay->outputs[i].buf = replay->data[i].data();
+        replay->outputs[i].size = replay->sizes[i];
+#endif
+    }
+    return replay;
+}
+
+int tensor_replay_next(tensor_replay *replay, void **outputs, letterbox_t *letter_box, int *src_width,
+                       int *src_height)
+{
+    char magic[4];
+    if (fread(magic, 4, 1, replay->fp) != 1)
+    {
+        return 0;
+    }
+    uint32_t seq;
+    int32_t x_pad, y_pad;
+    if (memcmp(magic, TENSOR_CAPTURE_FRAME_MAGIC, 4) != 0 || !get_u32(replay->fp, &seq) ||
+        !get_i32(replay->fp, src_width) || !get_i32(replay->fp, src_height) || !get_i32(replay->fp, &x_pad) ||
+        !get_i32(replay->fp, &y_pad) || !get_f32(replay->fp, &letter_box->scale))
+    {
+        printf("tensor replay: bad frame record\n");
+        return -1;
+    }
+    letter_box->x_pad = x_pad;
+    letter_box->y_pad = y_pad;
+    for (int i = 0; i < replay->n_output; i++)
+    {
+        uint32_t encoding, stored;
+        if (!get_u32(replay->fp, &encoding) || !get_u32(replay->fp, &stored))
+        {
+            printf("tensor replay: frame %u truncated\n", seq);
+            return -1;
+        }
+        uint8_t *dst = replay->data[i].data();
+        if (encoding == TENSOR_ENCODING_RAW)
+        {
+            if (stored != replay->sizes[i] || fread(dst, 1, stored, replay->fp) != stored)
+            {
+                printf("tensor replay: frame %u output %d truncated\n", seq, i);
+                return -1;
+            }
+            continue;
+        }
+        replay->encoded.resize(stored);
+        if (encoding != TENSOR_ENCODING_PACKBITS || fread(replay->encoded.data(), 1, stored, replay->fp) != stored ||
+            packbits_decode(replay->encoded.data(), stored, dst, replay->sizes[i]) != 0)
+        {
+            printf("tensor replay: frame %u output %d corrupted\n", seq, i);
+            return -1;
+        }
+    }
+#if defined(RV1106_1103) || defined(ZERO_COPY)
+    *outputs = replay->mem_ptrs;
+#else
+    *outputs = replay->outputs;
+#endif
+    return 1;
+}
+
+void tensor_replay_close(tensor_replay *replay, rknn_app_context_t *app_ctx)
+{
+    if (replay == NULL)
+    {
+        return;
+    }
+    fclose(replay->fp);
+    delete replay;
+    free_replay_attrs(app_ctx);
+}
@@ -0,0 +1,51 @@
+#ifndef _RKNN_YOLOV8_DEMO_TENSOR_CAPTURE_H_
+#define _RKNN_YOLOV8_DEMO_TENSOR_CAPTURE_H_
+
+#include "yolov8.h"
+
+// 录制文件记录的输出布局，与编译平台对应；回放程序只接受同一布局的录制（post_process 的寻址方式按平台编译）
+#define TENSOR_CAPTURE_LAYOUT_NCHW 0       // 通用 RKNPU2（rknn_output 数组）及 CPU 后端
+#define TENSOR_CAPTURE_LAYOUT_ZERO_COPY 1  // zero copy 原生输出（rknn_tensor_mem* 数组）
+#define TENSOR_CAPTURE_LAYOUT_RV1106 2     // RV1106/1103 NHWC（rknn_tensor_mem* 数组）
+#define TENSOR_CAPTURE_LAYOUT_RKNPU1 3     // RKNPU1（rknn_output 数组）
+
+/**
+ * @brief 开始录制：之后每帧送入 post_process 的原始输出张量连同 letterbox 参数、源图尺寸写入 path
+ *        文件头保存输出张量属性（首帧时写入）；张量按字节游程编码（PackBits），score 输出中大段的背景值可大幅压缩
+ *        多个上下文共用同一文件，帧按完成顺序写入，记录间互斥
+ * @param max_frames 录制帧数上限，达到后自动停止；0 表示不限
+ */
+int tensor_capture_start(const char *path, int max_frames);
+
+/**
+ * @brief 停止录制并关闭文件（未开始录制时无操作）
+ */
+void tensor_capture_stop();
+
+/**
+ * @brief 录制一帧（未开始录制时立即返回），在 post_process 之前调用，outputs 与传给 post_process 的相同
+ */
+void tensor_capture_frame(rknn_app_context_t *app_ctx, void *outputs, const letterbox_t *letter_box, int src_width,
+                          int src_height);
+
+struct tensor_replay;
+
+/**
+ * @brief 打开录制文件：按文件头填充 app_ctx 的输出属性、模型尺寸与量化参数，并调用 init_post_process_ctx
+ *        app_ctx 需已清零，之后可直接用于 post_process；失败返回 NULL
+ */
+tensor_replay *tensor_replay_open(const char *path, rknn_app_context_t *app_ctx);
+
+/**
+ * @brief 读取下一帧：outputs 指向回放器持有的输出（格式与录制时传给 post_process 的相同），在下一次调用前有效
+ * @return 1 读到一帧，0 文件结束，-1 文件损坏
+ */
+int tensor_replay_next(tensor_replay *replay, void **outputs, letterbox_t *letter_box, int *src_width,
+                       int *src_height);
+
+/**
+ * @brief 关闭回放文件并释放 tensor_replay_open 为 app_ctx 创建的属性表与后处理缓存
+ */
+void tensor_replay_close(tensor_replay *replay, rknn_app_context_t *app_ctx);
+
+#endif //_RKNN_YOLOV8_DEMO_TENSOR_CAPTURE_H_
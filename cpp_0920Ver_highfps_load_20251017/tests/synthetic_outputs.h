@@ -0,0 +1,119 @@
+#ifndef TESTS_SYNTHETIC_OUTPUTS_H
+#define TESTS_SYNTHETIC_OUTPUTS_H
+
+// 合成的 YOLOv8 检测模型输出：3 个分支 × (box, score, score_sum)，NCHW，供后处理测试使用
+// 网格为 model_size / 8、/ 16、/ 32；box 通道数 4 * 16
+#include <math.h>
+#include <string.h>
+#include <random>
+#include <vector>
+#include "yolov8.h"
+
+#define SYNTHETIC_OUTPUT_NUM 9
+#define SYNTHETIC_DFL_LEN 16
+
+struct synthetic_outputs {
+    rknn_app_context_t ctx;
+    rknn_tensor_attr attrs[SYNTHETIC_OUTPUT_NUM];
+    std::vector<uint8_t> bufs[SYNTHETIC_OUTPUT_NUM];
+    rknn_output outputs[SYNTHETIC_OUTPUT_NUM];
+};
+
+static inline int synthetic_elem_size(rknn_tensor_type type)
+{
+    return type == RKNN_TENSOR_FLOAT32 ? 4 : 1;
+}
+
+/**
+ * @brief 填写上下文与输出属性并分配输出缓冲区（内容为 0），不调用 init_post_process_ctx
+ * @param type RKNN_TENSOR_INT8 / RKNN_TENSOR_UINT8 / RKNN_TENSOR_FLOAT32
+ * @param box_zp box 输出的零点，score 输出固定为覆盖 [0, 1] 的量化参数
+ */
+static void init_synthetic_outputs(synthetic_outputs *s, rknn_tensor_type type, int model_size, int class_num,
+                                   int32_t box_zp, float box_scale)
+{
+    memset(&s->ctx, 0, sizeof(s->ctx));
+    memset(s->attrs, 0, sizeof(s->attrs));
+    memset(s->outputs, 0, sizeof(s->outputs));
+    s->ctx.io_num.n_input = 1;
+    s->ctx.io_num.n_output = SYNTHETIC_OUTPUT_NUM;
+    s->ctx.output_attrs = s->attrs;
+    s->ctx.model_channel = 3;
+    s->ctx.model_width = model_size;
+    s->ctx.model_height = model_size;
+    s->ctx.is_quant = type != RKNN_TENSOR_FLOAT32;
+    for (int i = 0; i < SYNTHETIC_OUTPUT_NUM; i++)
+    {
+        int grid = model_size / (8 << (i / 3));
+        int channel = i % 3 == 0 ? 4 * SYNTHETIC_DFL_LEN : (i % 3 == 1 ? class_num : 1);
+        rknn_tensor_attr *attr = &s->attrs[i];
+        attr->index = i;
+        attr->n_dims = 4;
+        attr->dims[0] = 1;
+        attr->dims[1] = channel;
+        attr->dims[2] = grid;
+        attr->dims[3] = grid;
+        attr->n_elems = channel * grid * grid;
+        attr->size = attr->n_elems * synthetic_elem_size(type);
+        attr->fmt = RKNN_TENSOR_NCHW;
+        attr->type = type;
+        attr->qnt_type = s->ctx.is_quant ? RKNN_TENSOR_QNT_AFFINE_ASYMMETRIC : RKNN_TENSOR_QNT_NONE;
+        if (i % 3 == 0)
+        {
+            attr->zp = box_zp;
+            attr->scale = box_scale;
+        }
+        else
+        {
+            attr->zp = type == RKNN_TENSOR_INT8 ? -128 : 0;
+            attr->scale = 1.0f / 255;
+        }
+        s->bufs[i].assign(attr->size, 0);
+        s->outputs[i].index = i;
+        s->outputs[i].buf = s->bufs[i].data();
+        s->outputs[i].size = attr->size;
+    }
+}
+
+// 浮点值按输出属性写入第 idx 个元素（量化类型饱和到取值范围）
+static void synthetic_store(synthetic_outputs *s, int out, int idx, float v)
+{
+    const rknn_tensor_attr *attr = &s->attrs[out];
+    if (attr->type == RKNN_TENSOR_FLOAT32)
+    {
+        memcpy(&s->bufs[out][idx * 4], &v, 4);
+        return;
+    }
+    int lo = attr->type == RKNN_TENSOR_INT8 ? -128 : 0;
+    int q = (int)lrintf(v / attr->scale) + attr->zp;
+    q = q < lo ? lo : (q > lo + 255 ? lo + 255 : q);
+    s->bufs[out][idx] = (uint8_t)q;
+}
+
+/**
+ * @brief 生成一帧随机输出：约 density 比例的网格为目标（分数高于阈值），其余为低分背景
+ */
+static void fill_synthetic_outputs(synthetic_outputs *s, std::mt19937 &rng, float density)
+{
+    std::uniform_real_distribution<float> uniform(0.0f, 1.0f);
+    for (int b = 0; b < 3; b++)
+    {
+        int grid_len = s->attrs[b * 3].dims[2] * s->attrs[b * 3].dims[3];
+        int class_num = s->attrs[b * 3 + 1].dims[1];
+        for (int n = 0; n < grid_len; n++)
+        {
+            bool hot = uniform(rng) < density;
+            for (int c = 0; c < 4 * SYNTHETIC_DFL_LEN; c++)
+            {
+                synthetic_store(s, b * 3, c * grid_len + n, uniform(rng) * 10 - 5);
+            }
+            for (int c = 0; c < class_num; c++)
+            {
+                synthetic_store(s, b * 3 + 1, c * grid_len + n, hot ? uniform(rng) : uniform(rng) * 0.2f);
+            }
+            synthetic_store(s, b * 3 + 2, n, hot ? 0.3f + uniform(rng) : uniform(rng) * 0.2f);
+        }
+    }
+}
+
+#endif // TESTS_SYNTHETIC_OUTPUTS_H
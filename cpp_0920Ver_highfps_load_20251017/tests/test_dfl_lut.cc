@@ -0,0 +1,120 @@
+// DFL 查找表解码与基线实现（逐元素反量化后 exp）比较：int8 / uint8 的全部零点 × 模型常见的 box scale
+// 查找表由 init_post_process_ctx 构建；框坐标误差按最大 stride（32）换算成模型输入像素，
+// 须不超过 postprocess.h 中的 DFL_LUT_MAX_ERROR_PX；float 输出（expf）同样检查
+// 直接包含 postprocess.cc 以调用其中的 static 解码函数
+#include "postprocess.cc"
+#include "synthetic_outputs.h"
+
+#define MAX_STRIDE 32
+#define VECTORS_PER_PARAM 64
+
+static const float box_scales[] = {0.01f, 0.03f, 0.05f, 0.08f, 0.1f, 0.15f, 0.2f, 0.3f};
+
+// 基线实现（查找表之前的 compute_dfl），tensor 为已反量化的 4 * dfl_len 个连续元素
+static void baseline_compute_dfl(float *tensor, int dfl_len, float *box)
+{
+    for (int b = 0; b < 4; b++)
+    {
+        float exp_t[DFL_LEN_MAX];
+        float exp_sum = 0;
+        float acc_sum = 0;
+        for (int i = 0; i < dfl_len; i++)
+        {
+            exp_t[i] = exp(tensor[i + b * dfl_len]);
+            exp_sum += exp_t[i];
+        }
+
+        for (int i = 0; i < dfl_len; i++)
+        {
+            acc_sum += exp_t[i] / exp_sum * i;
+        }
+        box[b] = acc_sum;
+    }
+}
+
+static float box_error_px(const float *box, const float *ref)
+{
+    float err = 0;
+    for (int b = 0; b < 4; b++)
+    {
+        err = fmaxf(err, fabsf(box[b] - ref[b]) * MAX_STRIDE);
+    }
+    return err;
+}
+
+// 某一组 (类型, zp, scale) 的最大误差；查找表取自 init_post_process_ctx
+template <typename T>
+static float check_quant_param(std::mt19937 &rng, rknn_tensor_type type, int32_t zp, float scale)
+{
+    synthetic_outputs s;
+    init_synthetic_outputs(&s, type, 64, 1, zp, scale);
+    if (init_post_process_ctx(&s.ctx) != 0 || s.ctx.dfl_exp_lut == NULL)
+    {
+        printf("init_post_process_ctx failed: zp %d scale %f\n", zp, scale);
+        return INFINITY;
+    }
+    const float *lut = s.ctx.dfl_exp_lut;
+    float max_err = 0;
+    T tensor[4 * SYNTHETIC_DFL_LEN];
+    float deq[4 * SYNTHETIC_DFL_LEN];
+    for (int v = 0; v < VECTORS_PER_PARAM; v++)
+    {
+        for (int i = 0; i < 4 * SYNTHETIC_DFL_LEN; i++)
+        {
+            tensor[i] = (T)(rng() & 0xff);
+            deq[i] = ((float)tensor[i] - (float)zp) * scale;
+        }
+        float ref[4];
+        float box[4];
+        baseline_compute_dfl(deq, SYNTHETIC_DFL_LEN, ref);
+        compute_dfl<SYNTHETIC_DFL_LEN>(tensor, 1, SYNTHETIC_DFL_LEN, lut, box);
+        max_err = fmaxf(max_err, box_error_px(box, ref));
+        compute_dfl<0>(tensor, 1, SYNTHETIC_DFL_LEN, lut, box);
+        max_err = fmaxf(max_err, box_error_px(box, ref));
+    }
+    deinit_post_process_ctx(&s.ctx);
+    return max_err;
+}
+
+static float check_float(std::mt19937 &rng)
+{
+    std::uniform_real_distribution<float> uniform(-12.0f, 12.0f);
+    float max_err = 0;
+    float tensor[4 * SYNTHETIC_DFL_LEN];
+    for (int v = 0; v < 4096; v++)
+    {
+        for (int i = 0; i < 4 * SYNTHETIC_DFL_LEN; i++)
+        {
+            tensor[i] = uniform(rng);
+        }
+        float ref[4];
+        float box[4];
+        baseline_compute_dfl(tensor, SYNTHETIC_DFL_LEN, ref);
+        compute_dfl<SYNTHETIC_DFL_LEN>(tensor, 1, SYNTHETIC_DFL_LEN, NULL, box);
+        max_err = fmaxf(max_err, box_error_px(box, ref));
+    }
+    return max_err;
+}
+
+int main()
+{
+    std::mt19937 rng(20251017);
+    float max_int8 = 0;
+    float max_uint8 = 0;
+    for (float scale : box_scales)
+    {
+        for (int zp = -128; zp <= 127; zp++)
+        {
+            max_int8 = fmaxf(max_int8, check_quant_param<int8_t>(rng, RKNN_TENSOR_INT8, zp, scale));
+        }
+        for (int zp = 0; zp <= 255; zp++)
+        {
+            max_uint8 = fmaxf(max_uint8, check_quant_param<uint8_t>(rng, RKNN_TENSOR_UINT8, zp, scale));
+        }
+    }
+    float max_float = check_float(rng);
+    printf("dfl max box error (px, stride %d): int8 %g, uint8 %g, float %g, limit %g\n", MAX_STRIDE, max_int8,
+           max_uint8, max_float, DFL_LUT_MAX_ERROR_PX);
+    bool ok = max_int8 <= DFL_LUT_MAX_ERROR_PX && max_uint8 <= DFL_LUT_MAX_ERROR_PX && max_float <= DFL_LUT_MAX_ERROR_PX;
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,174 @@
+// 流水线模式与顺序模式的一致性：同一帧序列分别经两种模式推理（rknnrt_sim_ 模拟运行时，输出由输入内容决定），
+// 经 AdmissionController（BLOCK，严格按序）取回，断言两种模式下帧按提交顺序交付、逐帧检测结果完全相同
+#include <stdio.h>
+#include <stdlib.h>
+#include <random>
+#include <vector>
+#include "admission_controller.h"
+#include "model_wrapper.h"
+
+#define FRAME_NUM 96
+#define CONTEXT_NUM 3
+#define WAIT_TIMEOUT_MS 5000
+
+static const char* kModelPath = "test_pipeline_sim.rknn";
+
+struct RunResult {
+    std::vector<int> order;                              // 交付的帧下标，按交付顺序
+    std::vector<object_detect_result_list> detections;   // 按帧下标
+    ContextPoolStats context_stats;
+};
+
+// 模拟运行时不解析模型内容，只需要一个非空文件
+static bool write_model_file() {
+    FILE* fp = fopen(kModelPath, "wb");
+    if (fp == NULL) {
+        printf("create %s failed\n", kModelPath);
+        return false;
+    }
+    fputs("rknnrt_sim", fp);
+    fclose(fp);
+    return true;
+}
+
+static bool run(bool pipelined, const std::vector<cv::Mat>& frames, RunResult& out) {
+    Yolov8Model model;
+    if (!model.init(kModelPath, CONTEXT_NUM, pipelined)) {
+        printf("model init failed (pipelined=%d)\n", pipelined);
+        return false;
+    }
+    // 在途帧数多于上下文数：流水线模式下各上下文的帧交错完成，须经重排才能按序交付
+    AdmissionConfig config;
+    config.max_in_flight = CONTEXT_NUM * 2;
+    config.policy = DropPolicy::BLOCK;
+    AdmissionController admission(model, config);
+
+    // 交付的帧按 FrameRef 对应回帧下标
+    std::vector<FrameRef> refs;
+    for (const cv::Mat& frame : frames) {
+        refs.push_back(std::make_shared<cv::Mat>(frame));
+    }
+    out.detections.assign(frames.size(), object_detect_result_list());
+    FrameRef done;
+    object_detect_result_list results;
+    auto collect = [&](int wait_ms) {
+        if (!admission.next_completed(done, results, wait_ms)) {
+            return false;
+        }
+        int index = -1;
+        for (size_t k = 0; k < refs.size(); ++k) {
+            if (refs[k] == done) {
+                index = (int)k;
+            }
+        }
+        out.order.push_back(index);
+        if (index >= 0) {
+            out.detections[index] = results;
+        }
+        done.reset();
+        return true;
+    };
+
+    bool ok = true;
+    for (size_t k = 0; k < frames.size() && ok; ++k) {
+        admission.offer(refs[k]);
+        while (ok && admission.backlogged()) {
+            ok = collect(WAIT_TIMEOUT_MS);
+        }
+        while (ok && collect(0)) {
+        }
+    }
+    while (ok && admission.submitted_count() > 0) {
+        ok = collect(WAIT_TIMEOUT_MS);
+    }
+    if (!ok) {
+        printf("timed out waiting for results (pipelined=%d)\n", pipelined);
+    }
+    out.context_stats = model.context_wait_stats();
+    model.release();
+    return ok;
+}
+
+static bool same_detections(const object_detect_result_list& a, const object_detect_result_list& b) {
+    if (a.count != b.count) {
+        return false;
+    }
+    for (int i = 0; i < a.count; ++i) {
+        const object_detect_result& x = a.results[i];
+        const object_detect_result& y = b.results[i];
+        if (x.box.left != y.box.left || x.box.top != y.box.top || x.box.right != y.box.right ||
+            x.box.bottom != y.box.bottom || x.prop != y.prop || x.cls_id != y.cls_id) {
+            return false;
+        }
+    }
+    return true;
+}
+
+int main() {
+    // 快速、可复现的模拟参数；已在环境中设置的保持不变
+    setenv("RKNN_SIM_INIT_MS", "0", 0);
+    setenv("RKNN_SIM_DUP_MS", "0", 0);
+    setenv("RKNN_SIM_LATENCY_MS", "4", 0);
+    setenv("RKNN_SIM_JITTER_MS", "3", 0);
+    setenv("RKNN_SIM_OBJECTS", "8", 0);
+    if (!write_model_file()) {
+        return 1;
+    }
+
+    // 每帧内容不同（少数帧重复），尺寸在 720p 与 480p 之间切换
+    std::mt19937 rng(20251017);
+    std::vector<cv::Mat> frames;
+    for (int k = 0; k < FRAME_NUM; ++k) {
+        if (k % 16 == 15) {
+            frames.push_back(frames[k - 1].clone());
+            continue;
+        }
+        cv::Mat frame = (k / 32) % 2 == 0 ? cv::Mat(720, 1280, CV_8UC3) : cv::Mat(480, 640, CV_8UC3);
+        for (size_t i = 0; i < frame.total() * 3; ++i) {
+            frame.data[i] = (unsigned char)(rng() & 0xff);
+        }
+        frames.push_back(frame);
+    }
+
+    RunResult sequential;
+    RunResult pipelined;
+    if (!run(false, frames, sequential) || !run(true, frames, pipelined)) {
+        return 1;
+    }
+
+    int failures = 0;
+    // 顺序模式每帧借用一个上下文，流水线模式不借用：确认两次运行确实走了不同的执行路径
+    if (sequential.context_stats.checkouts != FRAME_NUM || pipelined.context_stats.checkouts != 0) {
+        printf("unexpected execution mode: sequential checkouts %llu, pipelined checkouts %llu\n",
+               (unsigned long long)sequential.context_stats.checkouts,
+               (unsigned long long)pipelined.context_stats.checkouts);
+        failures++;
+    }
+    const RunResult* runs[2] = {&sequential, &pipelined};
+    for (int r = 0; r < 2; ++r) {
+        bool in_order = runs[r]->order.size() == frames.size();
+        for (size_t k = 0; k < runs[r]->order.size() && in_order; ++k) {
+            in_order = runs[r]->order[k] == (int)k;
+        }
+        if (!in_order) {
+            printf("%s mode delivered %zu frames out of submission order\n", r == 0 ? "sequential" : "pipelined",
+                   runs[r]->order.size());
+            failures++;
+        }
+    }
+    int detections = 0;
+    for (size_t k = 0; k < frames.size(); ++k) {
+        detections += sequential.detections[k].count;
+        if (!same_detections(sequential.detections[k], pipelined.detections[k])) {
+            printf("frame %zu: sequential %d detections, pipelined %d detections differ\n", k,
+                   sequential.detections[k].count, pipelined.detections[k].count);
+            failures++;
+        }
+    }
+    if (detections == 0) {
+        printf("no detections from the simulated runtime\n");
+        failures++;
+    }
+    printf("pipeline sim: %d frames, %d detections, %d failures\n", FRAME_NUM, detections, failures);
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,174 @@
+// 稳态后处理零堆分配：替换 operator new 与 malloc 系列为计数版本，
+// int8 / uint8 / float32 合成输出各预热一轮后再调用 post_process，断言期间没有任何堆分配
+// AddressSanitizer 自己接管 malloc，此时跳过（返回 77）
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <atomic>
+#include <new>
+#include "synthetic_outputs.h"
+
+#if defined(__SANITIZE_ADDRESS__) || defined(__SANITIZE_THREAD__)
+#define ALLOC_COUNTING_UNSUPPORTED
+#endif
+
+#define TEST_SKIPPED 77
+#define FRAMES_PER_TYPE 8
+#define COUNTED_CALLS 400
+
+static std::atomic<bool> g_counting(false);
+static std::atomic<long> g_new_calls(0);
+static std::atomic<long> g_malloc_calls(0);
+
+#if !defined(ALLOC_COUNTING_UNSUPPORTED)
+#if defined(__GLIBC__)
+extern "C" {
+void *__libc_malloc(size_t size);
+void *__libc_calloc(size_t n, size_t size);
+void *__libc_realloc(void *ptr, size_t size);
+void *__libc_memalign(size_t alignment, size_t size);
+
+static inline void count_malloc()
+{
+    if (g_counting.load(std::memory_order_relaxed))
+    {
+        g_malloc_calls++;
+    }
+}
+
+void *malloc(size_t size)
+{
+    count_malloc();
+    return __libc_malloc(size);
+}
+
+void *calloc(size_t n, size_t size)
+{
+    count_malloc();
+    return __libc_calloc(n, size);
+}
+
+void *realloc(void *ptr, size_t size)
+{
+    count_malloc();
+    return __libc_realloc(ptr, size);
+}
+
+void *memalign(size_t alignment, size_t size)
+{
+    count_malloc();
+    return __libc_memalign(alignment, size);
+}
+
+void *aligned_alloc(size_t alignment, size_t size)
+{
+    count_malloc();
+    return __libc_memalign(alignment, size);
+}
+
+int posix_memalign(void **ptr, size_t alignment, size_t size)
+{
+    count_malloc();
+    *ptr = __libc_memalign(alignment, size);
+    return *ptr != NULL ? 0 : ENOMEM;
+}
+}
+#endif
+
+static void *counted_new(size_t size)
+{
+    if (g_counting.load(std::memory_order_relaxed))
+    {
+        g_new_calls++;
+    }
+    void *p = malloc(size != 0 ? size : 1);
+    if (p == NULL)
+    {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void *operator new(size_t size) { return counted_new(size); }
+void *operator new[](size_t size) { return counted_new(size); }
+void *operator new(size_t size, const std::nothrow_t &) noexcept
+{
+    try
+    {
+        return counted_new(size);
+    }
+    catch (...)
+    {
+        return NULL;
+    }
+}
+void *operator new[](size_t size, const std::nothrow_t &) noexcept { return operator new(size, std::nothrow); }
+void operator delete(void *p) noexcept { free(p); }
+void operator delete[](void *p) noexcept { free(p); }
+void operator delete(void *p, size_t) noexcept { free(p); }
+void operator delete[](void *p, size_t) noexcept { free(p); }
+void operator delete(void *p, const std::nothrow_t &) noexcept { free(p); }
+void operator delete[](void *p, const std::nothrow_t &) noexcept { free(p); }
+#endif
+
+static const float frame_densities[FRAMES_PER_TYPE] = {0.0f, 0.001f, 0.005f, 0.01f, 0.02f, 0.05f, 0.1f, 0.3f};
+
+static int check_type(rknn_tensor_type type, const char *name)
+{
+    std::mt19937 rng(20251017);
+    // 每帧一份输出缓冲区；后处理上下文建在第一帧上
+    static synthetic_outputs frames[FRAMES_PER_TYPE];
+    for (int i = 0; i < FRAMES_PER_TYPE; i++)
+    {
+        init_synthetic_outputs(&frames[i], type, 640, 80, type == RKNN_TENSOR_UINT8 ? 128 : 0, 0.08f);
+        fill_synthetic_outputs(&frames[i], rng, frame_densities[i]);
+    }
+    rknn_app_context_t *ctx = &frames[0].ctx;
+    if (init_post_process_ctx(ctx) != 0)
+    {
+        printf("%s: init_post_process_ctx failed\n", name);
+        return 1;
+    }
+
+    letterbox_t letter_box = {0, 0, 1.0f};
+    object_detect_result_list od_results;
+    int detections = 0;
+    for (int i = 0; i < FRAMES_PER_TYPE; i++)
+    {
+        post_process(ctx, frames[i].outputs, &letter_box, BOX_THRESH, NMS_THRESH, &od_results);
+    }
+
+    g_new_calls = 0;
+    g_malloc_calls = 0;
+    g_counting = true;
+    for (int i = 0; i < COUNTED_CALLS; i++)
+    {
+        post_process(ctx, frames[i % FRAMES_PER_TYPE].outputs, &letter_box, BOX_THRESH, NMS_THRESH, &od_results);
+        detections += od_results.count;
+    }
+    g_counting = false;
+
+    deinit_post_process_ctx(ctx);
+    printf("%s: %d calls, %d detections, %ld operator new, %ld malloc\n", name, COUNTED_CALLS, detections,
+           g_new_calls.load(), g_malloc_calls.load());
+    if (detections == 0)
+    {
+        printf("%s: synthetic outputs produced no detections\n", name);
+        return 1;
+    }
+    return g_new_calls == 0 && g_malloc_calls == 0 ? 0 : 1;
+}
+
+int main()
+{
+#if defined(ALLOC_COUNTING_UNSUPPORTED)
+    printf("allocation counting is not available under sanitizers, skipped\n");
+    return TEST_SKIPPED;
+#else
+    int failures = 0;
+    failures += check_type(RKNN_TENSOR_INT8, "int8");
+    failures += check_type(RKNN_TENSOR_UINT8, "uint8");
+    failures += check_type(RKNN_TENSOR_FLOAT32, "float32");
+    return failures == 0 ? 0 : 1;
+#endif
+}
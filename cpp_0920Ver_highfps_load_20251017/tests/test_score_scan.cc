@@ -0,0 +1,161 @@
+// 候选筛选一致性：向量预筛（NEON / SSE2，加标量尾部）与纯标量筛选在随机量化张量上逐项比较
+// 候选网格、类别、分数都须完全一致；数据集中在量化阈值附近（阈值本身、±1）并制造类别间的并列
+// 直接包含 postprocess.cc 以调用其中的 static 解码函数
+#include "postprocess.cc"
+
+#include <random>
+
+static const int grid_lens[] = {1, 7, 15, 16, 17, 31, 33, 255, 1601, 6400};
+static const int class_nums[] = {1, 5, 80};
+
+template <typename T>
+static T clamp_q(int v)
+{
+    int lo = (T)-1 < 0 ? -128 : 0;
+    int hi = (T)-1 < 0 ? 127 : 255;
+    return (T)(v < lo ? lo : (v > hi ? hi : v));
+}
+
+// 一半取 阈值-1 / 阈值 / 阈值+1，其余在整个量化域中均匀分布
+template <typename T>
+static T near_threshold(std::mt19937 &rng, T thres)
+{
+    if (rng() % 2 == 0)
+    {
+        return clamp_q<T>((int)thres + (int)(rng() % 3) - 1);
+    }
+    return clamp_q<T>((int)(rng() % 256) + ((T)-1 < 0 ? -128 : 0));
+}
+
+// 标量参考：逐网格筛选，类别取第一个最大值
+template <typename T>
+static void reference_decode(const T *score, const T *score_sum, int grid_len, int class_num, bool has_score_sum,
+                             T thres, T sum_thres, int32_t zp, float scale, std::vector<int> &grids,
+                             std::vector<int> &classes, std::vector<float> &probs)
+{
+    std::vector<int> candidates;
+    if (has_score_sum)
+    {
+        collect_candidates_scalar<0, true>(score, score_sum, 0, grid_len, class_num, thres, sum_thres, candidates);
+    }
+    else
+    {
+        collect_candidates_scalar<0, false>(score, score_sum, 0, grid_len, class_num, thres, sum_thres, candidates);
+    }
+    for (int n : candidates)
+    {
+        int best_class = 0;
+        for (int c = 1; c < class_num; c++)
+        {
+            if (score[c * grid_len + n] > score[best_class * grid_len + n])
+            {
+                best_class = c;
+            }
+        }
+        grids.push_back(n);
+        classes.push_back(best_class);
+        probs.push_back(score_to_f32(score[best_class * grid_len + n], zp, scale));
+    }
+}
+
+template <typename T>
+static int run_case(std::mt19937 &rng, rknn_tensor_type type, int grid_len, int class_num, bool has_score_sum)
+{
+    int32_t score_zp = (T)-1 < 0 ? -128 + (int)(rng() % 64) : (int)(rng() % 64);
+    float score_scale = 1.0f / (100 + rng() % 156);
+    int32_t sum_zp = (T)-1 < 0 ? -128 + (int)(rng() % 64) : (int)(rng() % 64);
+    float sum_scale = 1.0f / (100 + rng() % 156);
+    T thres = score_thres_of(BOX_THRESH, score_zp, score_scale, (const T *)nullptr);
+    T sum_thres = score_sum_thres_of(BOX_THRESH, sum_zp, sum_scale, (const T *)nullptr);
+
+    std::vector<T> score(grid_len * class_num);
+    std::vector<T> score_sum(grid_len);
+    for (int n = 0; n < grid_len; n++)
+    {
+        score_sum[n] = near_threshold(rng, sum_thres);
+        for (int c = 0; c < class_num; c++)
+        {
+            // 约三分之一与前一类别相等，检验并列时取较小的类别ID
+            score[c * grid_len + n] = c > 0 && rng() % 3 == 0 ? score[(c - 1) * grid_len + n] : near_threshold(rng, thres);
+        }
+    }
+    std::vector<T> box(4 * 16 * grid_len, (T)0);
+    std::vector<float> exp_lut(256, 1.0f);
+
+    decode_branch_args args;
+    memset(&args, 0, sizeof(args));
+    args.box = box.data();
+    args.box_exp_lut = exp_lut.data();
+    args.score = score.data();
+    args.score_zp = score_zp;
+    args.score_scale = score_scale;
+    args.score_sum = has_score_sum ? score_sum.data() : nullptr;
+    args.score_sum_zp = sum_zp;
+    args.score_sum_scale = sum_scale;
+    args.grid_h = 1;
+    args.grid_w = grid_len;
+    args.stride = 8;
+    args.dfl_len = 16;
+    args.class_num = class_num;
+    args.threshold = BOX_THRESH;
+
+    decode_kernel_t kernel = select_decode_kernel(type, false, 16, class_num, has_score_sum);
+    if (kernel == NULL)
+    {
+        printf("no decode kernel for type %s classes %d\n", get_type_string(type), class_num);
+        return 1;
+    }
+    post_process_scratch scratch;
+    kernel(args, scratch);
+
+    std::vector<int> grids;
+    std::vector<int> classes;
+    std::vector<float> probs;
+    reference_decode(score.data(), score_sum.data(), grid_len, class_num, has_score_sum, thres, sum_thres, score_zp,
+                     score_scale, grids, classes, probs);
+
+    if (scratch.candidates != grids || scratch.class_id != classes || scratch.obj_probs != probs)
+    {
+        printf("mismatch: type %s grid_len %d classes %d score_sum %d: %zu candidates vs %zu reference\n",
+               get_type_string(type), grid_len, class_num, has_score_sum, scratch.candidates.size(), grids.size());
+        for (size_t i = 0; i < scratch.candidates.size() && i < grids.size(); i++)
+        {
+            if (scratch.candidates[i] != grids[i] || scratch.class_id[i] != classes[i] || scratch.obj_probs[i] != probs[i])
+            {
+                printf("  #%zu: grid %d class %d prob %f vs grid %d class %d prob %f\n", i, scratch.candidates[i],
+                       scratch.class_id[i], scratch.obj_probs[i], grids[i], classes[i], probs[i]);
+                break;
+            }
+        }
+        return 1;
+    }
+    return 0;
+}
+
+int main()
+{
+    std::mt19937 rng(20251017);
+    int failures = 0;
+    int cases = 0;
+    for (int round = 0; round < 8; round++)
+    {
+        for (int grid_len : grid_lens)
+        {
+            for (int class_num : class_nums)
+            {
+                for (int has_score_sum = 0; has_score_sum < 2; has_score_sum++)
+                {
+                    failures += run_case<int8_t>(rng, RKNN_TENSOR_INT8, grid_len, class_num, has_score_sum);
+                    failures += run_case<uint8_t>(rng, RKNN_TENSOR_UINT8, grid_len, class_num, has_score_sum);
+                    cases += 2;
+                }
+            }
+        }
+    }
+#if defined(SCORE_SCAN_LANES)
+    printf("score scan: %d cases, %d lanes vector scan vs scalar, %d failed\n", cases, SCORE_SCAN_LANES, failures);
+#else
+    printf("score scan: %d cases, scalar only, %d failed\n", cases, failures);
+#endif
+    return failures == 0 ? 0 : 1;
+}
@@ -12,11 +12,15 @@
     }rknn_dma_buf;
 #endif
 
+struct post_process_scratch;
+struct letterbox_cache;
+
 typedef struct {
     rknn_context rknn_ctx;
     rknn_input_output_num io_num;
     rknn_tensor_attr* input_attrs;
     rknn_tensor_attr* output_attrs;
+    bool shared_attrs;     // 属性表（含原生属性表）由 dup 源上下文持有，只读共享，release 时不释放
 #if defined(RV1106_1103) 
     rknn_tensor_mem* input_mems[1];
     rknn_tensor_mem* output_mems[9];
@@ -27,11 +31,24 @@ typedef struct {
     rknn_tensor_mem* output_mems[9];
     rknn_tensor_attr* input_native_attrs;
     rknn_tensor_attr* output_native_attrs;
+#endif
+#if !defined(RV1106_1103) && !defined(ZERO_COPY)
+    unsigned char* input_buf;      // 预分配的模型输入（letterbox 后的 RGB888），init 时分配
+    rknn_output outputs[9];        // 预分配的输出缓冲区，rknn_outputs_get 以 is_prealloc 方式写入
+    unsigned char* pipeline_input_buf;            // 流水线模式的第二个输入缓冲区，与 input_buf 交替使用
+    struct letterbox_cache* pipeline_input_cache; // pipeline_input_buf 的 letterbox 几何缓存
+    rknn_run_extend run_extend;                   // 非阻塞 rknn_run 的帧号，rknn_wait 时使用
+    int batch;                                    // 模型输入的 batch 维；大于 1 时输入缓冲区依次存放 batch 帧
+    struct letterbox_cache* batch_input_caches;   // 两个输入槽中批量位置 1..batch-1 的 letterbox 几何缓存，首次使用时创建
 #endif
     int model_channel;
     int model_width;
     int model_height;
+    int class_num;         // 模型类别数（score 输出通道数）
     bool is_quant;
+    float* dfl_exp_lut;    // 每个输出张量 256 项的 exp(反量化值) 查找表，仅量化模型
+    struct post_process_scratch* pp_scratch;  // 后处理暂存区（init_post_process_ctx 创建）
+    struct letterbox_cache* input_cache;      // BGR 帧预处理的 letterbox 几何缓存（init 时创建）
 } rknn_app_context_t;
 
 #include "postprocess.h"
@@ -39,8 +56,54 @@ typedef struct {
 
 int init_yolov8_model(const char* model_path, rknn_app_context_t* app_ctx);
 
+// 从已初始化的 src_ctx 派生上下文：rknn_dup_context 共享权重，属性表只读共享，不再读取模型文件；
+// 须先于 src_ctx 释放。后端不支持时返回 -1，调用方可改用 init_yolov8_model
+int dup_yolov8_model(rknn_app_context_t* src_ctx, rknn_app_context_t* app_ctx);
+
 int release_yolov8_model(rknn_app_context_t* app_ctx);
 
 int inference_yolov8_model(rknn_app_context_t* app_ctx, image_buffer_t* img, object_detect_result_list* od_results);
 
+// 输入为 BGR888 帧（如 cv::Mat 的数据），通道交换、缩放与 letterbox 一次写入模型输入缓冲区
+int inference_yolov8_model_bgr(rknn_app_context_t* app_ctx, const unsigned char* bgr, int width, int height, int stride,
+                               object_detect_result_list* od_results);
+
+// inference_yolov8_model_bgr 的前半段：预处理并推理，输出留在上下文中，由调用方经 yolov8_model_outputs 后处理
+int run_yolov8_model_bgr(rknn_app_context_t* app_ctx, const unsigned char* bgr, int width, int height, int stride,
+                         letterbox_t* letter_box);
+
+// 上一次推理的输出，即 post_process 的 outputs 参数（rknn_output 数组，零拷贝时为 rknn_tensor_mem* 数组）
+void* yolov8_model_outputs(rknn_app_context_t* app_ctx);
+
+#if defined(ENABLE_RKNN_BACKEND) && !defined(RV1106_1103) && !defined(ZERO_COPY) && !defined(RKNPU1)
+// 流水线模式：两个输入槽交替使用，NPU 运行一帧时 CPU 预处理下一帧、解码上一帧
+#define YOLOV8_PIPELINE_SUPPORTED
+
+// 预处理 BGR888 帧到输入槽 slot（0 或 1）
+int prepare_yolov8_input_bgr(rknn_app_context_t* app_ctx, int slot, const unsigned char* bgr, int width, int height,
+                             int stride, letterbox_t* letter_box);
+
+// 设置输入槽 slot 并以非阻塞方式启动推理
+int run_yolov8_model_async(rknn_app_context_t* app_ctx, int slot);
+
+// 等待 run_yolov8_model_async 启动的推理完成，并把输出取到预分配的输出缓冲区
+int wait_yolov8_model_outputs(rknn_app_context_t* app_ctx);
+
+// 解码 wait_yolov8_model_outputs 取到的输出（可与下一帧的推理并行）
+int decode_yolov8_model_outputs(rknn_app_context_t* app_ctx, letterbox_t* letter_box, object_detect_result_list* od_results);
+
+// 批量推理（以 batch>1 导出的模型，app_ctx->batch 帧一次 rknn_run）：每个输入槽容纳一批，
+// 同样经 run_yolov8_model_async / wait_yolov8_model_outputs 推理；未填充的位置沿用上一批的数据，其结果由调用方忽略
+// 预处理 BGR888 帧到输入槽 slot 的第 index 个位置
+int prepare_yolov8_batch_input_bgr(rknn_app_context_t* app_ctx, int slot, int index, const unsigned char* bgr,
+                                   int width, int height, int stride, letterbox_t* letter_box);
+
+// 解码批量输出中第 index 帧的结果
+int decode_yolov8_batch_outputs(rknn_app_context_t* app_ctx, int index, letterbox_t* letter_box, int src_width,
+                                int src_height, object_detect_result_list* od_results);
+
+// 姿态模型（见 post_process_pose）：解码批量输出中第 index 个裁剪图的关键点
+int decode_yolov8_batch_pose(rknn_app_context_t* app_ctx, int index, letterbox_t* letter_box, object_pose_result* pose);
+#endif
+
 #endif //_RKNN_DEMO_YOLOV8_H_
\ No newline at end of file
@@ -0,0 +1,745 @@
+// librknnrt 的模拟实现：实现 rknn_api.h 中 yolov8 示例用到的接口子集，
+// 按配置的每核延迟分布与核数（并发上限）占用“NPU”，输出合成的 YOLOv8 int8 张量。
+// 用于在没有 NPU 的 Linux 构建机上运行真实可执行文件，测量线程池、上下文轮询与主循环的调度表现。
+//
+// 配置（环境变量，首次调用时读取）：
+//   RKNN_SIM_CORES        NPU 核数，即同时运行的推理数上限（默认 3）
+//   RKNN_SIM_LATENCY_MS   单次推理延迟均值，逗号分隔时按核给出，如 "18,18,25"（默认 20）
+//   RKNN_SIM_JITTER_MS    延迟抖动：normal 为标准差，uniform 为半宽（默认 2）
+//   RKNN_SIM_DIST         延迟分布 normal / uniform / fixed（默认 normal）
+//   RKNN_SIM_INIT_MS      rknn_init 耗时（默认 300），RKNN_SIM_DUP_MS rknn_dup_context 耗时（默认 30）
+//   RKNN_SIM_INPUT_SIZE   模型输入边长（默认 640），RKNN_SIM_CLASSES 类别数（默认 80）
+//   RKNN_SIM_OBJECTS      每帧合成的目标数（默认 8），RKNN_SIM_SEED 随机种子（默认 1）
+//   RKNN_SIM_BATCH        模型 batch 维（默认 1），RKNN_SIM_BATCH_COST 每多一帧增加的延迟比例（默认 0.5）
+//   RKNN_SIM_STATS        非 0 时进程退出前打印各核利用率与排队时间
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <stdint.h>
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "rknn_api.h"
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+// 原生输出布局 NC1HWC2 的 C2（int8）
+const int kNativeC2 = 16;
+// 每个输出分支的 DFL 长度
+const int kDflLen = 16;
+
+enum LatencyDist { DIST_NORMAL, DIST_UNIFORM, DIST_FIXED };
+
+struct SimConfig {
+    int cores;
+    std::vector<double> latency_ms;  // 每核均值
+    double jitter_ms;
+    LatencyDist dist;
+    int init_ms;
+    int dup_ms;
+    int input_size;
+    int classes;
+    int objects;
+    int batch;
+    double batch_cost;
+    unsigned seed;
+    bool stats;
+};
+
+int env_int(const char* name, int def) {
+    const char* v = getenv(name);
+    return (v && *v) ? atoi(v) : def;
+}
+
+double env_double(const char* name, double def) {
+    const char* v = getenv(name);
+    return (v && *v) ? atof(v) : def;
+}
+
+const SimConfig& config() {
+    static SimConfig cfg;
+    static std::once_flag once;
+    std::call_once(once, [] {
+        cfg.cores = std::max(1, env_int("RKNN_SIM_CORES", 3));
+        const char* lat = getenv("RKNN_SIM_LATENCY_MS");
+        std::string s = (lat && *lat) ? lat : "20";
+        size_t pos = 0;
+        while (pos <= s.size() && (int)cfg.latency_ms.size() < cfg.cores) {
+            size_t comma = s.find(',', pos);
+            std::string item = s.substr(pos, comma == std::string::npos ? std::string::npos : comma - pos);
+            if (!item.empty()) {
+                cfg.latency_ms.push_back(std::max(0.0, atof(item.c_str())));
+            }
+            if (comma == std::string::npos) {
+                break;
+            }
+            pos = comma + 1;
+        }
+        if (cfg.latency_ms.empty()) {
+            cfg.latency_ms.push_back(20.0);
+        }
+        // 只给出部分核时，其余核沿用最后一个值
+        while ((int)cfg.latency_ms.size() < cfg.cores) {
+            cfg.latency_ms.push_back(cfg.latency_ms.back());
+        }
+        cfg.jitter_ms = std::max(0.0, env_double("RKNN_SIM_JITTER_MS", 2.0));
+        const char* dist = getenv("RKNN_SIM_DIST");
+        cfg.dist = DIST_NORMAL;
+        if (dist && strcmp(dist, "uniform") == 0) {
+            cfg.dist = DIST_UNIFORM;
+        } else if (dist && strcmp(dist, "fixed") == 0) {
+            cfg.dist = DIST_FIXED;
+        }
+        cfg.init_ms = std::max(0, env_int("RKNN_SIM_INIT_MS", 300));
+        cfg.dup_ms = std::max(0, env_int("RKNN_SIM_DUP_MS", 30));
+        cfg.input_size = std::max(32, env_int("RKNN_SIM_INPUT_SIZE", 640)) / 32 * 32;
+        cfg.classes = std::max(1, env_int("RKNN_SIM_CLASSES", 80));
+        cfg.objects = std::max(0, env_int("RKNN_SIM_OBJECTS", 8));
+        cfg.batch = std::max(1, env_int("RKNN_SIM_BATCH", 1));
+        cfg.batch_cost = std::max(0.0, env_double("RKNN_SIM_BATCH_COST", 0.5));
+        cfg.seed = (unsigned)env_int("RKNN_SIM_SEED", 1);
+        cfg.stats = env_int("RKNN_SIM_STATS", 0) != 0;
+        printf("rknnrt_sim: cores=%d latency=%.1fms(core0) jitter=%.1fms input=%d classes=%d objects=%d batch=%d\n",
+               cfg.cores, cfg.latency_ms[0], cfg.jitter_ms, cfg.input_size, cfg.classes, cfg.objects, cfg.batch);
+    });
+    return cfg;
+}
+
+// 模拟的 NPU：每个核同一时刻只运行一个推理，多核 mask 需要其中的核全部空闲
+class SimNpu {
+public:
+    explicit SimNpu(int cores)
+        : busy_(cores, false), runs_(cores, 0), busy_ms_(cores, 0.0), wait_ms_(0.0), started_(false) {}
+
+    ~SimNpu() {
+        if (!config().stats || !started_) {
+            return;
+        }
+        double wall_ms = std::chrono::duration<double, std::milli>(Clock::now() - start_).count();
+        long total = 0;
+        for (size_t i = 0; i < busy_.size(); i++) {
+            total += runs_[i];
+            printf("rknnrt_sim: core %zu runs=%ld busy=%.0fms util=%.1f%%\n", i, runs_[i], busy_ms_[i],
+                   wall_ms > 0 ? busy_ms_[i] * 100.0 / wall_ms : 0.0);
+        }
+        printf("rknnrt_sim: total runs=%ld avg wait for core=%.2fms\n", total, total ? wait_ms_ / total : 0.0);
+    }
+
+    // 占用 mask 允许的核（AUTO 为任一空闲核），返回占用的核位图；阻塞直到可用
+    uint32_t acquire(uint32_t mask) {
+        const int n = (int)busy_.size();
+        uint32_t all = (n >= 32) ? 0xffffffffu : ((1u << n) - 1);
+        uint32_t want = mask & all;
+        Clock::time_point t0 = Clock::now();
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (!started_) {
+            start_ = t0;  // 利用率从第一次推理开始统计，不含模型加载
+            started_ = true;
+        }
+        uint32_t taken = 0;
+        cond_.wait(lock, [&] {
+            if (want == 0) {
+                for (int i = 0; i < n; i++) {
+                    if (!busy_[i]) {
+                        taken = 1u << i;
+                        return true;
+                    }
+                }
+                return false;
+            }
+            for (int i = 0; i < n; i++) {
+                if ((want >> i & 1) && busy_[i]) {
+                    return false;
+                }
+            }
+            taken = want;
+            return true;
+        });
+        for (int i = 0; i < n; i++) {
+            if (taken >> i & 1) {
+                busy_[i] = true;
+            }
+        }
+        wait_ms_ += std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+        return taken;
+    }
+
+    void release(uint32_t taken, double ms) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            for (size_t i = 0; i < busy_.size(); i++) {
+                if (taken >> i & 1) {
+                    busy_[i] = false;
+                    runs_[i]++;
+                    busy_ms_[i] += ms;
+                }
+            }
+        }
+        cond_.notify_all();
+    }
+
+private:
+    std::mutex mutex_;
+    std::condition_variable cond_;
+    std::vector<bool> busy_;
+    std::vector<long> runs_;
+    std::vector<double> busy_ms_;
+    double wait_ms_;
+    bool started_;
+    Clock::time_point start_;
+};
+
+SimNpu& npu() {
+    static SimNpu instance(config().cores);
+    return instance;
+}
+
+struct SimTensor {
+    rknn_tensor_attr attr;         // NCHW
+    rknn_tensor_attr native_attr;  // NC1HWC2（输入为 NHWC）
+};
+
+// 模型描述（dup 的上下文共享）
+struct SimModel {
+    SimTensor input;
+    std::vector<SimTensor> outputs;
+};
+
+void fill_output_attr(SimTensor& t, int index, const char* name, int c, int h, int w, int32_t zp, float scale) {
+    const int batch = config().batch;
+    rknn_tensor_attr& a = t.attr;
+    memset(&a, 0, sizeof(a));
+    a.index = index;
+    snprintf(a.name, RKNN_MAX_NAME_LEN, "%s", name);
+    a.n_dims = 4;
+    a.dims[0] = batch;
+    a.dims[1] = c;
+    a.dims[2] = h;
+    a.dims[3] = w;
+    a.n_elems = batch * c * h * w;
+    a.size = a.n_elems;
+    a.fmt = RKNN_TENSOR_NCHW;
+    a.type = RKNN_TENSOR_INT8;
+    a.qnt_type = RKNN_TENSOR_QNT_AFFINE_ASYMMETRIC;
+    a.zp = zp;
+    a.scale = scale;
+    a.w_stride = w;
+    a.size_with_stride = a.size;
+
+    rknn_tensor_attr& n = t.native_attr;
+    n = a;
+    int c1 = (c + kNativeC2 - 1) / kNativeC2;
+    n.n_dims = 5;
+    n.dims[0] = batch;
+    n.dims[1] = c1;
+    n.dims[2] = h;
+    n.dims[3] = w;
+    n.dims[4] = kNativeC2;
+    n.fmt = RKNN_TENSOR_NC1HWC2;
+    n.size_with_stride = batch * c1 * h * w * kNativeC2;
+}
+
+std::shared_ptr<SimModel> create_model() {
+    const SimConfig& cfg = config();
+    std::shared_ptr<SimModel> model(new SimModel());
+    const int s = cfg.input_size;
+
+    rknn_tensor_attr& in = model->input.attr;
+    memset(&in, 0, sizeof(in));
+    snprintf(in.name, RKNN_MAX_NAME_LEN, "images");
+    in.n_dims = 4;
+    in.dims[0] = cfg.batch;
+    in.dims[1] = s;
+    in.dims[2] = s;
+    in.dims[3] = 3;
+    in.n_elems = cfg.batch * s * s * 3;
+    in.size = in.n_elems;
+    in.fmt = RKNN_TENSOR_NHWC;
+    in.type = RKNN_TENSOR_INT8;
+    in.qnt_type = RKNN_TENSOR_QNT_AFFINE_ASYMMETRIC;
+    in.zp = -128;
+    in.scale = 1.0f / 255;
+    in.w_stride = s;
+    in.size_with_stride = in.size;
+    model->input.native_attr = in;
+
+    // 三个分支（stride 8/16/32），每个分支 box / score / score_sum，与 rknn_model_zoo 导出的 YOLOv8 一致
+    for (int b = 0; b < 3; b++) {
+        int g = s / (8 << b);
+        char name[32];
+        SimTensor t;
+        snprintf(name, sizeof(name), "box%d", b);
+        fill_output_attr(t, b * 3, name, 4 * kDflLen, g, g, -60, 0.1f);
+        model->outputs.push_back(t);
+        snprintf(name, sizeof(name), "score%d", b);
+        fill_output_attr(t, b * 3 + 1, name, cfg.classes, g, g, -128, 1.0f / 255);
+        model->outputs.push_back(t);
+        snprintf(name, sizeof(name), "score_sum%d", b);
+        fill_output_attr(t, b * 3 + 2, name, 1, g, g, -128, 1.0f / 255);
+        model->outputs.push_back(t);
+    }
+    return model;
+}
+
+int8_t quantize(float v, const rknn_tensor_attr& a) {
+    float q = roundf(v / a.scale) + a.zp;
+    return (int8_t)std::min(127.0f, std::max(-128.0f, q));
+}
+
+struct SimContext {
+    std::shared_ptr<const SimModel> model;
+    uint32_t core_mask;
+    std::vector<uint8_t> input;                  // rknn_inputs_set 拷入的输入
+    rknn_tensor_mem* input_mem;                  // rknn_set_io_mem 绑定的输入（零拷贝）
+    std::vector<rknn_tensor_mem*> output_mems;   // rknn_set_io_mem 绑定的输出（按原生布局写入）
+    std::vector<bool> output_native;
+    std::vector<std::vector<int8_t> > outputs;   // 未绑定时的输出（NCHW），rknn_outputs_get 取走
+    std::vector<void*> allocated;                // rknn_outputs_get 为非预分配输出申请的内存
+    std::future<int> pending;                    // 非阻塞 rknn_run 的推理
+    std::mutex mutex;
+};
+
+SimContext* to_ctx(rknn_context context) {
+    return reinterpret_cast<SimContext*>((uintptr_t)context);
+}
+
+SimContext* create_context(const std::shared_ptr<const SimModel>& model) {
+    SimContext* ctx = new SimContext();
+    ctx->model = model;
+    ctx->core_mask = RKNN_NPU_CORE_AUTO;
+    ctx->input.resize(model->input.attr.size);
+    ctx->input_mem = nullptr;
+    ctx->output_mems.assign(model->outputs.size(), nullptr);
+    ctx->output_native.assign(model->outputs.size(), false);
+    ctx->outputs.resize(model->outputs.size());
+    for (size_t i = 0; i < model->outputs.size(); i++) {
+        ctx->outputs[i].resize(model->outputs[i].attr.n_elems);
+    }
+    return ctx;
+}
+
+// 写入一个元素：绑定的原生输出按 NC1HWC2 寻址，其余按 NCHW
+struct OutputWriter {
+    int8_t* data;
+    int c, h, w;
+    bool native;
+    size_t size;
+
+    int8_t& at(int ch, int y, int x) {
+        if (native) {
+            return data[((size_t)(ch / kNativeC2) * h * w + (size_t)y * w + x) * kNativeC2 + ch % kNativeC2];
+        }
+        return data[((size_t)ch * h + y) * w + x];
+    }
+};
+
+// 第 frame 帧的输出（batch 维在最外层，每帧占连续的 1/batch）
+OutputWriter output_writer(SimContext* ctx, size_t i, int frame) {
+    const rknn_tensor_attr& a = ctx->model->outputs[i].attr;
+    OutputWriter wr;
+    wr.c = a.dims[1];
+    wr.h = a.dims[2];
+    wr.w = a.dims[3];
+    wr.native = ctx->output_mems[i] != nullptr && ctx->output_native[i];
+    if (ctx->output_mems[i] != nullptr) {
+        wr.data = (int8_t*)ctx->output_mems[i]->virt_addr;
+        wr.size = ctx->output_mems[i]->size;
+    } else {
+        wr.data = ctx->outputs[i].data();
+        wr.size = ctx->outputs[i].size();
+    }
+    wr.size /= config().batch;
+    wr.data += (size_t)frame * wr.size;
+    return wr;
+}
+
+// 合成一帧输出：背景为 0 概率，随机位置放置若干目标（DFL 分布集中在一个 bin 上）；
+// 随机序列由该帧输入内容决定，同一输入得到同一输出
+void synthesize_frame(SimContext* ctx, int frame, const uint8_t* input, size_t input_size) {
+    const SimConfig& cfg = config();
+    uint32_t hash = 2166136261u ^ cfg.seed;
+    size_t step = std::max<size_t>(1, input_size / 257);
+    for (size_t i = 0; i < input_size; i += step) {
+        hash = (hash ^ input[i]) * 16777619u;
+    }
+    std::mt19937 rng(hash);
+
+    const std::vector<SimTensor>& tensors = ctx->model->outputs;
+    for (size_t i = 0; i < tensors.size(); i++) {
+        OutputWriter wr = output_writer(ctx, i, frame);
+        memset(wr.data, quantize(0.0f, tensors[i].attr), wr.size);
+    }
+    for (int k = 0; k < cfg.objects; k++) {
+        int b = rng() % 3;
+        OutputWriter box = output_writer(ctx, b * 3, frame);
+        OutputWriter score = output_writer(ctx, b * 3 + 1, frame);
+        OutputWriter score_sum = output_writer(ctx, b * 3 + 2, frame);
+        int y = rng() % box.h;
+        int x = rng() % box.w;
+        int cls = rng() % cfg.classes;
+        float prob = 0.5f + (rng() % 50) / 100.0f;
+        score.at(cls, y, x) = quantize(prob, tensors[b * 3 + 1].attr);
+        score_sum.at(0, y, x) = quantize(prob, tensors[b * 3 + 2].attr);
+        for (int side = 0; side < 4; side++) {
+            int bin = 1 + rng() % (kDflLen - 2);
+            for (int j = 0; j < kDflLen; j++) {
+                box.at(side * kDflLen + j, y, x) = quantize(j == bin ? 8.0f : 0.0f, tensors[b * 3].attr);
+            }
+        }
+    }
+}
+
+void synthesize_outputs(SimContext* ctx, const uint8_t* input, size_t input_size) {
+    const int batch = config().batch;
+    size_t frame_size = input_size / batch;
+    for (int f = 0; f < batch; f++) {
+        synthesize_frame(ctx, f, input + f * frame_size, frame_size);
+    }
+}
+
+double sample_latency_ms(uint32_t taken) {
+    const SimConfig& cfg = config();
+    static std::mutex rng_mutex;
+    static std::mt19937 rng(cfg.seed);
+
+    // 多核 mask：按参与核的平均延迟理想并行折算
+    double mean = 0;
+    int n = 0;
+    for (int i = 0; i < cfg.cores; i++) {
+        if (taken >> i & 1) {
+            mean += cfg.latency_ms[i];
+            n++;
+        }
+    }
+    mean = n ? mean / n / n : cfg.latency_ms[0];
+    // 批量：每多一帧增加 batch_cost 倍的单帧延迟
+    mean *= 1.0 + (cfg.batch - 1) * cfg.batch_cost;
+
+    double ms = mean;
+    std::lock_guard<std::mutex> lock(rng_mutex);
+    if (cfg.dist == DIST_NORMAL && cfg.jitter_ms > 0) {
+        ms = std::normal_distribution<double>(mean, cfg.jitter_ms)(rng);
+    } else if (cfg.dist == DIST_UNIFORM && cfg.jitter_ms > 0) {
+        ms = std::uniform_real_distribution<double>(mean - cfg.jitter_ms, mean + cfg.jitter_ms)(rng);
+    }
+    return std::max(mean * 0.1, ms);
+}
+
+// 一次推理：等待空闲核，合成输出，按采样的延迟占用该核
+int execute(SimContext* ctx) {
+    uint32_t taken = npu().acquire(ctx->core_mask);
+    Clock::time_point start = Clock::now();
+    double ms = sample_latency_ms(taken);
+
+    const uint8_t* input = ctx->input.data();
+    size_t input_size = ctx->input.size();
+    if (ctx->input_mem != nullptr) {
+        input = (const uint8_t*)ctx->input_mem->virt_addr;
+        input_size = std::min<size_t>(input_size, ctx->input_mem->size);
+    }
+    synthesize_outputs(ctx, input, input_size);
+
+    std::this_thread::sleep_until(start + std::chrono::microseconds((long long)(ms * 1000)));
+    npu().release(taken, ms);
+    return RKNN_SUCC;
+}
+
+// 等待上一次非阻塞推理结束
+int wait_pending(SimContext* ctx) {
+    if (ctx->pending.valid()) {
+        return ctx->pending.get();
+    }
+    return RKNN_SUCC;
+}
+
+}  // namespace
+
+extern "C" {
+
+int rknn_init(rknn_context* context, void* model, uint32_t size, uint32_t flag, rknn_init_extend* extend) {
+    (void)flag;
+    (void)extend;
+    if (context == nullptr || model == nullptr || size == 0) {
+        return RKNN_ERR_PARAM_INVALID;
+    }
+    // 模型内容不解析，张量形状由配置决定；只模拟加载耗时
+    std::this_thread::sleep_for(std::chrono::milliseconds(config().init_ms));
+    *context = (rknn_context)(uintptr_t)create_context(create_model());
+    npu();
+    return RKNN_SUCC;
+}
+
+int rknn_dup_context(rknn_context* context_in, rknn_context* context_out) {
+    if (context_in == nullptr || *context_in == 0 || context_out == nullptr) {
+        return RKNN_ERR_PARAM_INVALID;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(config().dup_ms));
+    *context_out = (rknn_context)(uintptr_t)create_context(to_ctx(*context_in)->model);
+    return RKNN_SUCC;
+}
+
+int rknn_destroy(rknn_context context) {
+    SimContext* ctx = to_ctx(context);
+    if (ctx == nullptr) {
+        return RKNN_ERR_PARAM_INVALID;
+    }
+    wait_pending(ctx);
+    for (size_t i = 0; i < ctx->allocated.size(); i++) {
+        free(ctx->allocated[i]);
+    }
+    delete ctx;
+    return RKNN_SUCC;
+}
+
+int rknn_query(rknn_context context, rknn_query_cmd cmd, void* info, uint32_t size) {
+    SimContext* ctx = to_ctx(context);
+    if (ctx == nullptr || info == nullptr) {
+        return RKNN_ERR_PARAM_INVALID;
+    }
+    const SimModel& model = *ctx->model;
+    switch (cmd) {
+    case RKNN_QUERY_IN_OUT_NUM: {
+        if (size < sizeof(rknn_input_output_num)) {
+            return RKNN_ERR_PARAM_INVALID;
+        }
+        rknn_input_output_num* num = (rknn_input_output_num*)info;
+        num->n_input = 1;
+        num->n_output = (uint32_t)model.outputs.size();
+        return RKNN_SUCC;
+    }
+    case RKNN_QUERY_INPUT_ATTR:
+    case RKNN_QUERY_NATIVE_INPUT_ATTR:
+    case RKNN_QUERY_OUTPUT_ATTR:
+    case RKNN_QUERY_NATIVE_OUTPUT_ATTR: {
+        if (size < sizeof(rknn_tensor_attr)) {
+            return RKNN_ERR_PARAM_INVALID;
+        }
+        rknn_tensor_attr* attr = (rknn_tensor_attr*)info;
+        bool input = (cmd == RKNN_QUERY_INPUT_ATTR || cmd == RKNN_QUERY_NATIVE_INPUT_ATTR);
+        bool native = (cmd == RKNN_QUERY_NATIVE_INPUT_ATTR || cmd == RKNN_QUERY_NATIVE_OUTPUT_ATTR);
+        uint32_t index = attr->index;
+        if (input ? index != 0 : index >= model.outputs.size()) {
+            return RKNN_ERR_PARAM_INVALID;
+        }
+        const SimTensor& t = input ? model.input : model.outputs[index];
+        *attr = native ? t.native_attr : t.attr;
+        return RKNN_SUCC;
+    }
+    default:
+        printf("rknnrt_sim: rknn_query cmd %d not supported\n", (int)cmd);
+        return RKNN_ERR_PARAM_INVALID;
+    }
+}
+
+int rknn_inputs_set(rknn_context context, uint32_t n_inputs, rknn_input inputs[]) {
+    SimContext* ctx = to_ctx(context);
+    if (ctx == nullptr || n_inputs != 1 || inputs == nullptr || inputs[0].buf == nullptr) {
+        return RKNN_ERR_PARAM_INVALID;
+    }
+    if (inputs[0].size != ctx->input.size()) {
+        printf("rknnrt_sim: input size %u, expect %zu\n", inputs[0].size, ctx->input.size());
+        return RKNN_ERR_PARAM_INVALID;
+    }
+    // 与真实运行时一样拷贝到运行时的输入内存；非阻塞推理进行中时先等待其结束
+    std::lock_guard<std::mutex> lock(ctx->mutex);
+    wait_pending(ctx);
+    memcpy(ctx->input.data(), inputs[0].buf, ctx->input.size());
+    return RKNN_SUCC;
+}
+
+int rknn_set_batch_core_num(rknn_context context, int core_num) {
+    (void)context;
+    (void)core_num;
+    return RKNN_SUCC;
+}
+
+int rknn_set_core_mask(rknn_context context, rknn_core_mask core_mask) {
+    SimContext* ctx = to_ctx(context);
+    if (ctx == nullptr) {
+        return RKNN_ERR_PARAM_INVALID;
+    }
+    uint32_t mask = (uint32_t)core_mask;
+    if (core_mask == RKNN_NPU_CORE_ALL) {
+        mask = (1u << config().cores) - 1;
+    }
+    if (mask >> config().cores) {
+        printf("rknnrt_sim: core mask 0x%x exceeds %d cores\n", mask, config().cores);
+        return RKNN_ERR_PARAM_INVALID;
+    }
+    ctx->core_mask = mask;
+    return RKNN_SUCC;
+}
+
+int rknn_run(rknn_context context, rknn_run_extend* extend) {
+    SimContext* ctx = to_ctx(context);
+    if (ctx == nullptr) {
+        return RKNN_ERR_PARAM_INVALID;
+    }
+    std::lock_guard<std::mutex> lock(ctx->mutex);
+    wait_pending(ctx);
+    if (extend != nullptr && extend->non_block) {
+        ctx->pending = std::async(std::launch::async, execute, ctx);
+        return RKNN_SUCC;
+    }
+    return execute(ctx);
+}
+
+int rknn_wait(rknn_context context, rknn_run_extend* extend) {
+    (void)extend;
+    SimContext* ctx = to_ctx(context);
+    if (ctx == nullptr) {
+        return RKNN_ERR_PARAM_INVALID;
+    }
+    std::lock_guard<std::mutex> lock(ctx->mutex);
+    return wait_pending(ctx);
+}
+
+int rknn_outputs_get(rknn_context context, uint32_t n_outputs, rknn_output outputs[], rknn_output_extend* extend) {
+    (void)extend;
+    SimContext* ctx = to_ctx(context);
+    if (ctx == nullptr || outputs == nullptr || n_outputs > ctx->outputs.size()) {
+        return RKNN_ERR_PARAM_INVALID;
+    }
+    std::lock_guard<std::mutex> lock(ctx->mutex);
+    int ret = wait_pending(ctx);
+    if (ret != RKNN_SUCC) {
+        return ret;
+    }
+    for (uint32_t i = 0; i < n_outputs; i++) {
+        rknn_output& out = outputs[i];
+        if (out.index >= ctx->outputs.size()) {
+            return RKNN_ERR_PARAM_INVALID;
+        }
+        const rknn_tensor_attr& a = ctx->model->outputs[out.index].attr;
+        const std::vector<int8_t>& src = ctx->outputs[out.index];
+        uint32_t need = out.want_float ? a.n_elems * sizeof(float) : a.size;
+        if (out.is_prealloc) {
+            if (out.buf == nullptr || out.size < need) {
+                printf("rknnrt_sim: output %u prealloc size %u < %u\n", out.index, out.size, need);
+                return RKNN_ERR_PARAM_INVALID;
+            }
+        } else {
+            out.buf = malloc(need);
+            if (out.buf == nullptr) {
+                return RKNN_ERR_FAIL;
+            }
+            out.size = need;
+            ctx->allocated.push_back(out.buf);
+        }
+        if (out.want_float) {
+            float* dst = (float*)out.buf;
+            for (uint32_t j = 0; j < a.n_elems; j++) {
+                dst[j] = (src[j] - a.zp) * a.scale;
+            }
+        } else {
+            memcpy(out.buf, src.data(), a.size);
+        }
+    }
+    return RKNN_SUCC;
+}
+
+int rknn_outputs_release(rknn_context context, uint32_t n_ouputs, rknn_output outputs[]) {
+    SimContext* ctx = to_ctx(context);
+    if (ctx == nullptr || outputs == nullptr) {
+        return RKNN_ERR_PARAM_INVALID;
+    }
+    std::lock_guard<std::mutex> lock(ctx->mutex);
+    for (uint32_t i = 0; i < n_ouputs; i++) {
+        if (outputs[i].is_prealloc) {
+            continue;
+        }
+        std::vector<void*>::iterator it = std::find(ctx->allocated.begin(), ctx->allocated.end(), outputs[i].buf);
+        if (it != ctx->allocated.end()) {
+            free(*it);
+            ctx->allocated.erase(it);
+            outputs[i].buf = nullptr;
+        }
+    }
+    return RKNN_SUCC;
+}
+
+rknn_tensor_mem* rknn_create_mem(rknn_context ctx, uint32_t size) {
+    (void)ctx;
+    rknn_tensor_mem* mem = (rknn_tensor_mem*)calloc(1, sizeof(rknn_tensor_mem));
+    if (mem == nullptr) {
+        return nullptr;
+    }
+    mem->virt_addr = calloc(1, size);
+    if (mem->virt_addr == nullptr) {
+        free(mem);
+        return nullptr;
+    }
+    mem->fd = -1;
+    mem->size = size;
+    return mem;
+}
+
+int rknn_destroy_mem(rknn_context ctx, rknn_tensor_mem* mem) {
+    SimContext* sim = to_ctx(ctx);
+    if (mem == nullptr) {
+        return RKNN_ERR_PARAM_INVALID;
+    }
+    if (sim != nullptr) {
+        std::lock_guard<std::mutex> lock(sim->mutex);
+        wait_pending(sim);
+        if (sim->input_mem == mem) {
+            sim->input_mem = nullptr;
+        }
+        for (size_t i = 0; i < sim->output_mems.size(); i++) {
+            if (sim->output_mems[i] == mem) {
+                sim->output_mems[i] = nullptr;
+            }
+        }
+    }
+    free(mem->virt_addr);
+    free(mem);
+    return RKNN_SUCC;
+}
+
+int rknn_set_io_mem(rknn_context ctx, rknn_tensor_mem* mem, rknn_tensor_attr* attr) {
+    SimContext* sim = to_ctx(ctx);
+    if (sim == nullptr || mem == nullptr || attr == nullptr) {
+        return RKNN_ERR_PARAM_INVALID;
+    }
+    std::lock_guard<std::mutex> lock(sim->mutex);
+    wait_pending(sim);
+    // 按张量名区分输入与输出
+    const SimModel& model = *sim->model;
+    if (strcmp(attr->name, model.input.attr.name) == 0) {
+        if (mem->size < model.input.attr.size) {
+            return RKNN_ERR_PARAM_INVALID;
+        }
+        sim->input_mem = mem;
+        return RKNN_SUCC;
+    }
+    for (size_t i = 0; i < model.outputs.size(); i++) {
+        if (strcmp(attr->name, model.outputs[i].attr.name) == 0) {
+            bool native = attr->fmt == RKNN_TENSOR_NC1HWC2;
+            uint32_t need = native ? model.outputs[i].native_attr.size_with_stride : model.outputs[i].attr.size;
+            if (mem->size < need) {
+                printf("rknnrt_sim: output %zu mem size %u < %u\n", i, mem->size, need);
+                return RKNN_ERR_PARAM_INVALID;
+            }
+            sim->output_mems[i] = mem;
+            sim->output_native[i] = native;
+            return RKNN_SUCC;
+        }
+    }
+    printf("rknnrt_sim: rknn_set_io_mem unknown tensor %s\n", attr->name);
+    return RKNN_ERR_PARAM_INVALID;
+}
+
+}  // extern "C"
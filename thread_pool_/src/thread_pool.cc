@@ -29,9 +29,11 @@ bool check_board_model_support() {
 }
 
 ThreadPool::ThreadPool(size_t thread_count) {
+#ifndef SKIP_BOARD_CHECK  // 模拟构建（ENABLE_RKNN_SIM）在非目标板的构建机上运行，不检查板子型号
     if (!check_board_model_support()) {
         std::exit(EXIT_FAILURE);  // 直接退出程序
     }
+#endif
     
     // 创建指定数量的工作线程
     for (size_t i = 0; i < thread_count; ++i) {
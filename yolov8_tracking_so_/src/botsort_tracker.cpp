@@ -30,10 +30,12 @@ static bool check_board_model_support() {
 }
 // 新增：授权检查卡点函数（在关键流程调用）
 static void enforce_authorization() {
+#ifndef SKIP_BOARD_CHECK  // 模拟构建（ENABLE_RKNN_SIM）在非目标板的构建机上运行，不检查板子型号
     if (!check_board_model_support()) {
         // 抛出异常中断算法流程，主程序捕获后输出特定错误
         throw std::runtime_error("BERROR:模型初始化错误");
     }
+#endif
 }
 
 BoTSORTTracker::BoTSORTTracker() : object_count(0), last_movement_direction("Unknown") {